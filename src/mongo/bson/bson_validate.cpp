@@ -37,6 +37,7 @@
 #include "mongo/bson/oid.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/platform/byte_vector.h"
 #include "mongo/platform/decimal128.h"
 
 namespace mongo {
@@ -67,6 +68,26 @@ Status NOINLINE_DECL makeError(StringData baseMsg, BSONElement idElem, StringDat
     return Status(ErrorCodes::InvalidBSON, msg);
 }
 
+/**
+ * Returns a pointer to the first NUL byte in the 'length' bytes at 'start', or nullptr if there is
+ * none. Most field names fit in a single vector, so the vectorized scan checks the first vector
+ * inline and only calls into memchr() for longer strings.
+ */
+template <bool vectorized>
+const char* findNul(const char* start, uint64_t length) {
+#ifdef MONGO_HAVE_FAST_BYTE_VECTOR
+    if (vectorized && length >= ByteVector::size) {
+        const ByteVector::Mask nulMask = ByteVector::load(start).compareEQ(0).maskAny();
+        if (nulMask)
+            return start + ByteVector::countInitialZeros(nulMask);
+        return static_cast<const char*>(
+            memchr(start + ByteVector::size, 0, length - ByteVector::size));
+    }
+#endif
+    return static_cast<const char*>(memchr(start, 0, length));
+}
+
+template <bool vectorized>
 class Buffer {
 public:
     Buffer(const char* buffer, uint64_t maxLength, BSONVersion version)
@@ -89,10 +110,10 @@ public:
      * reading, if it exists. Otherwise, it should be empty.
      */
     Status readCString(StringData elemName, StringData* out) {
-        const void* x = memchr(_buffer + _position, 0, _maxLength - _position);
+        const char* x = findNul<vectorized>(_buffer + _position, _maxLength - _position);
         if (!x)
             return makeError("no end of c-string", _idElem, elemName);
-        uint64_t len = static_cast<uint64_t>(static_cast<const char*>(x) - (_buffer + _position));
+        uint64_t len = static_cast<uint64_t>(x - (_buffer + _position));
 
         StringData data(_buffer + _position, len);
         _position += len + 1;
@@ -200,14 +221,15 @@ private:
 /**
  * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
  */
-Status validateElementInfo(Buffer* buffer,
+template <typename BufferType>
+Status validateElementInfo(BufferType* buffer,
                            ValidationState::State* nextState,
                            BSONElement idElem,
                            StringData* elemName) {
     Status status = Status::OK();
 
     signed char type;
-    if (!buffer->readNumber<signed char>(&type))
+    if (!buffer->template readNumber<signed char>(&type))
         return makeError("invalid bson", idElem, StringData());
 
     if (type == EOO) {
@@ -286,7 +308,7 @@ Status validateElementInfo(Buffer* buffer,
 
         case BinData: {
             int sz;
-            if (!buffer->readNumber<int>(&sz))
+            if (!buffer->template readNumber<int>(&sz))
                 return makeError("invalid bson", idElem, *elemName);
             if (sz < 0 || sz == std::numeric_limits<int>::max())
                 return makeError("invalid size in bson", idElem, *elemName);
@@ -307,7 +329,8 @@ Status validateElementInfo(Buffer* buffer,
     }
 }
 
-Status validateBSONIterative(Buffer* buffer) {
+template <typename BufferType>
+Status validateBSONIterative(BufferType* buffer) {
     std::vector<ValidationObjectFrame> frames;
     frames.reserve(16);
     ValidationObjectFrame* curr = NULL;
@@ -329,7 +352,7 @@ Status validateBSONIterative(Buffer* buffer) {
                 curr = &frames.back();
                 curr->setStartPosition(buffer->position());
                 curr->setIsCodeWithScope(false);
-                if (!buffer->readNumber<int>(&curr->expectedSize)) {
+                if (!buffer->template readNumber<int>(&curr->expectedSize)) {
                     return makeError("bson size is larger than buffer size", idElem, StringData());
                 }
                 state = ValidationState::WithinObj;
@@ -384,7 +407,7 @@ Status validateBSONIterative(Buffer* buffer) {
                 curr = &frames.back();
                 curr->setStartPosition(buffer->position());
                 curr->setIsCodeWithScope(true);
-                if (!buffer->readNumber<int>(&curr->expectedSize))
+                if (!buffer->template readNumber<int>(&curr->expectedSize))
                     return makeError("invalid bson CodeWScope size", idElem, StringData());
                 Status status = buffer->readUTF8String(StringData(), nullptr);
                 if (!status.isOK())
@@ -414,15 +437,30 @@ Status validateBSONIterative(Buffer* buffer) {
     return Status::OK();
 }
 
-}  // namespace
-
-Status validateBSON(const char* originalBuffer, uint64_t maxLength, BSONVersion version) {
+template <bool vectorized>
+Status validateBSONImpl(const char* originalBuffer, uint64_t maxLength, BSONVersion version) {
     if (maxLength < 5) {
         return Status(ErrorCodes::InvalidBSON, "bson data has to be at least 5 bytes");
     }
 
-    Buffer buf(originalBuffer, maxLength, version);
+    Buffer<vectorized> buf(originalBuffer, maxLength, version);
     return validateBSONIterative(&buf);
 }
 
+}  // namespace
+
+Status validateBSON(const char* originalBuffer, uint64_t maxLength, BSONVersion version) {
+#ifdef MONGO_HAVE_FAST_BYTE_VECTOR
+    return validateBSONImpl<true>(originalBuffer, maxLength, version);
+#else
+    return validateBSONImpl<false>(originalBuffer, maxLength, version);
+#endif
+}
+
+Status validateBSONScalarForTest(const char* originalBuffer,
+                                 uint64_t maxLength,
+                                 BSONVersion version) {
+    return validateBSONImpl<false>(originalBuffer, maxLength, version);
+}
+
 }  // namespace mongo
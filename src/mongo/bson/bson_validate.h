@@ -46,4 +46,11 @@ class Status;
  */
 Status validateBSON(const char* buf, uint64_t maxLength, BSONVersion version);
 
+/**
+ * Same as validateBSON(), but always finds the end of c-strings with plain memchr(), even on
+ * platforms where validateBSON() scans them with vector instructions. Tests use it to check that
+ * both accept and reject exactly the same input.
+ */
+Status validateBSONScalarForTest(const char* buf, uint64_t maxLength, BSONVersion version);
+
 }  // namespace mongo
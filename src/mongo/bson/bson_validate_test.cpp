@@ -194,6 +194,48 @@ TEST(BSONValidate, Fuzz) {
     }
 }
 
+void assertSameValidation(const char* data, uint64_t maxLength) {
+    Status vectorized = validateBSON(data, maxLength, BSONVersion::kLatest);
+    Status scalar = validateBSONScalarForTest(data, maxLength, BSONVersion::kLatest);
+    ASSERT_EQ(scalar.code(), vectorized.code()) << scalar << " vs " << vectorized;
+    ASSERT_EQ(scalar.reason(), vectorized.reason());
+}
+
+TEST(BSONValidate, VectorizedMatchesScalar) {
+    int64_t seed = time(0);
+    log() << "BSONValidate VectorizedMatchesScalar random seed: " << seed << endl;
+    PseudoRandom randomSource(seed);
+
+    // Field names and regexes of every length around the vector width, so that their NUL
+    // terminators land on both sides of each vector boundary.
+    std::vector<BSONObj> originals;
+    for (int nameLength = 0; nameLength <= 40; ++nameLength) {
+        const std::string name(nameLength, 'f');
+        originals.push_back(BSON(name << 1 << "_id" << nameLength << "sub"
+                                      << BSON(name << BSONRegEx(name, "i") << "x" << name)));
+    }
+
+    for (const BSONObj& original : originals) {
+        // Truncating the buffer exercises the memchr() fallback near its end, and a missing
+        // terminator within the last vector.
+        for (int maxLength = 0; maxLength <= original.objsize(); ++maxLength) {
+            assertSameValidation(original.objdata(), maxLength);
+        }
+
+        // Overwrite random bytes with zero or with random values, without touching the size.
+        for (int trial = 0; trial < 100; ++trial) {
+            std::unique_ptr<char[]> buffer(new char[original.objsize()]);
+            memcpy(buffer.get(), original.objdata(), original.objsize());
+            const int numCorruptions = 1 + randomSource.nextInt32(3);
+            for (int i = 0; i < numCorruptions; ++i) {
+                const int byteIdx = 4 + randomSource.nextInt32(original.objsize() - 4);
+                buffer[byteIdx] = randomSource.nextInt32(2) ? 0 : randomSource.nextInt32(256);
+            }
+            assertSameValidation(buffer.get(), original.objsize());
+        }
+    }
+}
+
 TEST(BSONValidateFast, Empty) {
     BSONObj x;
     ASSERT_OK(validateBSON(x.objdata(), x.objsize(), BSONVersion::kLatest));
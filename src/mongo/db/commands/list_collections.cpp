@@ -288,7 +288,9 @@ public:
 
         const NamespaceString cursorNss = NamespaceString::makeListCollectionsNSS(dbname);
         std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> exec;
-        BSONArrayBuilder firstBatch;
+        // Stream the first batch straight into the reply rather than through an intermediate
+        // array that would have to be copied into it afterwards.
+        CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result);
         {
             AutoGetDb autoDb(opCtx, dbname, MODE_IS);
             Database* db = autoDb.getDb();
@@ -362,7 +364,7 @@ public:
                 invariant(state == PlanExecutor::ADVANCED);
 
                 // If we can't fit this result inside the current batch, then we stash it for later.
-                if (!FindCommon::haveSpaceForNext(next, objCount, firstBatch.len())) {
+                if (!FindCommon::haveSpaceForNext(next, objCount, firstBatch.bytesUsed())) {
                     exec->enqueue(next);
                     break;
                 }
@@ -370,7 +372,7 @@ public:
                 firstBatch.append(next);
             }
             if (exec->isEOF()) {
-                appendCursorResponseObject(0LL, cursorNss.ns(), firstBatch.arr(), &result);
+                firstBatch.done(0LL, cursorNss.ns());
                 return true;
             }
             exec->saveState();
@@ -385,8 +387,7 @@ public:
              repl::ReadConcernArgs::get(opCtx).getLevel(),
              jsobj});
 
-        appendCursorResponseObject(
-            pinnedCursor.getCursor()->cursorid(), cursorNss.ns(), firstBatch.arr(), &result);
+        firstBatch.done(pinnedCursor.getCursor()->cursorid(), cursorNss.ns());
 
         return true;
     }
@@ -127,7 +127,7 @@ public:
 
         std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> exec;
         NamespaceString cursorNss;
-        BSONArrayBuilder firstBatch;
+        CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &result);
         {
             AutoGetCollectionForReadCommand ctx(opCtx,
                                                 CommandHelpers::parseNsOrUUID(dbname, cmdObj));
@@ -180,7 +180,7 @@ public:
                 invariant(state == PlanExecutor::ADVANCED);
 
                 // If we can't fit this result inside the current batch, then we stash it for later.
-                if (!FindCommon::haveSpaceForNext(next, objCount, firstBatch.len())) {
+                if (!FindCommon::haveSpaceForNext(next, objCount, firstBatch.bytesUsed())) {
                     exec->enqueue(next);
                     break;
                 }
@@ -189,7 +189,7 @@ public:
             }
 
             if (exec->isEOF()) {
-                appendCursorResponseObject(0LL, cursorNss.ns(), firstBatch.arr(), &result);
+                firstBatch.done(0LL, cursorNss.ns());
                 return true;
             }
 
@@ -206,8 +206,7 @@ public:
              repl::ReadConcernArgs::get(opCtx).getLevel(),
              cmdObj});
 
-        appendCursorResponseObject(
-            pinnedCursor.getCursor()->cursorid(), cursorNss.ns(), firstBatch.arr(), &result);
+        firstBatch.done(pinnedCursor.getCursor()->cursorid(), cursorNss.ns());
 
         return true;
     }
@@ -29,6 +29,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/init.h"
+#include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
@@ -79,6 +80,47 @@ public:
     }
 };
 
+/**
+ * { resetLatencyPercentiles: 1, ns: <string> }
+ *
+ * Clears the latency percentiles reported by $collStats and serverStatus, for namespace 'ns' only
+ * if given. The cumulative latency totals and histograms are left alone.
+ */
+class ResetLatencyPercentilesCommand : public BasicCommand {
+public:
+    ResetLatencyPercentilesCommand() : BasicCommand("resetLatencyPercentiles") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+    bool adminOnly() const override {
+        return true;
+    }
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+    std::string help() const override {
+        return "clears the latency percentiles of one namespace or of all of them. "
+               "{resetLatencyPercentiles: 1, ns: 'db.coll'}";
+    }
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::top);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+    bool run(OperationContext* opCtx,
+             const std::string& db,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        std::string ns;
+        uassertStatusOK(bsonExtractStringFieldWithDefault(cmdObj, "ns", "", &ns));
+        Top::get(opCtx->getClient()->getServiceContext()).resetLatencyPercentiles(ns);
+        return true;
+    }
+};
+
 //
 // Command instance.
 // Registers command with the command system and make command
@@ -87,6 +129,7 @@ public:
 
 MONGO_INITIALIZER(RegisterTopCommand)(InitializerContext* context) {
     new TopCommand();
+    new ResetLatencyPercentilesCommand();
 
     return Status::OK();
 }
@@ -39,6 +39,14 @@ void Mutex::lock() {
     }
 }
 
+bool ConditionVariable::_waitsByYielding() {
+    if (localThreadId == -1) {
+        return false;
+    }
+    Client* client = Client::getCurrent();
+    return client && client->coroutineFunctors() != CoroutineFunctors::Unavailable;
+}
+
 void ConditionVariable::wait(std::unique_lock<Mutex>& lock) {
     invariant(lock.owns_lock());
     if (localThreadId != -1) {
@@ -52,6 +52,10 @@ public:
     template <class Clock, class Duration>
     std::cv_status wait_until(std::unique_lock<Mutex>& lock,
                               const std::chrono::time_point<Clock, Duration>& timeout_time) {
+        if (!_waitsByYielding()) {
+            return _cv.wait_until(reinterpret_cast<std::unique_lock<std::mutex>&>(lock),
+                                  timeout_time);
+        }
         wait(lock);
         return Clock::now() < timeout_time ? std::cv_status::no_timeout : std::cv_status::timeout;
     }
@@ -83,11 +87,18 @@ public:
     }
 
     std::cv_status wait_until(std::unique_lock<Mutex>& lock, Date_t timeout_time) {
+        if (!_waitsByYielding()) {
+            return _cv.wait_until(reinterpret_cast<std::unique_lock<std::mutex>&>(lock),
+                                  timeout_time.toSystemTimePoint());
+        }
         wait(lock);
         return Date_t::now() < timeout_time ? std::cv_status::no_timeout : std::cv_status::timeout;
     }
 
 private:
+    // Whether wait() yields the current coroutine rather than blocking the thread.
+    static bool _waitsByYielding();
+
     std::condition_variable _cv;
 };
 }  // namespace mongo::coro
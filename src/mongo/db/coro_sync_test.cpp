@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2025 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <chrono>
+#include <mutex>
+
+#include "mongo/db/coro_sync.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// These run on plain threads, where waiting blocks on the underlying std::condition_variable
+// instead of yielding a coroutine.
+
+TEST(CoroConditionVariable, WaitUntilTimesOutOffCoroutine) {
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    std::unique_lock<coro::Mutex> lk(mutex);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(20);
+    ASSERT(cv.wait_until(lk, deadline) == std::cv_status::timeout);
+    ASSERT(std::chrono::steady_clock::now() >= deadline);
+    ASSERT(lk.owns_lock());
+}
+
+TEST(CoroConditionVariable, WaitForPredicateTimesOutOffCoroutine) {
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    std::unique_lock<coro::Mutex> lk(mutex);
+
+    ASSERT_FALSE(cv.wait_for(lk, std::chrono::milliseconds(20), [] { return false; }));
+    ASSERT(lk.owns_lock());
+}
+
+TEST(CoroConditionVariable, WaitUntilDateTimesOutOffCoroutine) {
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    std::unique_lock<coro::Mutex> lk(mutex);
+
+    const Date_t deadline = Date_t::now() + Milliseconds(20);
+    ASSERT(cv.wait_until(lk, deadline) == std::cv_status::timeout);
+    ASSERT_GTE(Date_t::now(), deadline);
+}
+
+TEST(CoroConditionVariable, WaitForPredicateIsNotifiedOffCoroutine) {
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    bool ready = false;
+
+    stdx::thread notifier([&] {
+        std::lock_guard<coro::Mutex> lk(mutex);
+        ready = true;
+        cv.notify_all();
+    });
+
+    std::unique_lock<coro::Mutex> lk(mutex);
+    ASSERT(cv.wait_for(lk, std::chrono::seconds(60), [&] { return ready; }));
+    lk.unlock();
+    notifier.join();
+}
+
+}  // namespace
+}  // namespace mongo
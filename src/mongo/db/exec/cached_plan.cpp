@@ -37,6 +37,7 @@
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/cardinality_estimator.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_ranker.h"
@@ -219,6 +220,11 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache) {
                                     << " No query solutions");
     }
 
+    pruneSolutionsByEstimatedCardinality(getOpCtx(),
+                                         *_canonicalQuery,
+                                         CardinalityEstimator::get(getOpCtx()->getServiceContext()),
+                                         &solutions);
+
     if (1 == solutions.size()) {
         // If there's only one solution, it won't get cached. Make sure to evict the existing
         // cache entry if requested by the caller.
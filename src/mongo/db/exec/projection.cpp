@@ -63,6 +63,7 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
     if (ProjectionStageParams::NO_FAST_PATH == _projImpl) {
         _exec.reset(
             new ProjectionExec(opCtx, params.projObj, params.fullExpression, params.collator));
+        _topLevel = TopLevelProjection::make(_projObj);
     } else {
         // We shouldn't need the full expression if we're fast-pathing.
         invariant(NULL == params.fullExpression);
@@ -99,6 +100,7 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
         } else {
             invariant(ProjectionStageParams::SIMPLE_DOC == params.projImpl);
         }
+        _topLevel = TopLevelProjection::make(_projObj);
     }
 }
 
@@ -143,20 +145,23 @@ void ProjectionStage::transformSimpleInclusion(const BSONObj& in,
 }
 
 Status ProjectionStage::transform(WorkingSetMember* member) {
-    // The default no-fast-path case.
-    if (ProjectionStageParams::NO_FAST_PATH == _projImpl) {
-        return _exec->transform(member);
-    }
-
     BSONObjBuilder bob;
 
-    // Note that even if our fast path analysis is bug-free something that is
-    // covered might be invalidated and just be an obj.  In this case we just go
-    // through the SIMPLE_DOC path which is still correct if the covered data
-    // is not available.
-    //
-    // SIMPLE_DOC implies that we expect an object so it's kind of redundant.
-    if ((ProjectionStageParams::SIMPLE_DOC == _projImpl) || member->hasObj()) {
+    if (_topLevel && member->hasObj()) {
+        // Projections of top-level fields copy the kept elements of the document in one pass,
+        // whichever implementation the planner picked.
+        _topLevel->project(member->obj.value(), &bob);
+    } else if (ProjectionStageParams::NO_FAST_PATH == _projImpl) {
+        // The default no-fast-path case.
+        return _exec->transform(member);
+    } else if ((ProjectionStageParams::SIMPLE_DOC == _projImpl) || member->hasObj()) {
+        // Note that even if our fast path analysis is bug-free something that is
+        // covered might be invalidated and just be an obj.  In this case we just go
+        // through the SIMPLE_DOC path which is still correct if the covered data
+        // is not available.
+        //
+        // SIMPLE_DOC implies that we expect an object so it's kind of redundant.
+        //
         // If we got here because of SIMPLE_DOC the planner shouldn't have messed up.
         invariant(member->hasObj());
 
@@ -31,6 +31,7 @@
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/projection_exec.h"
+#include "mongo/db/exec/top_level_projection.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
@@ -117,6 +118,10 @@ private:
 
     std::unique_ptr<ProjectionExec> _exec;
 
+    // Set when the projection only includes or only excludes top-level fields. Used whenever the
+    // member has a document.
+    boost::optional<TopLevelProjection> _topLevel;
+
     // _ws is not owned by us.
     WorkingSet* _ws;
 
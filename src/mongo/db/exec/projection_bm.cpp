@@ -0,0 +1,118 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/exec/projection_exec.h"
+#include "mongo/db/exec/top_level_projection.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * A document with an _id and 'numFields' integer fields named f0, f1, ...
+ */
+BSONObj makeDocument(int numFields) {
+    BSONObjBuilder bob;
+    bob.append("_id", OID::gen());
+    for (int i = 0; i < numFields; ++i) {
+        bob.append("f" + std::to_string(i), i);
+    }
+    return bob.obj();
+}
+
+/**
+ * The specs benchmarked, chosen by the second argument: {f1: 1, f3: 1, _id: 0}, a wide inclusion
+ * of every other field, and {f2: 0}.
+ */
+BSONObj makeSpec(int shape, int numFields) {
+    BSONObjBuilder bob;
+    switch (shape) {
+        case 0:
+            bob.append("f1", 1);
+            bob.append("f3", 1);
+            bob.append("_id", 0);
+            break;
+        case 1:
+            for (int i = 0; i < numFields; i += 2) {
+                bob.append("f" + std::to_string(i), 1);
+            }
+            break;
+        default:
+            bob.append("f2", 0);
+            break;
+    }
+    return bob.obj();
+}
+
+void BM_ProjectionExec(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    const BSONObj spec = makeSpec(state.range(1), state.range(0));
+    ProjectionExec exec(nullptr, spec, nullptr, nullptr);
+
+    WorkingSetMember wsm;
+    for (auto keepRunning : state) {
+        wsm.obj = Snapshotted<BSONObj>(SnapshotId(), doc);
+        wsm.transitionToOwnedObj();
+        invariant(exec.transform(&wsm).isOK());
+        benchmark::DoNotOptimize(wsm.obj.value().objdata());
+        wsm.clear();
+    }
+}
+
+void BM_TopLevelProjection(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    const BSONObj spec = makeSpec(state.range(1), state.range(0));
+    auto projection = TopLevelProjection::make(spec);
+    invariant(projection);
+
+    for (auto keepRunning : state) {
+        BSONObj projected = projection->project(doc);
+        benchmark::DoNotOptimize(projected.objdata());
+    }
+}
+
+void projectionArgs(benchmark::internal::Benchmark* bm) {
+    bm->ArgNames({"fields", "shape"});
+    for (int numFields : {8, 64}) {
+        for (int shape : {0, 1, 2}) {
+            bm->Args({numFields, shape});
+        }
+    }
+}
+
+BENCHMARK(BM_ProjectionExec)->Apply(projectionArgs);
+BENCHMARK(BM_TopLevelProjection)->Apply(projectionArgs);
+
+}  // namespace
+}  // namespace mongo
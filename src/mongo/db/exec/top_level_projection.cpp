@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/top_level_projection.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+namespace {
+
+const StringData kIdField = "_id"_sd;
+
+// Up to this many fields are looked up by a linear scan, more by binary search.
+const size_t kMaxLinearLookupFields = 8;
+
+}  // namespace
+
+// static
+boost::optional<TopLevelProjection> TopLevelProjection::make(const BSONObj& projSpec) {
+    bool hasInclusion = false;
+    bool hasExclusion = false;
+    boost::optional<bool> includeId;
+    std::vector<StringData> fields;
+
+    BSONObj ownedSpec = projSpec.getOwned();
+    for (auto&& elem : ownedSpec) {
+        const StringData fieldName = elem.fieldNameStringData();
+        if (fieldName.empty() || fieldName[0] == '$' ||
+            fieldName.find('.') != std::string::npos) {
+            return boost::none;
+        }
+        if (!elem.isNumber() && elem.type() != Bool) {
+            return boost::none;
+        }
+        if (fieldName == kIdField) {
+            includeId = elem.trueValue();
+            continue;
+        }
+        if (elem.trueValue()) {
+            hasInclusion = true;
+        } else {
+            hasExclusion = true;
+        }
+        fields.push_back(fieldName);
+    }
+
+    if (hasInclusion && hasExclusion) {
+        return boost::none;
+    }
+    // ProjectionExec treats an included _id like any other included field, so combined with
+    // exclusions its result depends on the order of the spec. Leave that to ProjectionExec.
+    if (hasExclusion && includeId.value_or(false)) {
+        return boost::none;
+    }
+
+    // With no other fields, {_id: 1} includes only _id and {_id: 0} excludes it.
+    const bool isInclusion = hasInclusion || (!hasExclusion && includeId.value_or(false));
+    if (isInclusion ? includeId.value_or(true) : !includeId.value_or(true)) {
+        fields.push_back(kIdField);
+    }
+    if (fields.empty()) {
+        return boost::none;
+    }
+
+    if (fields.size() > kMaxLinearLookupFields) {
+        std::sort(fields.begin(), fields.end());
+    }
+    return TopLevelProjection(std::move(ownedSpec), isInclusion, std::move(fields));
+}
+
+TopLevelProjection::TopLevelProjection(BSONObj projSpec,
+                                       bool isInclusion,
+                                       std::vector<StringData> fields)
+    : _projSpec(std::move(projSpec)), _isInclusion(isInclusion), _fields(std::move(fields)) {}
+
+bool TopLevelProjection::isListed(StringData fieldName) const {
+    if (_fields.size() > kMaxLinearLookupFields) {
+        return std::binary_search(_fields.begin(), _fields.end(), fieldName);
+    }
+    return std::find(_fields.begin(), _fields.end(), fieldName) != _fields.end();
+}
+
+void TopLevelProjection::project(const BSONObj& in, BSONObjBuilder* bob) const {
+    // The run of adjacent kept elements not yet copied to 'bob'.
+    const char* runStart = nullptr;
+    int runSize = 0;
+
+    for (auto&& elem : in) {
+        if (isListed(elem.fieldNameStringData()) != _isInclusion) {
+            continue;
+        }
+        if (runStart && runStart + runSize == elem.rawdata()) {
+            runSize += elem.size();
+            continue;
+        }
+        if (runStart) {
+            bob->bb().appendBuf(runStart, runSize);
+        }
+        runStart = elem.rawdata();
+        runSize = elem.size();
+    }
+    if (runStart) {
+        bob->bb().appendBuf(runStart, runSize);
+    }
+}
+
+BSONObj TopLevelProjection::project(const BSONObj& in) const {
+    BSONObjBuilder bob;
+    project(in, &bob);
+    return bob.obj();
+}
+
+}  // namespace mongo
@@ -0,0 +1,83 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+
+/**
+ * Executes projections that only include or only exclude top-level fields, such as
+ * {a: 1, b: 1, _id: 0} or {c: 0}, with the same results as ProjectionExec.
+ *
+ * The projected document is built in one pass over the input, copying the bytes of the kept
+ * elements. Adjacent kept elements are copied together.
+ */
+class TopLevelProjection {
+public:
+    /**
+     * Returns the projection for 'projSpec', or boost::none if the spec needs the general
+     * projection machinery: dotted or positional paths, $slice, $elemMatch, $meta, non-numeric
+     * values, or both inclusions and exclusions.
+     */
+    static boost::optional<TopLevelProjection> make(const BSONObj& projSpec);
+
+    /**
+     * Appends the fields of 'in' kept by the projection to 'bob', in their order in 'in'.
+     */
+    void project(const BSONObj& in, BSONObjBuilder* bob) const;
+
+    BSONObj project(const BSONObj& in) const;
+
+    bool isInclusion() const {
+        return _isInclusion;
+    }
+
+private:
+    TopLevelProjection(BSONObj projSpec, bool isInclusion, std::vector<StringData> fields);
+
+    bool isListed(StringData fieldName) const;
+
+    // Owns the field names in '_fields'.
+    BSONObj _projSpec;
+
+    // Whether '_fields' lists the fields to keep, rather than the fields to drop.
+    bool _isInclusion;
+
+    // The fields named by the projection, including _id when it is listed implicitly. Sorted when
+    // there are too many to search linearly.
+    std::vector<StringData> _fields;
+};
+
+}  // namespace mongo
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/top_level_projection.h"
+
+#include "mongo/db/exec/projection_exec.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Projects 'doc' through ProjectionExec, the general implementation.
+ */
+BSONObj projectWithExec(const BSONObj& spec, const BSONObj& doc) {
+    QueryTestServiceContext serviceCtx;
+    auto opCtx = serviceCtx.makeOperationContext();
+    ProjectionExec exec(opCtx.get(), spec, nullptr, nullptr);
+
+    WorkingSetMember wsm;
+    wsm.obj = Snapshotted<BSONObj>(SnapshotId(), doc);
+    wsm.transitionToOwnedObj();
+    ASSERT_OK(exec.transform(&wsm));
+    return wsm.obj.value();
+}
+
+const std::vector<const char*> kDocs = {"{}",
+                                        "{_id: 1}",
+                                        "{a: 1}",
+                                        "{_id: 1, a: 1, b: 2, c: 3}",
+                                        "{c: 3, b: 2, a: 1, _id: 1}",
+                                        "{a: 1, _id: 2, a: 3, b: 4}",
+                                        "{a: {b: 1, c: 2}, b: [1, {c: 2}], d: null}",
+                                        "{x: 1, y: 2, a: 'str', z: 3, b: 1.5}",
+                                        "{_id: {a: 1}, ab: 1, aa: 2, ba: 3}"};
+
+void assertSameAsProjectionExec(const char* specJson) {
+    BSONObj spec = fromjson(specJson);
+    auto projection = TopLevelProjection::make(spec);
+    ASSERT(projection) << specJson;
+    for (auto docJson : kDocs) {
+        BSONObj doc = fromjson(docJson);
+        BSONObj expected = projectWithExec(spec, doc);
+        BSONObj actual = projection->project(doc);
+        ASSERT(actual.binaryEqual(expected))
+            << "spec: " << specJson << " document: " << docJson << " expected: " << expected
+            << " actual: " << actual;
+    }
+}
+
+TEST(TopLevelProjectionTest, InclusionsMatchProjectionExec) {
+    assertSameAsProjectionExec("{a: 1}");
+    assertSameAsProjectionExec("{a: 1, b: 1}");
+    assertSameAsProjectionExec("{b: true, a: 1, _id: 0}");
+    assertSameAsProjectionExec("{a: 1, _id: 1}");
+    assertSameAsProjectionExec("{_id: 1}");
+    assertSameAsProjectionExec("{a: 0.5, c: NumberLong(1), _id: false}");
+    assertSameAsProjectionExec("{missing: 1}");
+    assertSameAsProjectionExec("{a: 1, b: 1, c: 1, d: 1, x: 1, y: 1, z: 1, ab: 1, aa: 1}");
+}
+
+TEST(TopLevelProjectionTest, ExclusionsMatchProjectionExec) {
+    assertSameAsProjectionExec("{a: 0}");
+    assertSameAsProjectionExec("{a: 0, b: false}");
+    assertSameAsProjectionExec("{a: 0, _id: 0}");
+    assertSameAsProjectionExec("{_id: 0}");
+    assertSameAsProjectionExec("{missing: 0}");
+    assertSameAsProjectionExec("{a: 0, b: 0, c: 0, d: 0, x: 0, y: 0, z: 0, ab: 0, aa: 0, _id: 0}");
+}
+
+TEST(TopLevelProjectionTest, RejectsProjectionsNeedingTheGeneralPath) {
+    ASSERT_FALSE(TopLevelProjection::make(BSONObj()));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{'a.b': 1}")));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{'a.$': 1}")));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{a: {$slice: 1}}")));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{a: {$elemMatch: {b: 1}}}")));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{a: {$meta: 'textScore'}}")));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{a: 'str'}")));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{a: 1, b: 0}")));
+    ASSERT_FALSE(TopLevelProjection::make(fromjson("{_id: 1, a: 0}")));
+}
+
+TEST(TopLevelProjectionTest, CopiesAdjacentFieldsTogether) {
+    auto projection = TopLevelProjection::make(fromjson("{b: 0}"));
+    ASSERT(projection);
+    ASSERT_FALSE(projection->isInclusion());
+    ASSERT_BSONOBJ_EQ(projection->project(fromjson("{_id: 1, a: 1, b: 2, c: 3, d: 4}")),
+                      fromjson("{_id: 1, a: 1, c: 3, d: 4}"));
+}
+
+}  // namespace
+}  // namespace mongo
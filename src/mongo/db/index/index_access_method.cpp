@@ -50,6 +50,7 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/timestamp_block.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/sorter/normalized_key_prefix.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
@@ -107,6 +108,20 @@ public:
         return l.second.compare(r.second);
     }
 
+    bool hasNormalizedKeyPrefix() const {
+        // oldCompare() does not order values like BSONElement::woCompare().
+        return _version != IndexVersion::kV0;
+    }
+
+    uint64_t normalizedKeyPrefix(const Data& data) const {
+        BSONElement first = data.first.firstElement();
+        if (first.eoo()) {
+            return 0;  // Empty keys sort first, regardless of the ordering.
+        }
+        return sorter::directedKeyPrefix(sorter::normalizedKeyPrefix(first),
+                                         _ordering.get(0) == 1);
+    }
+
 private:
     const Ordering _ordering;
     const IndexVersion _version;
@@ -53,6 +53,7 @@
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/message_event.h"
@@ -212,6 +213,52 @@ void forkServerOrDie() {
 }
 
 MONGO_EXPORT_SERVER_PARAMETER(maxLogSizeKB, int, logger::LogContext::kDefaultMaxLogSizeKB);
+
+namespace {
+
+// When set, the log file or syslog is written by a dedicated thread, so that threads which log do
+// not wait on the log's I/O. The console and the in-memory "global" RamLog stay synchronous.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(asyncLogging, bool, false);
+
+int asyncLoggingQueueSize = logger::AsyncLogQueue::kDefaultCapacity;
+MONGO_COMPILER_VARIABLE_UNUSED auto _exportedAsyncLoggingQueueSize =
+    (new ExportedServerParameter<int, ServerParameterType::kStartupOnly>(
+        ServerParameterSet::getGlobal(), "asyncLoggingQueueSize", &asyncLoggingQueueSize))
+        -> withValidator([](const int& potentialNewValue) {
+            if (potentialNewValue < 1 || potentialNewValue > (1 << 20)) {
+                return Status(ErrorCodes::BadValue,
+                              "asyncLoggingQueueSize must be between 1 and 1048576, inclusive");
+            }
+            return Status::OK();
+        });
+
+// What to do with a message when the asynchronous log queue is full: "drop" it, counting the loss
+// in the log, or "block" the logging thread until there is room.
+std::string asyncLoggingOverflowPolicy = "drop";
+MONGO_COMPILER_VARIABLE_UNUSED auto _exportedAsyncLoggingOverflowPolicy =
+    (new ExportedServerParameter<std::string, ServerParameterType::kStartupOnly>(
+        ServerParameterSet::getGlobal(),
+        "asyncLoggingOverflowPolicy",
+        &asyncLoggingOverflowPolicy))
+        -> withValidator([](const std::string& potentialNewValue) {
+            if (potentialNewValue != "drop" && potentialNewValue != "block") {
+                return Status(ErrorCodes::BadValue,
+                              "asyncLoggingOverflowPolicy must be either \"drop\" or \"block\"");
+            }
+            return Status::OK();
+        });
+
+std::unique_ptr<logger::MessageLogDomain::EventAppender> makeServerLogAppender(
+    std::unique_ptr<logger::MessageLogDomain::EventAppender> appender) {
+    auto queue = logger::AsyncLogQueue::getGlobal();
+    if (!queue) {
+        return appender;
+    }
+    return std::make_unique<logger::AsyncAppender>(queue, std::move(appender));
+}
+
+}  // namespace
+
 MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
                           ("GlobalLogManager", "EndStartupOptionHandling", "ForkServer"),
                           ("default"))
@@ -227,6 +274,14 @@ MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
     // Hook up this global into our logging encoder
     MessageEventDetailsEncoder::setMaxLogSizeKBSource(maxLogSizeKB);
 
+    // Started after forking, so that the writer thread belongs to the server process.
+    if (asyncLogging) {
+        logger::AsyncLogQueue::setGlobal(std::make_unique<logger::AsyncLogQueue>(
+            asyncLoggingQueueSize,
+            asyncLoggingOverflowPolicy == "block" ? logger::AsyncLogQueue::OverflowPolicy::kBlock
+                                                  : logger::AsyncLogQueue::OverflowPolicy::kDrop));
+    }
+
     if (serverGlobalParams.logWithSyslog) {
 #ifdef _WIN32
         return Status(ErrorCodes::InternalError,
@@ -240,11 +295,12 @@ MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
         LogManager* manager = logger::globalLogManager();
         manager->getGlobalDomain()->clearAppenders();
         manager->getGlobalDomain()->attachAppender(
-            std::make_unique<SyslogAppender<MessageEventEphemeral>>(
-                std::make_unique<logger::MessageEventWithContextEncoder>()));
+            makeServerLogAppender(std::make_unique<SyslogAppender<MessageEventEphemeral>>(
+                std::make_unique<logger::MessageEventWithContextEncoder>())));
         manager->getNamedDomain("javascriptOutput")
-            ->attachAppender(std::make_unique<SyslogAppender<MessageEventEphemeral>>(
-                std::make_unique<logger::MessageEventWithContextEncoder>()));
+            ->attachAppender(
+                makeServerLogAppender(std::make_unique<SyslogAppender<MessageEventEphemeral>>(
+                    std::make_unique<logger::MessageEventWithContextEncoder>())));
 #endif  // defined(_WIN32)
     } else if (!serverGlobalParams.logpath.empty()) {
         fassert(16448, !serverGlobalParams.logWithSyslog);
@@ -300,11 +356,12 @@ MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
         LogManager* manager = logger::globalLogManager();
         manager->getGlobalDomain()->clearAppenders();
         manager->getGlobalDomain()->attachAppender(
-            std::make_unique<RotatableFileAppender<MessageEventEphemeral>>(
-                std::make_unique<MessageEventDetailsEncoder>(), writer.getValue()));
+            makeServerLogAppender(std::make_unique<RotatableFileAppender<MessageEventEphemeral>>(
+                std::make_unique<MessageEventDetailsEncoder>(), writer.getValue())));
         manager->getNamedDomain("javascriptOutput")
-            ->attachAppender(std::make_unique<RotatableFileAppender<MessageEventEphemeral>>(
-                std::make_unique<MessageEventDetailsEncoder>(), writer.getValue()));
+            ->attachAppender(makeServerLogAppender(
+                std::make_unique<RotatableFileAppender<MessageEventEphemeral>>(
+                    std::make_unique<MessageEventDetailsEncoder>(), writer.getValue())));
 
         if (serverGlobalParams.logAppend && exists) {
             log() << "***** SERVER RESTARTED *****";
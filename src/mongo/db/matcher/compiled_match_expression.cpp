@@ -0,0 +1,337 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include <algorithm>
+#include <boost/optional.hpp>
+#include <cmath>
+
+#include "mongo/base/compare_numbers.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+bool isIntegral(const BSONElement& elem) {
+    return elem.type() == NumberInt || elem.type() == NumberLong;
+}
+
+/**
+ * Turns the three-way comparison of a field with the operand into the result of 'matchType'.
+ */
+bool comparisonMatches(MatchExpression::MatchType matchType, int cmp) {
+    switch (matchType) {
+        case MatchExpression::LT:
+            return cmp < 0;
+        case MatchExpression::LTE:
+            return cmp <= 0;
+        case MatchExpression::EQ:
+            return cmp == 0;
+        case MatchExpression::GT:
+            return cmp > 0;
+        case MatchExpression::GTE:
+            return cmp >= 0;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+}  // namespace
+
+constexpr size_t CompiledMatchExpression::kMaxFields;
+
+std::unique_ptr<CompiledMatchExpression> CompiledMatchExpression::compile(
+    const MatchExpression* expr) {
+    std::unique_ptr<CompiledMatchExpression> compiled(new CompiledMatchExpression());
+    compiled->_root = compiled->compileNode(expr);
+    if (compiled->_numCompiledLeaves == 0) {
+        return nullptr;
+    }
+    return compiled;
+}
+
+size_t CompiledMatchExpression::compileNode(const MatchExpression* expr) {
+    boost::optional<NodeKind> treeKind;
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+            treeKind = NodeKind::kAnd;
+            break;
+        case MatchExpression::OR:
+            treeKind = NodeKind::kOr;
+            break;
+        case MatchExpression::NOR:
+            treeKind = NodeKind::kNor;
+            break;
+        case MatchExpression::NOT:
+            treeKind = NodeKind::kNot;
+            break;
+        default:
+            break;
+    }
+
+    if (treeKind) {
+        // Children are compiled first, so that each node's children are contiguous in _children.
+        std::vector<size_t> children;
+        for (size_t i = 0; i < expr->numChildren(); ++i) {
+            children.push_back(compileNode(expr->getChild(i)));
+        }
+        Node node(*treeKind, expr);
+        node.firstChild = _children.size();
+        node.numChildren = children.size();
+        _children.insert(_children.end(), children.begin(), children.end());
+        _nodes.push_back(std::move(node));
+        return _nodes.size() - 1;
+    }
+
+    // Leaves that cannot be compiled stay kInterpret.
+    Node node(NodeKind::kInterpret, expr);
+    if (compileLeaf(expr, &node)) {
+        ++_numCompiledLeaves;
+    }
+    _nodes.push_back(std::move(node));
+    return _nodes.size() - 1;
+}
+
+bool CompiledMatchExpression::compileLeaf(const MatchExpression* expr, Node* node) {
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::GT:
+        case MatchExpression::GTE: {
+            if (!fieldFor(expr->path(), &node->field)) {
+                return false;
+            }
+            node->kind = NodeKind::kCompare;
+
+            const auto* cmp = static_cast<const ComparisonMatchExpression*>(expr);
+            const BSONElement& rhs = cmp->getData();
+            if (isIntegral(rhs)) {
+                node->kernel = Kernel::kIntegral;
+                node->integral = rhs.numberLong();
+            } else if (rhs.type() == NumberDouble && !std::isnan(rhs.numberDouble())) {
+                node->kernel = Kernel::kDouble;
+                node->number = rhs.numberDouble();
+            } else if (rhs.type() == String && !cmp->getCollator()) {
+                node->kernel = Kernel::kString;
+                node->string = rhs.valueStringData();
+            }
+            return true;
+        }
+        case MatchExpression::MATCH_IN: {
+            if (!fieldFor(expr->path(), &node->field)) {
+                return false;
+            }
+            node->kind = NodeKind::kIn;
+
+            const auto* in = static_cast<const InMatchExpression*>(expr);
+            const auto& equalities = in->getEqualities();
+            if (equalities.empty() || !in->getRegexes().empty()) {
+                return true;
+            }
+            auto allOfType = [&](BSONType type) {
+                return std::all_of(equalities.begin(),
+                                   equalities.end(),
+                                   [&](const BSONElement& elem) {
+                                       return elem.type() == type ||
+                                           (type == NumberLong && isIntegral(elem));
+                                   });
+            };
+            if (allOfType(NumberLong)) {
+                node->kernel = Kernel::kIntegral;
+                for (auto&& elem : equalities) {
+                    node->integrals.push_back(elem.numberLong());
+                }
+                std::sort(node->integrals.begin(), node->integrals.end());
+            } else if (allOfType(String) && !in->getCollator()) {
+                node->kernel = Kernel::kString;
+                for (auto&& elem : equalities) {
+                    node->strings.push_back(elem.valueStringData());
+                }
+                std::sort(node->strings.begin(), node->strings.end());
+            }
+            return true;
+        }
+        case MatchExpression::EXISTS: {
+            if (!fieldFor(expr->path(), &node->field)) {
+                return false;
+            }
+            node->kind = NodeKind::kExists;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool CompiledMatchExpression::fieldFor(StringData path, size_t* field) {
+    // Dotted paths may traverse arrays and embedded documents, which is left to the interpreter.
+    if (path.empty() || path.find('.') != std::string::npos) {
+        return false;
+    }
+    auto it = std::find(_fieldNames.begin(), _fieldNames.end(), path);
+    if (it == _fieldNames.end()) {
+        if (_fieldNames.size() == kMaxFields) {
+            return false;
+        }
+        it = _fieldNames.insert(_fieldNames.end(), path.toString());
+    }
+    *field = it - _fieldNames.begin();
+    return true;
+}
+
+bool CompiledMatchExpression::matches(const BSONObj& doc) const {
+    // Fields missing from the document stay EOO, as the interpreter would see them.
+    BSONElement fields[kMaxFields];
+    size_t remaining = _fieldNames.size();
+    BSONObjIterator it(doc);
+    while (remaining > 0 && it.more()) {
+        BSONElement elem = it.next();
+        const StringData name = elem.fieldNameStringData();
+        for (size_t i = 0; i < _fieldNames.size(); ++i) {
+            if (name == _fieldNames[i]) {
+                // Like BSONObj::getField(), the first of duplicate fields wins.
+                if (fields[i].eoo()) {
+                    fields[i] = elem;
+                    --remaining;
+                }
+                break;
+            }
+        }
+    }
+    return evaluate(_root, doc, fields);
+}
+
+bool CompiledMatchExpression::evaluate(size_t index,
+                                       const BSONObj& doc,
+                                       const BSONElement* fields) const {
+    const Node& node = _nodes[index];
+    const size_t* children = _children.data() + node.firstChild;
+    switch (node.kind) {
+        case NodeKind::kAnd:
+            for (size_t i = 0; i < node.numChildren; ++i) {
+                if (!evaluate(children[i], doc, fields)) {
+                    return false;
+                }
+            }
+            return true;
+        case NodeKind::kOr:
+            for (size_t i = 0; i < node.numChildren; ++i) {
+                if (evaluate(children[i], doc, fields)) {
+                    return true;
+                }
+            }
+            return false;
+        case NodeKind::kNor:
+            for (size_t i = 0; i < node.numChildren; ++i) {
+                if (evaluate(children[i], doc, fields)) {
+                    return false;
+                }
+            }
+            return true;
+        case NodeKind::kNot:
+            return !evaluate(children[0], doc, fields);
+        case NodeKind::kInterpret:
+            return node.expr->matchesBSON(doc);
+        case NodeKind::kCompare:
+        case NodeKind::kIn:
+        case NodeKind::kExists: {
+            const BSONElement& field = fields[node.field];
+            if (field.type() == Array) {
+                // Arrays match if any element or the whole array does, which the leaf handles.
+                return node.expr->matchesBSON(doc);
+            }
+            return evaluateLeaf(node, field);
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+bool CompiledMatchExpression::evaluateLeaf(const Node& node, const BSONElement& field) const {
+    // For a top-level field that is not an array, the leaf matches the document exactly when it
+    // matches the field. The kernels below handle fields of the operand's type, in agreement with
+    // the leaf's matchesSingleElement().
+    switch (node.kind) {
+        case NodeKind::kExists:
+            return !field.eoo();
+        case NodeKind::kCompare:
+            switch (node.kernel) {
+                case Kernel::kIntegral:
+                    if (isIntegral(field)) {
+                        return comparisonMatches(node.expr->matchType(),
+                                                 compareLongs(field.numberLong(), node.integral));
+                    }
+                    break;
+                case Kernel::kDouble:
+                    if (field.type() == NumberDouble && !std::isnan(field.numberDouble())) {
+                        return comparisonMatches(
+                            node.expr->matchType(),
+                            compareDoubles(field.numberDouble(), node.number));
+                    }
+                    break;
+                case Kernel::kString:
+                    if (field.type() == String) {
+                        return comparisonMatches(node.expr->matchType(),
+                                                 field.valueStringData().compare(node.string));
+                    }
+                    break;
+                case Kernel::kGeneric:
+                    break;
+            }
+            break;
+        case NodeKind::kIn:
+            switch (node.kernel) {
+                case Kernel::kIntegral:
+                    if (isIntegral(field)) {
+                        return std::binary_search(
+                            node.integrals.begin(), node.integrals.end(), field.numberLong());
+                    }
+                    break;
+                case Kernel::kString:
+                    if (field.type() == String) {
+                        return std::binary_search(
+                            node.strings.begin(), node.strings.end(), field.valueStringData());
+                    }
+                    break;
+                case Kernel::kDouble:
+                case Kernel::kGeneric:
+                    break;
+            }
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+    return node.expr->matchesSingleElement(field);
+}
+
+}  // namespace mongo
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+/**
+ * A MatchExpression lowered into a flat program, which evaluates the expression against a BSON
+ * document without walking the document once for every leaf.
+ *
+ * Leaves on top-level fields ($eq, $lt, $lte, $gt, $gte, $in and $exists) read their field from a
+ * single pass over the document, and integer, double and string operands are compared by
+ * specialized kernels. $and, $or, $nor and $not combine the compiled children. Any other node, and
+ * any leaf whose field holds an array, is evaluated by the MatchExpression itself, so that
+ * matches() always agrees with MatchExpression::matchesBSON().
+ *
+ * The compiled program refers to the MatchExpression it was compiled from, which must outlive it
+ * and must not be modified.
+ */
+class CompiledMatchExpression {
+    MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+
+public:
+    /**
+     * The most distinct top-level fields read in the pass over a document. Leaves on further
+     * fields are evaluated by the MatchExpression.
+     */
+    static constexpr size_t kMaxFields = 16;
+
+    /**
+     * Compiles 'expr'. Returns nullptr if none of its leaves can be compiled, in which case the
+     * caller should evaluate 'expr' directly.
+     */
+    static std::unique_ptr<CompiledMatchExpression> compile(const MatchExpression* expr);
+
+    /**
+     * Returns whether 'doc' matches the expression, with the same result as matchesBSON() on the
+     * expression this was compiled from.
+     */
+    bool matches(const BSONObj& doc) const;
+
+    /**
+     * The number of leaves evaluated by the compiled program rather than by the MatchExpression.
+     */
+    size_t numCompiledLeaves() const {
+        return _numCompiledLeaves;
+    }
+
+private:
+    enum class NodeKind : uint8_t { kAnd, kOr, kNor, kNot, kCompare, kIn, kExists, kInterpret };
+
+    // How a leaf compares its field when the field has the type the kernel is specialized for.
+    // Fields of other types are compared by the leaf's matchesSingleElement().
+    enum class Kernel : uint8_t { kGeneric, kIntegral, kDouble, kString };
+
+    struct Node {
+        Node(NodeKind kind, const MatchExpression* expr) : kind(kind), expr(expr) {}
+
+        NodeKind kind;
+        Kernel kernel = Kernel::kGeneric;
+        const MatchExpression* expr;
+
+        // Leaves: the position of the field among '_fieldNames'.
+        size_t field = 0;
+
+        // $and, $or, $nor and $not: the children are _children[firstChild, firstChild + n).
+        size_t firstChild = 0;
+        size_t numChildren = 0;
+
+        // The operand of a specialized comparison. Strings point into the MatchExpression.
+        long long integral = 0;
+        double number = 0;
+        StringData string;
+
+        // The sorted operands of a specialized $in.
+        std::vector<long long> integrals;
+        std::vector<StringData> strings;
+    };
+
+    CompiledMatchExpression() = default;
+
+    size_t compileNode(const MatchExpression* expr);
+    bool compileLeaf(const MatchExpression* expr, Node* node);
+
+    /**
+     * Returns the position of 'path' among the fields read from the document, adding it if there
+     * is room. Returns false if 'path' is not a top-level field or there are too many fields.
+     */
+    bool fieldFor(StringData path, size_t* field);
+
+    bool evaluate(size_t index, const BSONObj& doc, const BSONElement* fields) const;
+    bool evaluateLeaf(const Node& node, const BSONElement& field) const;
+
+    std::vector<Node> _nodes;
+    std::vector<size_t> _children;
+    size_t _root = 0;
+
+    std::vector<std::string> _fieldNames;
+    size_t _numCompiledLeaves = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,337 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/compiled_match_expression.h"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const BSONObj& filter) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    auto result = MatchExpressionParser::parse(filter, expCtx);
+    ASSERT_OK(result.getStatus());
+    return std::move(result.getValue());
+}
+
+/**
+ * Asserts that the compiled form of 'expr', if there is one, agrees with the interpreter on every
+ * document of 'docs'.
+ */
+void assertSameResults(const MatchExpression* expr, const std::vector<BSONObj>& docs) {
+    auto compiled = CompiledMatchExpression::compile(expr);
+    if (!compiled) {
+        return;
+    }
+    for (auto&& doc : docs) {
+        ASSERT_EQ(expr->matchesBSON(doc), compiled->matches(doc))
+            << "filter: " << expr->toString() << " document: " << doc;
+    }
+}
+
+std::vector<BSONObj> makeDocs(const std::vector<const char*>& jsonDocs) {
+    std::vector<BSONObj> docs;
+    for (auto json : jsonDocs) {
+        docs.push_back(fromjson(json));
+    }
+    return docs;
+}
+
+TEST(CompiledMatchExpressionTest, CompilesTopLevelComparisons) {
+    auto expr = parse(fromjson("{a: 1, b: {$gt: 'x'}, c: {$in: [1, 2]}, d: {$exists: true}}"));
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQ(compiled->numCompiledLeaves(), 4U);
+
+    ASSERT_TRUE(compiled->matches(fromjson("{a: 1, b: 'y', c: 2, d: null}")));
+    ASSERT_FALSE(compiled->matches(fromjson("{a: 1, b: 'y', c: 3, d: null}")));
+    ASSERT_FALSE(compiled->matches(fromjson("{a: 1, b: 'y', c: 2}")));
+    ASSERT_FALSE(compiled->matches(fromjson("{a: 1, b: 'a', c: 2, d: 1}")));
+}
+
+TEST(CompiledMatchExpressionTest, LeavesUnsupportedNodesToTheInterpreter) {
+    auto expr = parse(fromjson("{a: 1, 'b.c': 2, d: {$regex: '^x'}, e: {$size: 1}}"));
+    auto compiled = CompiledMatchExpression::compile(expr.get());
+    ASSERT(compiled);
+    ASSERT_EQ(compiled->numCompiledLeaves(), 1U);
+
+    ASSERT_TRUE(compiled->matches(fromjson("{a: 1, b: {c: 2}, d: 'xy', e: [0]}")));
+    ASSERT_TRUE(compiled->matches(fromjson("{a: [0, 1], b: [{c: 2}], d: 'xy', e: [0]}")));
+    ASSERT_FALSE(compiled->matches(fromjson("{a: 1, b: {c: 2}, d: 'yx', e: [0]}")));
+}
+
+TEST(CompiledMatchExpressionTest, DoesNotCompileWithoutSupportedLeaves) {
+    auto expr = parse(fromjson("{'a.b': 1, c: {$regex: 'x'}}"));
+    ASSERT_FALSE(CompiledMatchExpression::compile(expr.get()));
+}
+
+TEST(CompiledMatchExpressionTest, StringComparisonsRespectCollation) {
+    BSONObj operand = BSON("a"
+                           << "string");
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kAlwaysEqual);
+    EqualityMatchExpression eq("a", operand["a"]);
+    eq.setCollator(&collator);
+
+    auto compiled = CompiledMatchExpression::compile(&eq);
+    ASSERT(compiled);
+    ASSERT_TRUE(compiled->matches(BSON("a"
+                                       << "other")));
+}
+
+TEST(CompiledMatchExpressionTest, AgreesWithInterpreterOnEdgeCases) {
+    auto docs = makeDocs({"{}",
+                          "{a: 1}",
+                          "{a: 1, a: 2}",
+                          "{a: 2, a: 1}",
+                          "{a: NumberLong(1)}",
+                          "{a: 1.0}",
+                          "{a: 1.5}",
+                          "{a: -0.0}",
+                          "{a: NaN}",
+                          "{a: Infinity}",
+                          "{a: NumberDecimal('1')}",
+                          "{a: null}",
+                          "{a: undefined}",
+                          "{a: 'abc'}",
+                          "{a: 'ab'}",
+                          "{a: ''}",
+                          "{a: true}",
+                          "{a: []}",
+                          "{a: [1, 'abc']}",
+                          "{a: [[1]]}",
+                          "{a: {b: 1}}",
+                          "{a: {$minKey: 1}}",
+                          "{a: {$maxKey: 1}}",
+                          "{b: 1, a: 3}"});
+    std::vector<const char*> filters = {"{a: 1}",
+                                        "{a: {$ne: 1}}",
+                                        "{a: {$lt: 1}}",
+                                        "{a: {$lte: NumberLong(1)}}",
+                                        "{a: {$gt: 1.0}}",
+                                        "{a: {$gte: 1.5}}",
+                                        "{a: {$gt: -Infinity}}",
+                                        "{a: {$eq: NaN}}",
+                                        "{a: {$lte: NaN}}",
+                                        "{a: {$gt: NumberDecimal('0.5')}}",
+                                        "{a: null}",
+                                        "{a: {$ne: null}}",
+                                        "{a: {$gte: null}}",
+                                        "{a: 'abc'}",
+                                        "{a: {$lt: 'abc'}}",
+                                        "{a: {$gte: ''}}",
+                                        "{a: true}",
+                                        "{a: [1]}",
+                                        "{a: {b: 1}}",
+                                        "{a: {$lt: {$maxKey: 1}}}",
+                                        "{a: {$gt: {$minKey: 1}}}",
+                                        "{a: {$in: [1, 3]}}",
+                                        "{a: {$in: [NumberLong(1), 2.5]}}",
+                                        "{a: {$in: ['abc', 'ab']}}",
+                                        "{a: {$in: [null, 1]}}",
+                                        "{a: {$in: [[], 'x']}}",
+                                        "{a: {$in: [/^a/, 1]}}",
+                                        "{a: {$nin: [1, 'abc']}}",
+                                        "{a: {$exists: true}}",
+                                        "{a: {$exists: false}}",
+                                        "{a: {$not: {$gt: 1}}}",
+                                        "{$or: [{a: 1}, {b: 1}]}",
+                                        "{$nor: [{a: {$lt: 2}}, {b: {$exists: true}}]}",
+                                        "{$and: [{a: {$gte: 1}}, {a: {$lte: 2}}]}",
+                                        "{a: {$gte: 1}, 'a.b': 1}"};
+    for (auto filter : filters) {
+        auto expr = parse(fromjson(filter));
+        assertSameResults(expr.get(), docs);
+    }
+}
+
+/**
+ * Generates random filters and documents over a few fields and checks that the compiled and
+ * interpreted evaluations agree.
+ */
+class RandomFilterGenerator {
+public:
+    explicit RandomFilterGenerator(int64_t seed) : _random(seed) {}
+
+    BSONObj makeDocument() {
+        BSONObjBuilder builder;
+        for (auto field : kFields) {
+            if (_random.nextInt32(4) != 0) {
+                appendValue(&builder, field);
+            }
+        }
+        return builder.obj();
+    }
+
+    BSONObj makeFilter(int depth = 0) {
+        BSONObjBuilder builder;
+        const int numClauses = 1 + _random.nextInt32(3);
+        for (int i = 0; i < numClauses; ++i) {
+            const int choice = _random.nextInt32(depth < 2 ? 12 : 10);
+            if (choice < 10) {
+                appendPredicate(&builder);
+            } else {
+                const char* op = choice == 10 ? "$or" : "$nor";
+                BSONArrayBuilder children(builder.subarrayStart(op));
+                const int numChildren = 1 + _random.nextInt32(3);
+                for (int j = 0; j < numChildren; ++j) {
+                    children.append(makeFilter(depth + 1));
+                }
+                children.done();
+            }
+        }
+        return builder.obj();
+    }
+
+private:
+    static constexpr const char* kFields[] = {"a", "b", "c", "d"};
+
+    void appendValue(BSONObjBuilder* builder, StringData field) {
+        switch (_random.nextInt32(14)) {
+            case 0:
+                builder->append(field, _random.nextInt32(5));
+                break;
+            case 1:
+                builder->append(field, static_cast<long long>(_random.nextInt32(5)));
+                break;
+            case 2:
+                builder->append(field, _random.nextInt32(9) / 2.0);
+                break;
+            case 3:
+                builder->append(field, std::numeric_limits<double>::quiet_NaN());
+                break;
+            case 4:
+                builder->append(field, std::string(1 + _random.nextInt32(3), 'a'));
+                break;
+            case 5:
+                builder->append(field, std::string(_random.nextInt32(2), 'b'));
+                break;
+            case 6:
+                builder->appendNull(field);
+                break;
+            case 7:
+                builder->append(field, _random.nextInt32(2) == 0);
+                break;
+            case 8:
+                builder->append(field, BSON_ARRAY(_random.nextInt32(5) << "aa"));
+                break;
+            case 9:
+                builder->append(field, BSONArray());
+                break;
+            case 10:
+                builder->append(field, BSON("x" << _random.nextInt32(2)));
+                break;
+            case 11:
+                builder->appendMinKey(field);
+                break;
+            case 12:
+                builder->appendMaxKey(field);
+                break;
+            default:
+                builder->append(field, Decimal128(_random.nextInt32(5)));
+                break;
+        }
+    }
+
+    void appendPredicate(BSONObjBuilder* builder) {
+        // Repeated fields are allowed, and are implicitly and-ed by the parser.
+        const std::string path = kFields[_random.nextInt32(4)];
+
+        static const char* const kComparisons[] = {"$eq", "$ne", "$lt", "$lte", "$gt", "$gte"};
+        switch (_random.nextInt32(6)) {
+            case 0:
+            case 1:
+            case 2: {
+                BSONObjBuilder op(builder->subobjStart(path));
+                appendValue(&op, kComparisons[_random.nextInt32(6)]);
+                break;
+            }
+            case 3: {
+                BSONObjBuilder op(builder->subobjStart(path));
+                BSONArrayBuilder values(op.subarrayStart(_random.nextInt32(2) ? "$in" : "$nin"));
+                const int numValues = _random.nextInt32(4);
+                for (int i = 0; i < numValues; ++i) {
+                    BSONObjBuilder value;
+                    appendValue(&value, "v");
+                    values.append(value.obj().firstElement());
+                }
+                break;
+            }
+            case 4:
+                builder->append(path, BSON("$exists" << (_random.nextInt32(2) == 0)));
+                break;
+            default:
+                // Not compiled: a dotted path.
+                builder->append(path + ".x", _random.nextInt32(2));
+                break;
+        }
+    }
+
+    PseudoRandom _random;
+};
+
+constexpr const char* RandomFilterGenerator::kFields[];
+
+TEST(CompiledMatchExpressionTest, AgreesWithInterpreterOnRandomFilters) {
+    RandomFilterGenerator generator(12345);
+
+    std::vector<BSONObj> docs;
+    for (int i = 0; i < 200; ++i) {
+        docs.push_back(generator.makeDocument());
+    }
+
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    size_t numCompiled = 0;
+    for (int i = 0; i < 2000; ++i) {
+        BSONObj filter = generator.makeFilter();
+        auto result = MatchExpressionParser::parse(filter, expCtx);
+        if (!result.isOK()) {
+            // Some generated operands are not valid for their operator, e.g. $in with a regex.
+            continue;
+        }
+        numCompiled += CompiledMatchExpression::compile(result.getValue().get()) ? 1 : 0;
+        assertSameResults(result.getValue().get(), docs);
+    }
+    ASSERT_GT(numCompiled, 0U);
+}
+
+}  // namespace
+}  // namespace mongo
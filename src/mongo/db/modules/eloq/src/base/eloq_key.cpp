@@ -15,8 +15,10 @@
  *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#include <algorithm>
 #include <cassert>
 #include <string>
+#include <string_view>
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
 #include "mongo/platform/endian.h"
@@ -57,6 +59,65 @@ mongo::RecordId MongoKey::ToRecordId(bool is_long) const {
     }
 }
 
+namespace {
+// Enough bytes to tell apart keys that differ past the common prefix of the bounds, while the
+// fraction still fits the mantissa of a double.
+constexpr size_t kInterpolationBytes = 6;
+
+double BytesAsFraction(std::string_view key, size_t offset) {
+    double fraction = 0;
+    double scale = 1;
+    for (size_t i = offset; i < offset + kInterpolationBytes; ++i) {
+        scale /= 256;
+        if (i < key.size()) {
+            fraction += static_cast<uint8_t>(key[i]) * scale;
+        }
+    }
+    return fraction;
+}
+}  // namespace
+
+double MongoKey::InterpolatePackedKey(std::string_view key,
+                                      std::string_view lo,
+                                      std::string_view hi,
+                                      bool hi_unbounded) {
+    size_t prefix = 0;
+    if (!hi_unbounded) {
+        size_t max_prefix = std::min(lo.size(), hi.size());
+        while (prefix < max_prefix && lo[prefix] == hi[prefix]) {
+            ++prefix;
+        }
+    }
+
+    double lo_fraction = BytesAsFraction(lo, prefix);
+    double hi_fraction = hi_unbounded ? 1.0 : BytesAsFraction(hi, prefix);
+    if (hi_fraction <= lo_fraction) {
+        // The bounds only differ past the interpolated bytes.
+        return 0.5;
+    }
+    double pos = (BytesAsFraction(key, prefix) - lo_fraction) / (hi_fraction - lo_fraction);
+    return std::clamp(pos, 0.0, 1.0);
+}
+
+double MongoKey::PosInInterval(const MongoKey& min_key, const MongoKey& max_key) const {
+    assert(min_key <= max_key);
+
+    if (*this <= min_key) {
+        return 0;
+    } else if (max_key <= *this) {
+        return 1;
+    }
+
+    // Negative infinity sorts below every key, as the empty string does.
+    std::string_view lo =
+        &min_key == NegativeInfinity() ? std::string_view{} : min_key.PackedKeyStringView();
+    bool hi_unbounded = &max_key == PositiveInfinity();
+    return InterpolatePackedKey(PackedKeyStringView(),
+                                lo,
+                                hi_unbounded ? std::string_view{} : max_key.PackedKeyStringView(),
+                                hi_unbounded);
+}
+
 std::string MongoKey::ToString() const {
     if (Type() == txservice::KeyType::NegativeInf) {
         return {"NegativeInf"};
@@ -248,17 +248,12 @@ public:
         return mem_usage;
     }
 
-    double PosInInterval(const MongoKey& min_key, const MongoKey& max_key) const {
-        assert(min_key <= max_key);
-
-        if (*this <= min_key) {
-            return 0;
-        } else if (max_key <= *this) {
-            return 1;
-        } else {
-            return 0.5;
-        }
-    }
+    /**
+     * Returns the approximate position of this key in [min_key, max_key] as a fraction in [0, 1].
+     * Keys are KeyStrings, so their byte order is their sort order: the position is interpolated
+     * on the bytes following the common prefix of the bounds.
+     */
+    double PosInInterval(const MongoKey& min_key, const MongoKey& max_key) const;
 
     double PosInInterval(const txservice::KeySchema* key_schema,
                          const MongoKey& min_key,
@@ -266,6 +261,17 @@ public:
         return PosInInterval(min_key, max_key);
     }
 
+    /**
+     * Interpolates the position of 'key' in [lo, hi] on the kInterpolationBytes bytes following
+     * the common prefix of 'lo' and 'hi', read as a base-256 fraction. 'hi_unbounded' stands for
+     * an upper bound above every key, in which case 'hi' is ignored. The caller guarantees
+     * lo <= key <= hi.
+     */
+    static double InterpolatePackedKey(std::string_view key,
+                                       std::string_view lo,
+                                       std::string_view hi,
+                                       bool hi_unbounded = false);
+
     static const txservice::TxKey* PackedNegativeInfinityTxKey() {
         static const txservice::TxKey packed_negative_infinity_tx_key{PackedNegativeInfinity()};
         return &packed_negative_infinity_tx_key;
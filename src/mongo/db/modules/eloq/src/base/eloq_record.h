@@ -23,11 +23,13 @@
 #include <iomanip>
 #include <memory>
 #include <sstream>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "mongo/db/record_id.h"
+#include "mongo/util/shared_buffer.h"
 
 #include "tx_record.h"
 
@@ -139,7 +141,7 @@ public:
     }
 
     void Copy(const TxRecord& rhs) override {
-        auto typed_rhs = static_cast<const MongoRecord&>(rhs);
+        const auto& typed_rhs = static_cast<const MongoRecord&>(rhs);
 
         encoded_blob_ = typed_rhs.encoded_blob_;
         unpack_info_ = typed_rhs.unpack_info_;
@@ -237,4 +239,137 @@ private:
     std::vector<char> unpack_info_;
 };
 
+/**
+ * Read-only target of a point read whose bytes are handed to a mongo::RecordData. The encoded
+ * blob lives in a ref-counted mongo::SharedBuffer, so reading the record out of the cc-map is
+ * its only copy and ReleaseEncodedBlob() gives the buffer away without another one. Clones are
+ * plain MongoRecords, so nothing but the read itself ever sees this type.
+ */
+class MongoReadRecord final : public txservice::TxRecord {
+public:
+    MongoReadRecord() = default;
+    MongoReadRecord(const MongoReadRecord&) = delete;
+    MongoReadRecord& operator=(const MongoReadRecord&) = delete;
+    ~MongoReadRecord() override = default;
+
+    size_t MemUsage() const override {
+        return sizeof(MongoReadRecord) + encoded_blob_size_ + unpack_info_.capacity();
+    }
+
+    void Serialize(std::vector<char>& buf, size_t& offset) const override {
+        std::string str;
+        Serialize(str);
+        buf.resize(offset + str.size());
+        std::copy(str.begin(), str.end(), buf.begin() + offset);
+        offset += str.size();
+    }
+
+    void Serialize(std::string& str) const override {
+        size_t len = unpack_info_.size();
+        auto len_ptr = reinterpret_cast<const char*>(&len);
+
+        str.append(len_ptr, sizeof(size_t));
+        str.append(unpack_info_.data(), unpack_info_.size());
+
+        len = encoded_blob_size_;
+        str.append(len_ptr, sizeof(size_t));
+        str.append(EncodedBlobData(), encoded_blob_size_);
+    }
+
+    size_t SerializedLength() const override {
+        return sizeof(size_t) * 2 + unpack_info_.size() + encoded_blob_size_;
+    }
+
+    void Deserialize(const char* buf, size_t& offset) override {
+        auto len = *reinterpret_cast<const size_t*>(buf + offset);
+        offset += sizeof(size_t);
+        unpack_info_.assign(buf + offset, len);
+        offset += len;
+
+        len = *reinterpret_cast<const size_t*>(buf + offset);
+        offset += sizeof(size_t);
+        SetEncodedBlob(reinterpret_cast<const unsigned char*>(buf + offset), len);
+        offset += len;
+    }
+
+    TxRecord::Uptr Clone() const override {
+        auto clone = std::make_unique<MongoRecord>();
+        clone->SetUnpackInfo(reinterpret_cast<const unsigned char*>(unpack_info_.data()),
+                             unpack_info_.size());
+        clone->SetEncodedBlob({EncodedBlobData(), encoded_blob_size_});
+        return clone;
+    }
+
+    void Copy(const TxRecord& rhs) override {
+        SetUnpackInfo(reinterpret_cast<const unsigned char*>(rhs.UnpackInfoData()),
+                      rhs.UnpackInfoSize());
+        SetEncodedBlob(reinterpret_cast<const unsigned char*>(rhs.EncodedBlobData()),
+                       rhs.EncodedBlobSize());
+    }
+
+    std::string ToString() const override {
+        if (encoded_blob_size_ == 0) {
+            return {"NULL"};
+        }
+
+        std::stringstream ss;
+        ss << "0x";
+        ss << std::hex << std::setfill('0');
+        for (size_t i = 0; i < encoded_blob_size_; ++i) {
+            ss << std::setw(2) << static_cast<unsigned>(static_cast<uint8_t>(EncodedBlobData()[i]));
+        }
+        return ss.str();
+    }
+
+    void SetUnpackInfo(const unsigned char* unpack_ptr, const size_t unpack_size) override {
+        unpack_info_.assign(reinterpret_cast<const char*>(unpack_ptr), unpack_size);
+    }
+
+    void SetEncodedBlob(const unsigned char* blob_ptr, const size_t blob_size) override {
+        encoded_blob_ = mongo::SharedBuffer::allocate(blob_size);
+        std::memcpy(encoded_blob_.get(), blob_ptr, blob_size);
+        encoded_blob_size_ = blob_size;
+    }
+
+    const char* EncodedBlobData() const override {
+        return encoded_blob_.get();
+    }
+
+    size_t EncodedBlobSize() const override {
+        return encoded_blob_size_;
+    }
+
+    /**
+     * Hands the encoded blob over to the caller, leaving this record empty.
+     */
+    mongo::SharedBuffer ReleaseEncodedBlob() {
+        encoded_blob_size_ = 0;
+        return std::move(encoded_blob_);
+    }
+
+    bool NeedsDefrag(mi_heap_t* heap) override {
+        // Never stored in the cc-map.
+        return false;
+    }
+
+    size_t Size() const override {
+        return encoded_blob_size_ + unpack_info_.size();
+    }
+
+    const char* UnpackInfoData() const override {
+        return unpack_info_.data();
+    }
+
+    size_t UnpackInfoSize() const override {
+        return unpack_info_.size();
+    }
+
+    void Prefetch() const override {}
+
+private:
+    mongo::SharedBuffer encoded_blob_;
+    size_t encoded_blob_size_{0};
+    std::string unpack_info_;
+};
+
 }  // namespace Eloq
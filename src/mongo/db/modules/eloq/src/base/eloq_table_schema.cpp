@@ -373,24 +373,115 @@ void MongoTableSchema::IndexesSetMultiKeyAttr(const std::vector<txservice::Multi
     schema_image_ = EloqDS::SerializeSchemaImage(meta_data_str_, kv_info_str_, key_schemas_ts_str_);
 }
 
-bool MongoSkEncoder::GenerateBSONKeys(const txservice::TxKey* pk,
-                                      const txservice::TxRecord* record,
-                                      mongo::BSONObjSet* skeys) {
-    bool succeed = false;
+TopLevelKeyGenerator::TopLevelKeyGenerator(const mongo::BSONObj& key_pattern, bool sparse)
+    : key_pattern_(key_pattern.getOwned()), sparse_(sparse) {
+    for (const mongo::BSONElement& elem : key_pattern_) {
+        fields_.push_back(elem.fieldNameStringData());
+    }
+}
 
+bool TopLevelKeyGenerator::Supports(const mongo::IndexCatalogEntry* entry) {
+    const mongo::IndexDescriptor* desc = entry->descriptor();
+    if (desc->getAccessMethodName() != mongo::IndexNames::BTREE ||
+        desc->version() == mongo::IndexDescriptor::IndexVersion::kV0 || entry->getCollator() ||
+        entry->getFilterExpression()) {
+        return false;
+    }
+    for (const mongo::BSONElement& elem : desc->keyPattern()) {
+        if (elem.fieldNameStringData().find('.') != std::string::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<int32_t> TopLevelKeyGenerator::GetKey(const mongo::BSONObj& obj,
+                                                    mongo::BufBuilder* key_buf) {
+    // Like the btree key generator, use the first occurrence of each key field.
+    elems_.assign(fields_.size(), mongo::BSONElement());
+    size_t num_found = 0;
+    for (const mongo::BSONElement& elem : obj) {
+        const mongo::StringData name = elem.fieldNameStringData();
+        for (size_t i = 0; i < fields_.size(); ++i) {
+            if (elems_[i].eoo() && fields_[i] == name) {
+                if (elem.type() == mongo::Array) {
+                    // Multikey, which needs the general key generator.
+                    return std::nullopt;
+                }
+                elems_[i] = elem;
+                ++num_found;
+            }
+        }
+        if (num_found == fields_.size()) {
+            break;
+        }
+    }
+
+    if (num_found == 0 && sparse_) {
+        return 0;
+    }
+
+    key_buf->reset();
+    mongo::BSONObjBuilder builder(*key_buf);
+    for (const mongo::BSONElement& elem : elems_) {
+        if (elem.eoo()) {
+            builder.appendNull("");
+        } else {
+            builder.appendAs(elem, "");
+        }
+    }
+    builder.doneFast();
+    return 1;
+}
+
+MongoSkEncoder::MongoSkEncoder(const MongoKeySchema* key_schema)
+    : key_schema_(key_schema),
+      mutable_multikey_(false),
+      mutable_multikey_paths_(key_schema->IndexDescriptor()) {
+    if (TopLevelKeyGenerator::Supports(key_schema->entry_.get())) {
+        const mongo::IndexDescriptor* desc = key_schema->IndexDescriptor();
+        top_level_key_gen_.emplace(desc->keyPattern(), desc->isSparse());
+    }
+}
+
+template <typename AppendKey>
+int32_t MongoSkEncoder::ForEachKey(const txservice::TxKey* pk,
+                                   const txservice::TxRecord* record,
+                                   const AppendKey& append_key) {
     const auto* mongo_rec = static_cast<const MongoRecord*>(record);
 
     mongo::BSONObj record_obj(mongo_rec->EncodedBlobData());
 
-    invariant(([pk, &record_obj]() {
-                  const MongoKey* mongo_pk = pk->GetKey<MongoKey>();
-                  mongo::RecordId record_id(mongo_pk->Data(), mongo_pk->Size());
-                  mongo::BSONObj id_obj = mongo::getIdBSONObjWithoutFieldName(record_obj);
-                  mongo::KeyString keystring_pk(
-                      mongo::KeyString::kLatestVersion, id_obj, mongo::kIdOrdering);
-                  return record_id ==
-                      mongo::RecordId(keystring_pk.getBuffer(), keystring_pk.getSize());
-              }()) == true);
+    dassert(([pk, &record_obj]() {
+                const MongoKey* mongo_pk = pk->GetKey<MongoKey>();
+                mongo::RecordId record_id(mongo_pk->Data(), mongo_pk->Size());
+                mongo::BSONObj id_obj = mongo::getIdBSONObjWithoutFieldName(record_obj);
+                mongo::KeyString keystring_pk(
+                    mongo::KeyString::kLatestVersion, id_obj, mongo::kIdOrdering);
+                return record_id ==
+                    mongo::RecordId(keystring_pk.getBuffer(), keystring_pk.getSize());
+            }()) == true);
+
+    if (std::optional<int32_t> num_keys = GenerateSimpleKey(record_obj)) {
+        if (*num_keys == 1) {
+            append_key(mongo::BSONObj(key_buf_.buf()));
+        }
+        return *num_keys;
+    }
+
+    mongo::BSONObjSet skeys = mongo::SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    if (!GenerateBSONKeys(record_obj, &skeys)) {
+        return -1;
+    }
+    for (const mongo::BSONObj& bson_sk : skeys) {
+        append_key(bson_sk);
+    }
+    return static_cast<int32_t>(skeys.size());
+}
+
+bool MongoSkEncoder::GenerateBSONKeys(const mongo::BSONObj& record_obj,
+                                      mongo::BSONObjSet* skeys) {
+    bool succeed = false;
 
     try {
         mongo::MultikeyPaths multikey_paths;
@@ -421,6 +512,32 @@ bool MongoSkEncoder::GenerateBSONKeys(const txservice::TxKey* pk,
     return succeed;
 }
 
+std::optional<int32_t> MongoSkEncoder::GenerateSimpleKey(const mongo::BSONObj& record_obj) {
+    if (!top_level_key_gen_) {
+        return std::nullopt;
+    }
+
+    const std::optional<int32_t> num_keys = top_level_key_gen_->GetKey(record_obj, &key_buf_);
+    if (num_keys != 1) {
+        if (num_keys) {
+            txservice::SkEncoder::ClearError();
+        }
+        return num_keys;
+    }
+
+    if (mongo::failIndexKeyTooLong.load()) {
+        mongo::Status status = mongo::checkKeySize(mongo::BSONObj(key_buf_.buf()),
+                                                   key_schema_->index_name_.StringView());
+        if (!status.isOK()) {
+            txservice::SkEncoder::SetError(status.code(), status.reason().c_str());
+            MONGO_LOG(1) << "MongoSkEncoder::GenerateSimpleKey " << status;
+            return -1;
+        }
+    }
+    txservice::SkEncoder::ClearError();
+    return 1;
+}
+
 mongo::RecordId MongoSkEncoder::GenerateRecordID(const txservice::TxKey* pk) const {
     const MongoKey* mongo_pk = pk->GetKey<MongoKey>();
     return mongo::RecordId(mongo_pk->Data(), mongo_pk->Size());
@@ -435,55 +552,39 @@ int32_t MongoStandardSkEncoder::AppendPackedSk(const txservice::TxKey* pk,
                                                const txservice::TxRecord* record,
                                                uint64_t version_ts,
                                                std::vector<txservice::WriteEntry>& dest_vec) {
-    mongo::BSONObjSet skeys = mongo::SimpleBSONObjComparator::kInstance.makeBSONObjSet();
-    bool succeed = GenerateBSONKeys(pk, record, &skeys);
-    if (!succeed) {
-        return -1;
-    }
-    if (!skeys.empty()) {
-        mongo::RecordId record_id = GenerateRecordID(pk);
-        for (const mongo::BSONObj& bson_sk : skeys) {
-            mongo::KeyString keystring_sk(
-                mongo::KeyString::kLatestVersion, bson_sk, key_schema_->Ordering(), record_id);
-            auto mongo_sk =
-                std::make_unique<MongoKey>(keystring_sk.getBuffer(), keystring_sk.getSize());
-            auto mongo_sk_rec = std::make_unique<MongoRecord>();
-            if (const auto& type_bits = keystring_sk.getTypeBits(); !type_bits.isAllZeros()) {
-                mongo_sk_rec->SetUnpackInfo(type_bits.getBuffer(), type_bits.getSize());
-            }
-            dest_vec.emplace_back(
-                txservice::TxKey(std::move(mongo_sk)), std::move(mongo_sk_rec), version_ts);
+    const mongo::RecordId record_id = GenerateRecordID(pk);
+    return ForEachKey(pk, record, [&](const mongo::BSONObj& bson_sk) {
+        mongo::KeyString keystring_sk(
+            mongo::KeyString::kLatestVersion, bson_sk, key_schema_->Ordering(), record_id);
+        auto mongo_sk =
+            std::make_unique<MongoKey>(keystring_sk.getBuffer(), keystring_sk.getSize());
+        auto mongo_sk_rec = std::make_unique<MongoRecord>();
+        if (const auto& type_bits = keystring_sk.getTypeBits(); !type_bits.isAllZeros()) {
+            mongo_sk_rec->SetUnpackInfo(type_bits.getBuffer(), type_bits.getSize());
         }
-    }
-    return static_cast<int32_t>(skeys.size());
+        dest_vec.emplace_back(
+            txservice::TxKey(std::move(mongo_sk)), std::move(mongo_sk_rec), version_ts);
+    });
 }
 
 int32_t MongoUniqueSkEncoder::AppendPackedSk(const txservice::TxKey* pk,
                                              const txservice::TxRecord* record,
                                              uint64_t version_ts,
                                              std::vector<txservice::WriteEntry>& dest_vec) {
-    mongo::BSONObjSet skeys = mongo::SimpleBSONObjComparator::kInstance.makeBSONObjSet();
-    bool succeed = GenerateBSONKeys(pk, record, &skeys);
-    if (!succeed) {
-        return -1;
-    }
-    if (!skeys.empty()) {
-        mongo::RecordId record_id = GenerateRecordID(pk);
-        for (const mongo::BSONObj& bson_sk : skeys) {
-            mongo::KeyString keystring_sk(
-                mongo::KeyString::kLatestVersion, bson_sk, key_schema_->Ordering());
-            auto mongo_sk =
-                std::make_unique<MongoKey>(keystring_sk.getBuffer(), keystring_sk.getSize());
-            auto mongo_sk_rec = std::make_unique<MongoRecord>();
-            mongo_sk_rec->SetEncodedBlob(record_id.getStringView());
-            if (const auto& type_bits = keystring_sk.getTypeBits(); !type_bits.isAllZeros()) {
-                mongo_sk_rec->SetUnpackInfo(type_bits.getBuffer(), type_bits.getSize());
-            }
-            dest_vec.emplace_back(
-                txservice::TxKey(std::move(mongo_sk)), std::move(mongo_sk_rec), version_ts);
+    const mongo::RecordId record_id = GenerateRecordID(pk);
+    return ForEachKey(pk, record, [&](const mongo::BSONObj& bson_sk) {
+        mongo::KeyString keystring_sk(
+            mongo::KeyString::kLatestVersion, bson_sk, key_schema_->Ordering());
+        auto mongo_sk =
+            std::make_unique<MongoKey>(keystring_sk.getBuffer(), keystring_sk.getSize());
+        auto mongo_sk_rec = std::make_unique<MongoRecord>();
+        mongo_sk_rec->SetEncodedBlob(record_id.getStringView());
+        if (const auto& type_bits = keystring_sk.getTypeBits(); !type_bits.isAllZeros()) {
+            mongo_sk_rec->SetUnpackInfo(type_bits.getBuffer(), type_bits.getSize());
         }
-    }
-    return static_cast<int32_t>(skeys.size());
+        dest_vec.emplace_back(
+            txservice::TxKey(std::move(mongo_sk)), std::move(mongo_sk_rec), version_ts);
+    });
 }
 
 }  // namespace Eloq
@@ -21,8 +21,10 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/util/builder.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/index/index_access_method.h"
@@ -392,12 +394,39 @@ private:
     std::shared_ptr<txservice::TableStatistics<MongoKey>> table_statistics_{nullptr};
 };
 
+/**
+ * Builds the key of a btree index whose key fields are all top-level, for documents in which none
+ * of those fields holds an array. The key is written into a caller-owned buffer, so generating a
+ * key does not allocate once the buffer has grown to fit.
+ */
+class TopLevelKeyGenerator {
+public:
+    TopLevelKeyGenerator(const mongo::BSONObj& key_pattern, bool sparse);
+
+    /**
+     * Returns whether keys of 'entry' can be built by this class: it must be a btree index (v1 or
+     * later) without a collation or a partial filter, over top-level fields only.
+     */
+    static bool Supports(const mongo::IndexCatalogEntry* entry);
+
+    /**
+     * Writes the key of 'obj' into 'key_buf' and returns the number of keys (0 or 1), or
+     * std::nullopt if a key field holds an array and the general key generator is needed.
+     */
+    std::optional<int32_t> GetKey(const mongo::BSONObj& obj, mongo::BufBuilder* key_buf);
+
+private:
+    const mongo::BSONObj key_pattern_;
+    const bool sparse_;
+    std::vector<mongo::StringData> fields_;  // Points into key_pattern_.
+
+    // The element of each key field in the current document. Reused across documents.
+    std::vector<mongo::BSONElement> elems_;
+};
+
 class MongoSkEncoder : public txservice::SkEncoder {
 public:
-    explicit MongoSkEncoder(const MongoKeySchema* key_schema)
-        : key_schema_(key_schema),
-          mutable_multikey_(false),
-          mutable_multikey_paths_(key_schema->IndexDescriptor()) {}
+    explicit MongoSkEncoder(const MongoKeySchema* key_schema);
 
     bool IsMultiKey() const override {
         return mutable_multikey_;
@@ -412,13 +441,27 @@ public:
     }
 
 protected:
-    bool GenerateBSONKeys(const txservice::TxKey* pk,
-                          const txservice::TxRecord* record,
-                          mongo::BSONObjSet* skeys);
+    /**
+     * Calls 'append_key' with each secondary key of 'record'. Returns the number of keys, or -1
+     * on error.
+     */
+    template <typename AppendKey>
+    int32_t ForEachKey(const txservice::TxKey* pk,
+                       const txservice::TxRecord* record,
+                       const AppendKey& append_key);
 
     mongo::RecordId GenerateRecordID(const txservice::TxKey* pk) const;
 
 private:
+    bool GenerateBSONKeys(const mongo::BSONObj& record_obj, mongo::BSONObjSet* skeys);
+
+    /**
+     * Builds the only key of 'record_obj' in key_buf_ with top_level_key_gen_. Returns the number
+     * of keys (0 or 1), -1 on error, or std::nullopt if the record needs the general key
+     * generator.
+     */
+    std::optional<int32_t> GenerateSimpleKey(const mongo::BSONObj& record_obj);
+
     void MergeMultiKeyAttr(const mongo::MultikeyPaths& multikey_paths);
 
 protected:
@@ -426,6 +469,12 @@ protected:
 
     bool mutable_multikey_;
     MongoMultiKeyPaths mutable_multikey_paths_;
+
+private:
+    // Set if TopLevelKeyGenerator supports the index. Its keys are built in key_buf_, which is
+    // reused across records.
+    std::optional<TopLevelKeyGenerator> top_level_key_gen_;
+    mongo::BufBuilder key_buf_;
 };
 
 class MongoStandardSkEncoder final : public MongoSkEncoder {
@@ -12,7 +12,9 @@ Status TxErrorCodeToMongoStatus(txservice::TxErrorCode txErr) {
     if (MONGO_likely(txErr == txservice::TxErrorCode::NO_ERROR))
         return Status::OK();
 
-    log() << "eloq engine error report: " << txservice::TxErrorMessage(txErr);
+    // Duplicate keys and write conflicts are routine, and the returned status or the thrown
+    // WriteConflictException already carries the error.
+    MONGO_LOG(1) << "eloq engine error report: " << txservice::TxErrorMessage(txErr);
 
     ErrorCodes::Error err;
     switch (txErr) {
@@ -15,7 +15,6 @@
  *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-#include <mutex>
 #include <utility>
 
 #include <glog/logging.h>
@@ -54,14 +53,17 @@ metrics::MetricKey MetricsRegistryImpl::Register(const metrics::Name& name,
 
     auto key = metric_collector->metric_key_;
 
-    std::unique_lock<std::mutex> lock(collectors_mu_);
-    collectors_.insert(std::make_pair(key, std::move(metric_collector)));
-
+    // A key that is already registered keeps its first collector.
+    if (collectors_.Add(key, std::move(metric_collector)) == collectors_.kCapacity) {
+        CHECK(collectors_.Find(key) != nullptr)
+            << "too many metrics registered: " << name.GetName();
+    }
     return key;
 }
 
 void MetricsRegistryImpl::Collect(metrics::MetricKey key, const metrics::Value& val) {
-    auto collector = collectors_[key].get();
+    auto collector = collectors_.Find(key);
+    CHECK(collector != nullptr) << "metric key " << key << " was never registered";
     collector->Collect(val);
 }
 }  // namespace Eloq
\ No newline at end of file
@@ -18,12 +18,11 @@
 #pragma once
 
 #include <memory>
-#include <mutex>
 #include <string>
-#include <unordered_map>
 
 #include "metrics.h"
 #include "metrics_manager.h"
+#include "metrics_slot_table.h"
 
 namespace Eloq {
 class MetricsRegistryImpl : public metrics::MetricsRegistry {
@@ -51,12 +50,8 @@ private:
     metrics::MetricsMgr::MetricsMgrResult metrics_mgr_result_ =
         metrics::MetricsMgr::GetMetricMgrInstance();
 
-    std::unordered_map<metrics::MetricKey, std::unique_ptr<metrics::CollectorWrapper>>
-        collectors_{};
-
-    // Mutex to exclusively protect 'collectors_' during write operations in
-    // multi-threaded environments. Use this mutex solely for guarding
-    // modifications to 'collectors_'.
-    std::mutex collectors_mu_;
+    // Keyed by the metric_key_ of each collector, which Register() hands out, so that Collect()
+    // from any thread is a lock-free lookup racing with nothing but later registrations.
+    MetricsSlotTable<metrics::MetricKey, metrics::CollectorWrapper> collectors_;
 };
 }  // namespace Eloq
\ No newline at end of file
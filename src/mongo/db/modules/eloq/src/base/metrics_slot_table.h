@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+
+namespace Eloq {
+
+/**
+ * Append-only table of owned T objects registered under integral keys. Add() stores each object
+ * in the next free slot, and Find() resolves a key to its object through an open-addressing index
+ * over the slots, so keys may be arbitrary values such as hashes.
+ *
+ * Find() and Get() take no lock and may run on any thread concurrently with Add(): a slot and its
+ * index bucket are published with release stores after the object and its key are written.
+ * Slots are stored in chunks of kChunkSize which are never moved or freed before the table
+ * itself, so an object stays valid for the table's lifetime.
+ */
+template <typename Key, typename T, size_t kChunkSize = 256, size_t kMaxChunks = 64>
+class MetricsSlotTable {
+    static_assert(std::is_integral<Key>::value, "keys are hashed as integers");
+
+public:
+    static constexpr size_t kCapacity = kChunkSize * kMaxChunks;
+    static_assert((kCapacity & (kCapacity - 1)) == 0, "the capacity must be a power of two");
+    static_assert(kCapacity < std::numeric_limits<uint32_t>::max(), "slots are indexed as uint32");
+
+    MetricsSlotTable() = default;
+    MetricsSlotTable(const MetricsSlotTable&) = delete;
+    MetricsSlotTable& operator=(const MetricsSlotTable&) = delete;
+
+    ~MetricsSlotTable() {
+        for (auto& chunk_ptr : chunks_) {
+            Chunk* chunk = chunk_ptr.load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                break;
+            }
+            for (auto& slot : chunk->slots) {
+                delete slot.value.load(std::memory_order_relaxed);
+            }
+            delete chunk;
+        }
+    }
+
+    /**
+     * Takes ownership of 'value' and stores it under 'key'. Returns its slot, or kCapacity with
+     * 'value' destroyed if the table is full or 'key' is taken, in which case the object added
+     * first keeps the key.
+     */
+    size_t Add(Key key, std::unique_ptr<T> value) {
+        std::lock_guard<std::mutex> lk(add_mu_);
+        size_t bucket = BucketOf(key);
+        for (uint32_t entry; (entry = index_[bucket].load(std::memory_order_relaxed)) != 0;
+             bucket = (bucket + 1) % kIndexSize) {
+            if (SlotAt(entry - 1).key == key) {
+                return kCapacity;
+            }
+        }
+
+        const size_t slot = size_.load(std::memory_order_relaxed);
+        if (slot == kCapacity) {
+            return kCapacity;
+        }
+
+        auto& chunk_ptr = chunks_[slot / kChunkSize];
+        Chunk* chunk = chunk_ptr.load(std::memory_order_relaxed);
+        if (chunk == nullptr) {
+            chunk = new Chunk();
+            chunk_ptr.store(chunk, std::memory_order_release);
+        }
+        Slot& stored = chunk->slots[slot % kChunkSize];
+        stored.key = key;
+        stored.value.store(value.release(), std::memory_order_release);
+        size_.store(slot + 1, std::memory_order_release);
+        index_[bucket].store(static_cast<uint32_t>(slot + 1), std::memory_order_release);
+        return slot;
+    }
+
+    /**
+     * Returns the object added under 'key', or nullptr if there is none.
+     */
+    T* Find(Key key) const {
+        for (size_t bucket = BucketOf(key);; bucket = (bucket + 1) % kIndexSize) {
+            const uint32_t entry = index_[bucket].load(std::memory_order_acquire);
+            if (entry == 0) {
+                return nullptr;
+            }
+            const Slot& slot = SlotAt(entry - 1);
+            if (slot.key == key) {
+                return slot.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 'slot' must be below Size().
+    T* Get(size_t slot) const {
+        return SlotAt(slot).value.load(std::memory_order_acquire);
+    }
+
+    size_t Size() const {
+        return size_.load(std::memory_order_acquire);
+    }
+
+private:
+    // At most half of the index buckets are used, which keeps probe sequences short and ensures
+    // that every probe ends at an empty bucket.
+    static constexpr size_t kIndexSize = 2 * kCapacity;
+
+    struct Slot {
+        Key key{};
+        std::atomic<T*> value{nullptr};
+    };
+
+    struct Chunk {
+        std::array<Slot, kChunkSize> slots{};
+    };
+
+    static size_t BucketOf(Key key) {
+        // Fibonacci hashing spreads sequential keys as well as hashes.
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> 32) %
+            kIndexSize;
+    }
+
+    const Slot& SlotAt(size_t slot) const {
+        Chunk* chunk = chunks_[slot / kChunkSize].load(std::memory_order_acquire);
+        return chunk->slots[slot % kChunkSize];
+    }
+
+    std::array<std::atomic<Chunk*>, kMaxChunks> chunks_{};
+    std::atomic<size_t> size_{0};
+    // Slot + 1 of the object in each bucket, 0 for an empty bucket.
+    std::array<std::atomic<uint32_t>, kIndexSize> index_{};
+    // Serializes Add(), which is rare next to Find().
+    std::mutex add_mu_;
+};
+
+}  // namespace Eloq
@@ -0,0 +1,148 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+
+#include "mongo/db/modules/eloq/src/base/metrics_slot_table.h"
+
+namespace Eloq {
+namespace {
+
+struct TestCollector {
+    TestCollector(size_t owner, size_t seq) : owner(owner), seq(seq) {}
+
+    const size_t owner;
+    const size_t seq;
+    std::atomic<int64_t> collected{0};
+};
+
+// Keys as sparse as the hashes metric keys may be.
+size_t keyOf(size_t owner, size_t seq) {
+    return (owner << 32) + seq * 7919 + 1;
+}
+
+TEST(MetricsSlotTableTest, FindsObjectsByKey) {
+    MetricsSlotTable<size_t, TestCollector, 4, 8> table;
+    std::vector<TestCollector*> added;
+    for (size_t i = 0; i < 10; ++i) {
+        auto collector = std::make_unique<TestCollector>(0, i);
+        added.push_back(collector.get());
+        ASSERT_EQ(i, table.Add(keyOf(0, i), std::move(collector)));
+    }
+    ASSERT_EQ(10U, table.Size());
+    for (size_t i = 0; i < added.size(); ++i) {
+        ASSERT_EQ(added[i], table.Find(keyOf(0, i)));
+        ASSERT_EQ(added[i], table.Get(i));
+    }
+    ASSERT(table.Find(keyOf(1, 0)) == nullptr);
+}
+
+TEST(MetricsSlotTableTest, FirstObjectKeepsItsKey) {
+    MetricsSlotTable<size_t, TestCollector, 4, 8> table;
+    auto first = std::make_unique<TestCollector>(0, 0);
+    TestCollector* firstPtr = first.get();
+    ASSERT_EQ(0U, table.Add(42, std::move(first)));
+    ASSERT_EQ(table.kCapacity, table.Add(42, std::make_unique<TestCollector>(0, 1)));
+    ASSERT_EQ(1U, table.Size());
+    ASSERT_EQ(firstPtr, table.Find(42));
+}
+
+TEST(MetricsSlotTableTest, AddFailsWhenFull) {
+    MetricsSlotTable<size_t, TestCollector, 4, 2> table;
+    for (size_t i = 0; i < table.kCapacity; ++i) {
+        ASSERT_EQ(i, table.Add(keyOf(0, i), std::make_unique<TestCollector>(0, i)));
+    }
+    ASSERT_EQ(table.kCapacity,
+              table.Add(keyOf(0, table.kCapacity),
+                        std::make_unique<TestCollector>(0, table.kCapacity)));
+    ASSERT_EQ(table.kCapacity, table.Size());
+    for (size_t i = 0; i < table.kCapacity; ++i) {
+        ASSERT_EQ(i, table.Find(keyOf(0, i))->seq);
+    }
+}
+
+// Registering threads race with collecting threads that look up every key added so far. Run
+// under TSan, this covers the publication of new chunks, slots and index buckets.
+TEST(MetricsSlotTableTest, ConcurrentAddAndFind) {
+    constexpr size_t kAdders = 4;
+    constexpr size_t kCollectors = 4;
+    constexpr size_t kAddsPerThread = 2000;
+    MetricsSlotTable<size_t, TestCollector, 16, 1024> table;
+
+    std::atomic<size_t> addersRunning{kAdders};
+    std::vector<std::vector<size_t>> slotsByAdder(kAdders);
+    std::vector<std::thread> threads;
+    for (size_t owner = 0; owner < kAdders; ++owner) {
+        threads.emplace_back([&, owner] {
+            for (size_t seq = 0; seq < kAddsPerThread; ++seq) {
+                slotsByAdder[owner].push_back(
+                    table.Add(keyOf(owner, seq), std::make_unique<TestCollector>(owner, seq)));
+            }
+            addersRunning.fetch_sub(1);
+        });
+    }
+    for (size_t i = 0; i < kCollectors; ++i) {
+        threads.emplace_back([&] {
+            bool lastPass = false;
+            while (!lastPass) {
+                lastPass = addersRunning.load() == 0;
+                const size_t size = table.Size();
+                for (size_t slot = 0; slot < size; ++slot) {
+                    const TestCollector* added = table.Get(slot);
+                    TestCollector* found = table.Find(keyOf(added->owner, added->seq));
+                    // The slot is published before its index bucket.
+                    if (found != nullptr) {
+                        ASSERT_EQ(added, found);
+                        found->collected.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(kAdders * kAddsPerThread, table.Size());
+    std::vector<bool> seen(table.Size(), false);
+    for (size_t owner = 0; owner < kAdders; ++owner) {
+        ASSERT_EQ(kAddsPerThread, slotsByAdder[owner].size());
+        for (size_t seq = 0; seq < kAddsPerThread; ++seq) {
+            const size_t slot = slotsByAdder[owner][seq];
+            ASSERT(!seen[slot]);
+            seen[slot] = true;
+            const TestCollector* collector = table.Find(keyOf(owner, seq));
+            ASSERT_EQ(table.Get(slot), collector);
+            ASSERT_EQ(owner, collector->owner);
+            ASSERT_EQ(seq, collector->seq);
+            // Every collecting thread makes a final pass over all keys.
+            ASSERT_GREATER_THAN_OR_EQUALS(collector->collected.load(),
+                                          static_cast<int64_t>(kCollectors));
+        }
+    }
+}
+
+}  // namespace
+}  // namespace Eloq
@@ -0,0 +1,394 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/oid.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/index/btree_key_generator.h"
+#include "mongo/db/storage/key_string.h"
+
+#include "mongo/db/modules/eloq/src/base/eloq_key.h"
+#include "mongo/db/modules/eloq/src/base/eloq_record.h"
+#include "mongo/db/modules/eloq/src/base/eloq_table_schema.h"
+#include "mongo/db/modules/eloq/src/base/eloq_util.h"
+#include "mongo/db/modules/eloq/src/base/metrics_slot_table.h"
+#include "mongo/db/modules/eloq/src/eloq_record_store.h"
+#include "mongo/db/modules/eloq/src/eloq_tracing.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Document shapes used by the per-document benchmarks. The range argument of every benchmark
+ * below selects one of them:
+ *   0: a small "user profile" document (~120 bytes).
+ *   1: a medium "order" document with a nested address and a short array (~1KB).
+ *   2: a large "timeline" document with an array of embedded events (~16KB).
+ */
+enum DocShape { kSmall = 0, kMedium = 1, kLarge = 2 };
+
+BSONObj makeDocument(int64_t shape) {
+    BSONObjBuilder bob;
+    bob.append("_id", OID::gen());
+    bob.append("name", "eloq-benchmark-user");
+    bob.append("age", 42);
+    bob.append("email", "user@example.com");
+    if (shape == kSmall) {
+        return bob.obj();
+    }
+
+    {
+        BSONObjBuilder address(bob.subobjStart("address"));
+        address.append("street", "1 Infinite Loop");
+        address.append("city", "Cupertino");
+        address.append("zip", "95014");
+    }
+    {
+        BSONArrayBuilder tags(bob.subarrayStart("tags"));
+        for (int i = 0; i < 16; ++i) {
+            tags.append("tag-" + std::to_string(i));
+        }
+    }
+    {
+        BSONArrayBuilder items(bob.subarrayStart("items"));
+        for (int i = 0; i < 8; ++i) {
+            BSONObjBuilder item(items.subobjStart());
+            item.append("sku", "SKU-000000" + std::to_string(i));
+            item.append("qty", i + 1);
+            item.append("price", 9.99 * (i + 1));
+        }
+    }
+    if (shape == kMedium) {
+        return bob.obj();
+    }
+
+    {
+        BSONArrayBuilder events(bob.subarrayStart("events"));
+        for (int i = 0; i < 160; ++i) {
+            BSONObjBuilder event(events.subobjStart());
+            event.append("seq", static_cast<long long>(i));
+            event.appendDate("ts", Date_t::fromMillisSinceEpoch(1700000000000LL + i));
+            event.append("type", i % 2 ? "click" : "view");
+            event.append("payload", "lorem ipsum dolor sit amet consectetur adipiscing");
+        }
+    }
+    return bob.obj();
+}
+
+KeyString makeIdKeyString(const BSONObj& doc) {
+    return KeyString(KeyString::kLatestVersion, getIdBSONObjWithoutFieldName(doc), kIdOrdering);
+}
+
+void setDocShapeLabel(benchmark::State& state) {
+    static const char* const kLabels[] = {"small", "medium", "large"};
+    state.SetLabel(kLabels[state.range(0)]);
+}
+
+// KeyString -> MongoKey, done for every _id that is read or written.
+void BM_MongoKeyFromKeyString(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    const KeyString ks = makeIdKeyString(doc);
+
+    for (auto keepRunning : state) {
+        Eloq::MongoKey key(ks);
+        benchmark::DoNotOptimize(key.Data());
+    }
+    setDocShapeLabel(state);
+}
+
+// getIdBSONObjWithoutFieldName + KeyString::resetToKey + MongoKey, i.e. the full _id encoding
+// done by EloqRecordStore::_insertRecords.
+void BM_EncodeIdKey(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    KeyString ks(KeyString::kLatestVersion);
+
+    for (auto keepRunning : state) {
+        const BSONObj idObj = getIdBSONObjWithoutFieldName(doc);
+        ks.resetToKey(idObj, kIdOrdering);
+        auto key = std::make_unique<Eloq::MongoKey>(ks);
+        benchmark::DoNotOptimize(key.get());
+    }
+    setDocShapeLabel(state);
+}
+
+void BM_GetIdBSONObjWithoutFieldName(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+
+    for (auto keepRunning : state) {
+        BSONObj idObj = getIdBSONObjWithoutFieldName(doc);
+        benchmark::DoNotOptimize(idObj.objdata());
+    }
+    setDocShapeLabel(state);
+}
+
+void BM_MongoRecordSetEncodedBlob(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+
+    for (auto keepRunning : state) {
+        Eloq::MongoRecord record;
+        record.SetEncodedBlob(reinterpret_cast<const unsigned char*>(doc.objdata()),
+                              doc.objsize());
+        benchmark::DoNotOptimize(record.EncodedBlobData());
+    }
+    state.SetBytesProcessed(state.iterations() * doc.objsize());
+    setDocShapeLabel(state);
+}
+
+// The buffer is reused across iterations, as the log/checkpoint paths do.
+void BM_MongoRecordSerialize(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    Eloq::MongoRecord record;
+    record.SetEncodedBlob(reinterpret_cast<const unsigned char*>(doc.objdata()), doc.objsize());
+    std::vector<char> buf;
+    buf.reserve(record.SerializedLength());
+
+    for (auto keepRunning : state) {
+        size_t offset = 0;
+        record.Serialize(buf, offset);
+        benchmark::DoNotOptimize(buf.data());
+    }
+    state.SetBytesProcessed(state.iterations() * record.SerializedLength());
+    setDocShapeLabel(state);
+}
+
+void BM_MongoRecordDeserialize(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    Eloq::MongoRecord source;
+    source.SetEncodedBlob(reinterpret_cast<const unsigned char*>(doc.objdata()), doc.objsize());
+    std::vector<char> buf;
+    size_t length = 0;
+    source.Serialize(buf, length);
+
+    for (auto keepRunning : state) {
+        Eloq::MongoRecord record;
+        size_t offset = 0;
+        record.Deserialize(buf.data(), offset);
+        benchmark::DoNotOptimize(record.EncodedBlobData());
+    }
+    state.SetBytesProcessed(state.iterations() * length);
+    setDocShapeLabel(state);
+}
+
+// Mirrors EloqIndexCursor::_curr for a secondary index entry on {name: 1, age: -1}.
+void BM_IndexCursorCurrToBson(benchmark::State& state) {
+    const BSONObj keyPattern = BSON("name" << 1 << "age" << -1);
+    const Ordering ordering = Ordering::make(keyPattern);
+    const BSONObj doc = makeDocument(kSmall);
+    const KeyString idKs = makeIdKeyString(doc);
+    const RecordId id(idKs.getBuffer(), idKs.getSize());
+    const KeyString ks(KeyString::kLatestVersion,
+                       BSON("" << doc["name"].String() << "" << doc["age"].Int()),
+                       ordering,
+                       id);
+    const KeyString::TypeBits& typeBits = ks.getTypeBits();
+
+    for (auto keepRunning : state) {
+        BSONObj bson = KeyString::toBson(ks.getBuffer(), ks.getSize(), ordering, typeBits);
+        benchmark::DoNotOptimize(bson.objdata());
+    }
+}
+
+// Secondary key generation for {name: 1, age: -1}, as done by MongoSkEncoder::AppendPackedSk for
+// every record of an index build: through the general btree key generator, and through
+// TopLevelKeyGenerator with a reused key buffer.
+const BSONObj kSecondaryKeyPattern = BSON("name" << 1 << "age" << -1);
+
+void BM_SecondaryKeyGeneral(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    const Ordering ordering = Ordering::make(kSecondaryKeyPattern);
+    const KeyString idKs = makeIdKeyString(doc);
+    const RecordId id(idKs.getBuffer(), idKs.getSize());
+    const auto keyGen =
+        BtreeKeyGenerator::make(IndexDescriptor::IndexVersion::kV2,
+                                {"name", "age"},
+                                {BSONElement(), BSONElement()},
+                                false,
+                                nullptr);
+
+    for (auto keepRunning : state) {
+        BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        MultikeyPaths multikeyPaths;
+        keyGen->getKeys(doc, &keys, &multikeyPaths);
+        for (const BSONObj& key : keys) {
+            KeyString ks(KeyString::kLatestVersion, key, ordering, id);
+            benchmark::DoNotOptimize(ks.getBuffer());
+        }
+    }
+    setDocShapeLabel(state);
+}
+
+void BM_SecondaryKeyTopLevel(benchmark::State& state) {
+    const BSONObj doc = makeDocument(state.range(0));
+    const Ordering ordering = Ordering::make(kSecondaryKeyPattern);
+    const KeyString idKs = makeIdKeyString(doc);
+    const RecordId id(idKs.getBuffer(), idKs.getSize());
+    Eloq::TopLevelKeyGenerator keyGen(kSecondaryKeyPattern, false);
+    BufBuilder keyBuf;
+
+    for (auto keepRunning : state) {
+        if (keyGen.GetKey(doc, &keyBuf) == 1) {
+            KeyString ks(KeyString::kLatestVersion, BSONObj(keyBuf.buf()), ordering, id);
+            benchmark::DoNotOptimize(ks.getBuffer());
+        }
+    }
+    setDocShapeLabel(state);
+}
+
+// The success path runs once per storage call; the error path additionally formats the status.
+// The error report is only logged at verbosity 1 and above, so it is not part of the measurement.
+void BM_TxErrorCodeToMongoStatus(benchmark::State& state) {
+    const auto txErr = static_cast<txservice::TxErrorCode>(state.range(0));
+
+    for (auto keepRunning : state) {
+        Status status = TxErrorCodeToMongoStatus(txErr);
+        benchmark::DoNotOptimize(status.isOK());
+    }
+}
+
+void BM_TxErrorCodeToMongoStatusConflict(benchmark::State& state) {
+    for (auto keepRunning : state) {
+        try {
+            TxErrorCodeToMongoStatus(txservice::TxErrorCode::WRITE_WRITE_CONFLICT);
+        } catch (const WriteConflictException& ex) {
+            benchmark::DoNotOptimize(ex.code());
+        }
+    }
+}
+
+/**
+ * Tracing overhead on the hot path. The trace id is reloaded every iteration, as it is from the
+ * recovery unit, so an unsampled span should cost BM_TraceSpanBaseline plus one predicted branch.
+ */
+struct TracedOperation {
+    uint64_t traceId;
+};
+
+void BM_TraceSpanBaseline(benchmark::State& state) {
+    TracedOperation op{0};
+    TracedOperation* opPtr = &op;
+    benchmark::DoNotOptimize(opPtr);
+    for (auto keepRunning : state) {
+        benchmark::ClobberMemory();
+        benchmark::DoNotOptimize(opPtr->traceId);
+    }
+}
+
+void BM_TraceSpan(benchmark::State& state) {
+    TracedOperation op{static_cast<uint64_t>(state.range(0))};
+    TracedOperation* opPtr = &op;
+    benchmark::DoNotOptimize(opPtr);
+    for (auto keepRunning : state) {
+        benchmark::ClobberMemory();
+        EloqTraceSpan span(opPtr->traceId, EloqTracer::SpanKind::kGetKV, 1);
+    }
+}
+
+// Runs once per transaction open; with tracing disabled only the sample period is loaded.
+void BM_TraceSampleOperation(benchmark::State& state) {
+    auto& tracer = EloqTracer::get();
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(tracer.sampleOperation());
+    }
+}
+
+/**
+ * Cost of resolving a metric key on the MetricsRegistryImpl::Collect() path: the slot table it
+ * uses against a hash map behind a mutex, the cheapest race-free form of the previous lookup.
+ * Keys are spread out like the metric keys of collectors may be.
+ */
+constexpr size_t kNumMetrics = 1024;
+
+struct MetricSink {
+    int64_t value{0};
+};
+
+size_t metricKey(size_t i) {
+    return i * 7919 + 12345;
+}
+
+const Eloq::MetricsSlotTable<size_t, MetricSink>& metricsSlotTable() {
+    static const auto* table = [] {
+        auto* table = new Eloq::MetricsSlotTable<size_t, MetricSink>();
+        for (size_t i = 0; i < kNumMetrics; ++i) {
+            table->Add(metricKey(i), std::make_unique<MetricSink>());
+        }
+        return table;
+    }();
+    return *table;
+}
+
+void BM_MetricsCollectSlotTable(benchmark::State& state) {
+    const auto& table = metricsSlotTable();
+    size_t i = state.thread_index;
+    for (auto keepRunning : state) {
+        benchmark::DoNotOptimize(table.Find(metricKey(i)));
+        i = (i + 7) % kNumMetrics;
+    }
+}
+
+void BM_MetricsCollectLockedMap(benchmark::State& state) {
+    static std::mutex mutex;
+    static const auto* map = [] {
+        auto* map = new std::unordered_map<size_t, std::unique_ptr<MetricSink>>();
+        for (size_t i = 0; i < kNumMetrics; ++i) {
+            map->emplace(metricKey(i), std::make_unique<MetricSink>());
+        }
+        return map;
+    }();
+    size_t i = state.thread_index;
+    for (auto keepRunning : state) {
+        std::lock_guard<std::mutex> lk(mutex);
+        benchmark::DoNotOptimize(map->find(metricKey(i))->second.get());
+        i = (i + 7) % kNumMetrics;
+    }
+}
+
+BENCHMARK(BM_MongoKeyFromKeyString)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_EncodeIdKey)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_GetIdBSONObjWithoutFieldName)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_MongoRecordSetEncodedBlob)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_MongoRecordSerialize)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_MongoRecordDeserialize)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_IndexCursorCurrToBson);
+BENCHMARK(BM_SecondaryKeyGeneral)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_SecondaryKeyTopLevel)->DenseRange(kSmall, kLarge);
+BENCHMARK(BM_TxErrorCodeToMongoStatus)
+    ->ArgName("txErr")
+    ->Arg(static_cast<int>(txservice::TxErrorCode::NO_ERROR))
+    ->Arg(static_cast<int>(txservice::TxErrorCode::DUPLICATE_KEY));
+BENCHMARK(BM_TxErrorCodeToMongoStatusConflict);
+BENCHMARK(BM_TraceSpanBaseline);
+BENCHMARK(BM_TraceSpan)->ArgName("traceId")->Arg(0)->Arg(1);
+BENCHMARK(BM_TraceSampleOperation);
+BENCHMARK(BM_MetricsCollectSlotTable)->ThreadRange(1, 16);
+BENCHMARK(BM_MetricsCollectLockedMap)->ThreadRange(1, 16);
+
+}  // namespace
+}  // namespace mongo
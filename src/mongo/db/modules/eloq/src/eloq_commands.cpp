@@ -0,0 +1,259 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/storage/key_string.h"
+
+#include "mongo/db/modules/eloq/src/eloq_contention_manager.h"
+#include "mongo/db/modules/eloq/src/eloq_index_stats.h"
+#include "mongo/db/modules/eloq/src/eloq_tracing.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * { eloqContentionStats: 1, limit: <int>, reset: <bool> }
+ *
+ * Reports conflict and backoff totals and the most contended keys and tables. 'limit' bounds the
+ * number of keys and tables listed (default 20); 'reset' clears the statistics after reporting.
+ */
+class EloqContentionStatsCmd final : public BasicCommand {
+public:
+    EloqContentionStatsCmd() : BasicCommand("eloqContentionStats") {}
+
+    std::string help() const override {
+        return "conflict statistics and the most contended keys of the Eloq storage engine. "
+               "{eloqContentionStats: 1, limit: 20, reset: false}";
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::serverStatus);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& db,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        long long limit;
+        uassertStatusOK(bsonExtractIntegerFieldWithDefault(cmdObj, "limit", 20, &limit));
+        uassert(ErrorCodes::BadValue, "limit must be positive", limit > 0);
+        bool reset;
+        uassertStatusOK(bsonExtractBooleanFieldWithDefault(cmdObj, "reset", false, &reset));
+
+        auto& contention = EloqContentionManager::get();
+        contention.report(&result, static_cast<size_t>(limit));
+        if (reset) {
+            contention.reset();
+        }
+        return true;
+    }
+
+} eloqContentionStatsCmd;
+
+/**
+ * { eloqIndexStats: <collection>, refresh: <bool>, buckets: <bool> }
+ *
+ * Reports the key statistics the planner uses to estimate index scans on 'collection': the number
+ * of keys, whether the statistics cover the whole index and are still trusted, the writes since
+ * the last refresh, and with 'buckets' the hex encoded KeyString bounds of the histogram buckets.
+ * 'refresh' first resamples every index by scanning it.
+ */
+class EloqIndexStatsCmd final : public BasicCommand {
+public:
+    EloqIndexStatsCmd() : BasicCommand("eloqIndexStats") {}
+
+    std::string help() const override {
+        return "key histograms of the indexes of a collection on the Eloq storage engine. "
+               "{eloqIndexStats: 'coll', refresh: false, buckets: false}";
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::collStats);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& db,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(db, cmdObj));
+        bool refresh;
+        uassertStatusOK(bsonExtractBooleanFieldWithDefault(cmdObj, "refresh", false, &refresh));
+        bool buckets;
+        uassertStatusOK(bsonExtractBooleanFieldWithDefault(cmdObj, "buckets", false, &buckets));
+
+        AutoGetCollectionForReadCommand autoColl(opCtx, nss);
+        Collection* collection = autoColl.getCollection();
+        uassert(ErrorCodes::NamespaceNotFound,
+                str::stream() << "collection " << nss.ns() << " does not exist",
+                collection);
+
+        result.append("ns", nss.ns());
+        BSONObjBuilder indexes(result.subobjStart("indexes"));
+        auto it = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+        while (it.more()) {
+            const IndexDescriptor* desc = it.next();
+            auto stats = EloqIndexStatsRegistry::get().find(eloqIndexTableName(
+                nss.ns(), desc->indexName(), desc->keyPattern(), desc->unique()));
+            if (!stats) {
+                continue;
+            }
+            if (refresh) {
+                resample(opCtx, desc, it.accessMethod(desc), stats.get());
+            }
+            BSONObjBuilder index(indexes.subobjStart(desc->indexName()));
+            stats->report(&index, buckets);
+        }
+        return true;
+    }
+
+private:
+    static void resample(OperationContext* opCtx,
+                         const IndexDescriptor* desc,
+                         const IndexAccessMethod* iam,
+                         EloqIndexStats* stats) {
+        // Encode the keys as EloqIndex stores them: only standard indexes append the RecordId.
+        const Ordering ordering = Ordering::make(desc->keyPattern());
+        const bool appendRecordId = !desc->isIdIndex() && !desc->unique();
+        stats->refresh([&](auto&& observe) {
+            auto cursor = iam->newCursor(opCtx);
+            KeyString keyString(KeyString::kLatestVersion);
+            for (auto kv = cursor->seek(BSONObj(), true, SortedDataInterface::Cursor::kKeyAndLoc);
+                 kv;
+                 kv = cursor->next()) {
+                if (appendRecordId) {
+                    keyString.resetToKey(kv->key, ordering, kv->loc);
+                } else {
+                    keyString.resetToKey(kv->key, ordering);
+                }
+                observe(std::string_view{keyString.getBuffer(), keyString.getSize()});
+                opCtx->checkForInterrupt();
+            }
+        });
+    }
+
+} eloqIndexStatsCmd;
+
+/**
+ * { eloqTraceDump: 1, limit: <int>, clear: <bool> }
+ *
+ * Returns the most recent spans recorded by sampled operations, see eloqTraceSamplePeriod, as a
+ * Chrome trace JSON string in 'trace'. 'limit' bounds the number of spans (default 10000) so that
+ * the reply fits in a BSON document; 'clear' drops the returned and older spans from later dumps.
+ */
+class EloqTraceDumpCmd final : public BasicCommand {
+public:
+    static constexpr long long kMaxSpans = 50 * 1000;
+
+    EloqTraceDumpCmd() : BasicCommand("eloqTraceDump") {}
+
+    std::string help() const override {
+        return "recent sampled storage spans of the Eloq storage engine as Chrome trace JSON. "
+               "{eloqTraceDump: 1, limit: 10000, clear: false}";
+    }
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kAlways;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return false;
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::serverStatus);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& db,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        long long limit;
+        uassertStatusOK(bsonExtractIntegerFieldWithDefault(cmdObj, "limit", 10000, &limit));
+        uassert(ErrorCodes::BadValue,
+                str::stream() << "limit must be between 1 and " << kMaxSpans,
+                limit > 0 && limit <= kMaxSpans);
+        bool clear;
+        uassertStatusOK(bsonExtractBooleanFieldWithDefault(cmdObj, "clear", false, &clear));
+
+        auto& tracer = EloqTracer::get();
+        const auto spans = tracer.collect(static_cast<size_t>(limit));
+        if (clear) {
+            tracer.clear();
+        }
+        result.append("spans", static_cast<long long>(spans.size()));
+        result.append("trace", tracer.toChromeTraceJson(spans));
+        return true;
+    }
+
+} eloqTraceDumpCmd;
+
+}  // namespace
+}  // namespace mongo
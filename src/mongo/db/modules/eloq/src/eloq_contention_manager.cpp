@@ -0,0 +1,320 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/client.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/log.h"
+
+#include "mongo/db/modules/eloq/src/eloq_contention_manager.h"
+
+#include <bvar/reducer.h>
+
+namespace recorder {
+bvar::Adder<int64_t> kConflictBackoffCounter("mongo_conflict_backoff_total");
+bvar::Adder<int64_t> kHotKeyQueuedCounter("mongo_hot_key_queued_total");
+
+}  // namespace recorder
+
+namespace mongo {
+
+extern thread_local int16_t localThreadId;
+
+// Base and cap of the jittered exponential backoff between retries of a conflicting read.
+MONGO_EXPORT_SERVER_PARAMETER(eloqConflictBackoffBaseMicros, int, 50);
+MONGO_EXPORT_SERVER_PARAMETER(eloqConflictBackoffMaxMicros, int, 10 * 1000);
+
+// Decayed conflict score at which a key is considered hot. The score gains 1 per conflict and
+// halves every 10 seconds.
+MONGO_EXPORT_SERVER_PARAMETER(eloqHotKeyConflictThreshold, int, 16);
+
+// When enabled, writers to a hot key wait in FIFO order for exclusive access to it, for at most
+// eloqHotKeyQueueMaxWaitMillis, instead of all retrying against each other.
+MONGO_EXPORT_SERVER_PARAMETER(eloqQueueHotKeyWriters, bool, false);
+MONGO_EXPORT_SERVER_PARAMETER(eloqHotKeyQueueMaxWaitMillis, int, 100);
+
+namespace {
+
+constexpr double kScoreHalfLifeMillis = 10 * 1000;
+
+double decayedScore(const double score, const Date_t lastConflict, const Date_t now) {
+    const auto elapsed = static_cast<double>(durationCount<Milliseconds>(now - lastConflict));
+    if (elapsed <= 0) {
+        return score;
+    }
+    return score * std::exp2(-elapsed / kScoreHalfLifeMillis);
+}
+
+PseudoRandom& threadLocalRandom() {
+    thread_local PseudoRandom random(SecureRandom::create()->nextInt64());
+    return random;
+}
+
+/**
+ * Gives up the CPU until 'deadline'. On a thread group, the current coroutine is re-enqueued so
+ * that the other coroutines of the group keep running while this one waits.
+ */
+void pauseUntil(const std::chrono::steady_clock::time_point deadline) {
+    const CoroutineFunctors* coro = nullptr;
+    if (localThreadId != -1) {
+        if (Client* client = Client::getCurrent()) {
+            if (client->coroutineFunctors() != CoroutineFunctors::Unavailable) {
+                coro = &client->coroutineFunctors();
+            }
+        }
+    }
+
+    if (coro) {
+        while (std::chrono::steady_clock::now() < deadline) {
+            (*coro->longResumeFuncPtr)();
+            (*coro->yieldFuncPtr)();
+        }
+    } else {
+        std::this_thread::sleep_until(deadline);
+    }
+}
+
+}  // namespace
+
+EloqContentionManager::KeyRef::KeyRef(const txservice::TableName& tableName,
+                                      const Eloq::MongoKey& key)
+    : table(tableName.StringView()), packedKey(key.Data(), key.Size()) {
+    hash = std::hash<std::string_view>{}(table) * 31 + key.Hash();
+}
+
+EloqContentionManager::HotKeySlot::~HotKeySlot() {
+    EloqContentionManager::get()._releaseHotKeySlot(_key);
+}
+
+EloqContentionManager& EloqContentionManager::get() {
+    static EloqContentionManager manager;
+    return manager;
+}
+
+void EloqContentionManager::recordKeyConflict(const KeyRef& key) {
+    _keyConflicts.fetch_add(1, std::memory_order_relaxed);
+    const Date_t now = Date_t::now();
+    {
+        Shard& shard = _shard(key);
+        std::lock_guard<coro::Mutex> lk(shard.mutex);
+        auto iter = shard.keys.find(key);
+        if (iter == shard.keys.end()) {
+            if (shard.keys.size() >= kMaxKeysPerShard) {
+                auto coldest = std::min_element(
+                    shard.keys.begin(), shard.keys.end(), [now](const auto& lhs, const auto& rhs) {
+                        return decayedScore(lhs.second.score, lhs.second.lastConflict, now) <
+                            decayedScore(rhs.second.score, rhs.second.lastConflict, now);
+                    });
+                shard.keys.erase(coldest);
+            }
+            iter = shard.keys.try_emplace(key).first;
+        }
+
+        KeyStats& stats = iter->second;
+        stats.score = decayedScore(stats.score, stats.lastConflict, now) + 1;
+        stats.lastConflict = now;
+        ++stats.conflicts;
+    }
+
+    std::lock_guard<std::mutex> lk(_tablesMutex);
+    ++_tableConflicts[key.table];
+}
+
+void EloqContentionManager::recordTableConflict(const txservice::TableName& tableName) {
+    std::lock_guard<std::mutex> lk(_tablesMutex);
+    ++_tableConflicts[std::string(tableName.StringView())];
+}
+
+void EloqContentionManager::recordCommitConflict() {
+    _commitConflicts.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool EloqContentionManager::isHot(const KeyRef& key) {
+    Shard& shard = _shard(key);
+    std::lock_guard<coro::Mutex> lk(shard.mutex);
+    auto iter = shard.keys.find(key);
+    if (iter == shard.keys.end()) {
+        return false;
+    }
+    const KeyStats& stats = iter->second;
+    return decayedScore(stats.score, stats.lastConflict, Date_t::now()) >=
+        eloqHotKeyConflictThreshold.load();
+}
+
+void EloqContentionManager::backoff(int attempt, const KeyRef& key) {
+    const int64_t base = std::max(eloqConflictBackoffBaseMicros.load(), 0);
+    const int64_t cap = std::max<int64_t>(eloqConflictBackoffMaxMicros.load(), base);
+    const int64_t ceiling = std::min(cap, base << std::min(attempt, 20));
+    const int64_t floor = isHot(key) ? std::min(base, ceiling) : 0;
+    const int64_t delay = floor + threadLocalRandom().nextInt64(ceiling - floor + 1);
+
+    _backoffs.fetch_add(1, std::memory_order_relaxed);
+    _backoffMicros.fetch_add(delay, std::memory_order_relaxed);
+    recorder::kConflictBackoffCounter << 1;
+    MONGO_LOG(1) << "EloqContentionManager::backoff. attempt: " << attempt
+                 << ", delay: " << delay << "us";
+    if (delay > 0) {
+        pauseUntil(std::chrono::steady_clock::now() + std::chrono::microseconds(delay));
+    }
+}
+
+std::unique_ptr<EloqContentionManager::HotKeySlot> EloqContentionManager::acquireHotKeySlot(
+    const KeyRef& key) {
+    if (!eloqQueueHotKeyWriters.load() || !isHot(key)) {
+        return nullptr;
+    }
+
+    Shard& shard = _shard(key);
+    // Set by the releasing writer. Only accessed under the shard mutex.
+    bool handedOver = false;
+    std::unique_lock<coro::Mutex> lk(shard.mutex);
+    KeyQueue& queue = shard.queues[key];
+    if (!queue.owned) {
+        queue.owned = true;
+        return std::unique_ptr<HotKeySlot>(new HotKeySlot(key));
+    }
+    queue.waiters.push_back(&handedOver);
+
+    _queuedWriters.fetch_add(1, std::memory_order_relaxed);
+    recorder::kHotKeyQueuedCounter << 1;
+    MONGO_LOG(1) << "EloqContentionManager::acquireHotKeySlot. queued on table: " << key.table
+                 << ", key: " << Eloq::MongoKey(key.packedKey).ToString();
+
+    const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::milliseconds(std::max(eloqHotKeyQueueMaxWaitMillis.load(), 0));
+    if (shard.handedOver.wait_until(lk, deadline, [&] { return handedOver; })) {
+        return std::unique_ptr<HotKeySlot>(new HotKeySlot(key));
+    }
+
+    // Timed out: leave the queue and proceed without exclusive access. 'queue' may have moved
+    // while the mutex was released, but it still exists since this writer is waiting in it.
+    auto& waiters = shard.queues.find(key)->second.waiters;
+    waiters.erase(std::find(waiters.begin(), waiters.end(), &handedOver));
+    _queueTimeouts.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+void EloqContentionManager::_releaseHotKeySlot(const KeyRef& key) {
+    Shard& shard = _shard(key);
+    std::lock_guard<coro::Mutex> lk(shard.mutex);
+    auto iter = shard.queues.find(key);
+    invariant(iter != shard.queues.end() && iter->second.owned);
+    KeyQueue& queue = iter->second;
+    if (queue.waiters.empty()) {
+        shard.queues.erase(iter);
+        return;
+    }
+    // Ownership passes straight to the oldest waiter; the queue stays owned.
+    *queue.waiters.front() = true;
+    queue.waiters.pop_front();
+    shard.handedOver.notify_all();
+}
+
+void EloqContentionManager::report(BSONObjBuilder* builder, size_t limit) {
+    builder->appendNumber("keyConflicts",
+                          static_cast<long long>(_keyConflicts.load(std::memory_order_relaxed)));
+    builder->appendNumber("commitConflicts",
+                          static_cast<long long>(_commitConflicts.load(std::memory_order_relaxed)));
+    builder->appendNumber("backoffs",
+                          static_cast<long long>(_backoffs.load(std::memory_order_relaxed)));
+    builder->appendNumber("backoffMicros",
+                          static_cast<long long>(_backoffMicros.load(std::memory_order_relaxed)));
+    builder->appendNumber("queuedWriters",
+                          static_cast<long long>(_queuedWriters.load(std::memory_order_relaxed)));
+    builder->appendNumber("queueTimeouts",
+                          static_cast<long long>(_queueTimeouts.load(std::memory_order_relaxed)));
+
+    struct HotKey {
+        double score;
+        KeyRef key;
+        KeyStats stats;
+    };
+    std::vector<HotKey> hotKeys;
+    const Date_t now = Date_t::now();
+    for (Shard& shard : _shards) {
+        std::lock_guard<coro::Mutex> lk(shard.mutex);
+        for (const auto& [key, stats] : shard.keys) {
+            hotKeys.push_back({decayedScore(stats.score, stats.lastConflict, now), key, stats});
+        }
+    }
+    const size_t numKeys = std::min(limit, hotKeys.size());
+    std::partial_sort(hotKeys.begin(),
+                      hotKeys.begin() + numKeys,
+                      hotKeys.end(),
+                      [](const HotKey& lhs, const HotKey& rhs) { return lhs.score > rhs.score; });
+
+    const int threshold = eloqHotKeyConflictThreshold.load();
+    BSONArrayBuilder keysBuilder(builder->subarrayStart("topKeys"));
+    for (size_t i = 0; i < numKeys; ++i) {
+        const HotKey& hotKey = hotKeys[i];
+        BSONObjBuilder keyBuilder(keysBuilder.subobjStart());
+        keyBuilder.append("table", hotKey.key.table);
+        keyBuilder.append("key", Eloq::MongoKey(hotKey.key.packedKey).ToString());
+        keyBuilder.appendNumber("conflicts", static_cast<long long>(hotKey.stats.conflicts));
+        keyBuilder.append("score", hotKey.score);
+        keyBuilder.append("hot", hotKey.score >= threshold);
+        keyBuilder.appendDate("lastConflict", hotKey.stats.lastConflict);
+    }
+    keysBuilder.doneFast();
+
+    std::vector<std::pair<std::string, uint64_t>> tables;
+    {
+        std::lock_guard<std::mutex> lk(_tablesMutex);
+        tables.assign(_tableConflicts.begin(), _tableConflicts.end());
+    }
+    const size_t numTables = std::min(limit, tables.size());
+    std::partial_sort(tables.begin(),
+                      tables.begin() + numTables,
+                      tables.end(),
+                      [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+
+    BSONArrayBuilder tablesBuilder(builder->subarrayStart("topTables"));
+    for (size_t i = 0; i < numTables; ++i) {
+        tablesBuilder.append(BSON("table" << tables[i].first << "conflicts"
+                                          << static_cast<long long>(tables[i].second)));
+    }
+    tablesBuilder.doneFast();
+}
+
+void EloqContentionManager::reset() {
+    for (Shard& shard : _shards) {
+        std::lock_guard<coro::Mutex> lk(shard.mutex);
+        shard.keys.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lk(_tablesMutex);
+        _tableConflicts.clear();
+    }
+    _keyConflicts.store(0);
+    _commitConflicts.store(0);
+    _backoffs.store(0);
+    _backoffMicros.store(0);
+    _queuedWriters.store(0);
+    _queueTimeouts.store(0);
+}
+
+}  // namespace mongo
@@ -0,0 +1,177 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include "absl/container/flat_hash_map.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/coro_sync.h"
+#include "mongo/util/time_support.h"
+
+#include "mongo/db/modules/eloq/src/base/eloq_key.h"
+
+#include "mongo/db/modules/eloq/tx_service/include/type.h"
+
+namespace mongo {
+
+/**
+ * Tracks read/write conflicts per (table, key) and per table, and turns the blind retry loops of
+ * EloqRecoveryUnit into jittered exponential backoff. Keys whose decayed conflict score exceeds
+ * eloqHotKeyConflictThreshold are "hot": retries on them back off longer, and when
+ * eloqQueueHotKeyWriters is enabled, writers to a hot key are handed the key one at a time in
+ * FIFO order instead of all racing for it.
+ *
+ * All state is process-wide and bounded: per-key stats live in kNumShards shards of at most
+ * kMaxKeysPerShard entries each, the coldest entry being evicted when a shard is full.
+ */
+class EloqContentionManager {
+public:
+    static constexpr size_t kNumShards = 32;
+    static constexpr size_t kMaxKeysPerShard = 128;
+
+    /**
+     * Identifies a key a transaction intends to write. Copies the key bytes so that a conflict
+     * reported at commit time can still be attributed after the cursor that read the key is gone.
+     */
+    struct KeyRef {
+        KeyRef(const txservice::TableName& tableName, const Eloq::MongoKey& key);
+
+        friend bool operator==(const KeyRef& lhs, const KeyRef& rhs) {
+            return lhs.hash == rhs.hash && lhs.packedKey == rhs.packedKey &&
+                lhs.table == rhs.table;
+        }
+
+        struct Hash {
+            size_t operator()(const KeyRef& key) const {
+                return key.hash;
+            }
+        };
+
+        std::string table;
+        std::string packedKey;
+        uint64_t hash;
+    };
+
+    /**
+     * Exclusive, FIFO-ordered right to write a hot key. Destroying the slot hands the key to the
+     * next queued writer, if any.
+     */
+    class HotKeySlot {
+    public:
+        HotKeySlot(const HotKeySlot&) = delete;
+        HotKeySlot& operator=(const HotKeySlot&) = delete;
+        ~HotKeySlot();
+
+    private:
+        friend class EloqContentionManager;
+        explicit HotKeySlot(const KeyRef& key) : _key(key) {}
+
+        const KeyRef _key;
+    };
+
+    static EloqContentionManager& get();
+
+    /**
+     * Records a conflict on 'key'. Also counts towards the conflicts of its table.
+     */
+    void recordKeyConflict(const KeyRef& key);
+
+    /**
+     * Records a conflict that could not be attributed to a single key, e.g. a batch read.
+     */
+    void recordTableConflict(const txservice::TableName& tableName);
+
+    /**
+     * Records a transaction that failed to commit because of a conflict.
+     */
+    void recordCommitConflict();
+
+    bool isHot(const KeyRef& key);
+
+    /**
+     * Sleeps before retry number 'attempt' (0-based) of an operation on 'key'. The delay is drawn
+     * uniformly from [0, min(max, base * 2^attempt)], with the lower bound raised to 'base' for
+     * hot keys. Yields the coroutine instead of blocking when running on a thread group.
+     */
+    void backoff(int attempt, const KeyRef& key);
+
+    /**
+     * Waits, in FIFO order with other writers, for exclusive access to the hot key 'key'. Returns
+     * nullptr if the key is not hot, queueing is disabled, or the wait timed out; the caller then
+     * proceeds unqueued.
+     */
+    std::unique_ptr<HotKeySlot> acquireHotKeySlot(const KeyRef& key);
+
+    /**
+     * Appends the totals and the 'limit' most contended keys and tables to 'builder'.
+     */
+    void report(BSONObjBuilder* builder, size_t limit);
+
+    void reset();
+
+private:
+    struct KeyStats {
+        uint64_t conflicts{0};
+        double score{0};
+        Date_t lastConflict;
+    };
+
+    struct KeyQueue {
+        bool owned{false};
+        // Flags of the writers waiting for the key, oldest first. The releasing writer hands the
+        // key to the oldest one by setting its flag.
+        std::deque<bool*> waiters;
+    };
+
+    struct Shard {
+        coro::Mutex mutex;
+        absl::flat_hash_map<KeyRef, KeyStats, KeyRef::Hash> keys;
+        absl::flat_hash_map<KeyRef, KeyQueue, KeyRef::Hash> queues;
+        // Notified whenever a key of this shard is handed to a waiting writer.
+        coro::ConditionVariable handedOver;
+    };
+
+    Shard& _shard(const KeyRef& key) {
+        return _shards[key.hash % kNumShards];
+    }
+
+    void _releaseHotKeySlot(const KeyRef& key);
+
+    std::array<Shard, kNumShards> _shards;
+
+    std::mutex _tablesMutex;
+    absl::flat_hash_map<std::string, uint64_t> _tableConflicts;
+
+    std::atomic<uint64_t> _keyConflicts{0};
+    std::atomic<uint64_t> _commitConflicts{0};
+    std::atomic<uint64_t> _backoffs{0};
+    std::atomic<uint64_t> _backoffMicros{0};
+    std::atomic<uint64_t> _queuedWriters{0};
+    std::atomic<uint64_t> _queueTimeouts{0};
+};
+
+}  // namespace mongo
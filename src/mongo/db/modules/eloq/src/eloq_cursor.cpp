@@ -180,6 +180,7 @@ txservice::TxErrorCode EloqCursor::_fetchBatchTuples() {
                  << ", isForWrite: " << _scanOpenTxReq.is_for_write_;
     _scanBatchIdx = 0;
     _scanBatchVector.clear();
+    EloqTraceSpan span(_ru->traceId(), EloqTracer::SpanKind::kScanBatch);
     const CoroutineFunctors& coro = Client::getCurrent()->coroutineFunctors();
     txservice::ScanBatchTxRequest scanBatchTxReq(_scanAlias,
                                                  *_scanOpenTxReq.tab_name_,
@@ -205,6 +206,7 @@ txservice::TxErrorCode EloqCursor::_fetchBatchTuples() {
                      << ", tuples: " << _scanBatchVector.size();
         _isLastScanBatch = scanBatchTxReq.Result();
         ++_scanBatchCnt;
+        span.setArg(_scanBatchVector.size());
     }
 
     return scanBatchTxReq.ErrorCode();
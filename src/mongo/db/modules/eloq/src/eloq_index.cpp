@@ -509,7 +509,8 @@ EloqIndex::EloqIndex(OperationContext* ctx,
       _indexName{std::move(indexName)},
       _ordering{Ordering::make(desc->keyPattern())},
       _desc{desc},
-      _keyPattern{desc->keyPattern()} {
+      _keyPattern{desc->keyPattern()},
+      _stats{EloqIndexStatsRegistry::get().getOrCreate(_indexName.StringView())} {
     MONGO_LOG(1) << "EloqIndex::EloqIndex"
                  << ". tableName: " << _tableName.StringView()
                  << ", indexName: " << _indexName.StringView();
@@ -558,6 +559,30 @@ Status EloqIndex::initAsEmpty(OperationContext* opCtx) {
     return Status::OK();
 }
 
+void EloqIndex::_recordInsertOnCommit(OperationContext* opCtx, const KeyString& keyString) const {
+    if (!_stats->complete() || !EloqIndexStats::countsWrite()) {
+        return;
+    }
+    opCtx->recoveryUnit()->onCommit(
+        [stats = _stats, key = std::string{keyString.getBuffer(), keyString.getSize()}](
+            boost::optional<Timestamp>) { stats->recordInsert(key); });
+}
+
+void EloqIndex::_recordDeleteOnCommit(OperationContext* opCtx, const KeyString& keyString) const {
+    if (!_stats->complete()) {
+        return;
+    }
+    std::string_view key{keyString.getBuffer(), keyString.getSize()};
+    const bool counted = EloqIndexStats::countsWrite();
+    if (!counted && !_stats->mayBeSampled(key)) {
+        return;
+    }
+    opCtx->recoveryUnit()->onCommit(
+        [stats = _stats, key = std::string{key}, counted](boost::optional<Timestamp>) {
+            stats->recordDelete(key, counted);
+        });
+}
+
 // EloqIdIndex
 std::unique_ptr<SortedDataInterface::Cursor> EloqIdIndex::newCursor(OperationContext* opCtx,
                                                                     bool isForward) const {
@@ -592,6 +617,10 @@ Status EloqIdIndex::insert(OperationContext* opCtx,
     if (!s.isOK()) {
         return s;
     }
+    // Only build the KeyString, which the _id index does not write, for complete statistics.
+    if (_stats->complete()) {
+        _recordInsertOnCommit(opCtx, KeyString{keyStringVersion(), key, _ordering});
+    }
     return Status::OK();
     MONGO_UNREACHABLE;
     // IdIndex refers to the same table in TxService as its corresponding RecordStore.
@@ -606,6 +635,9 @@ void EloqIdIndex::unindex(OperationContext* opCtx,
     MONGO_LOG(1) << "key: " << key << ". recordid: " << id;
     assert(!dupsAllowed);
 
+    if (_stats->complete()) {
+        _recordDeleteOnCommit(opCtx, KeyString{keyStringVersion(), key, _ordering});
+    }
     return;
     // do delete in EloqRecordStore::deleteRecord
 
@@ -673,6 +705,9 @@ Status EloqUniqueIndex::insert(OperationContext* opCtx,
                     std::move(mongoRecord),
                     txservice::OperationType::Insert,
                     true);
+    if (err == txservice::TxErrorCode::NO_ERROR) {
+        _recordInsertOnCommit(opCtx, keyString);
+    }
 
     return TxErrorCodeToMongoStatus(err);
 }
@@ -719,6 +754,7 @@ void EloqUniqueIndex::unindex(OperationContext* opCtx,
                                            txservice::OperationType::Delete,
                                            false);
     uassertStatusOK(TxErrorCodeToMongoStatus(err));
+    _recordDeleteOnCommit(opCtx, keyString);
 }
 
 std::unique_ptr<SortedDataInterface::Cursor> EloqStandardIndex::newCursor(OperationContext* opCtx,
@@ -772,6 +808,9 @@ Status EloqStandardIndex::insert(OperationContext* opCtx,
                                            std::move(mongoRecord),
                                            txservice::OperationType::Insert,
                                            false);
+    if (err == txservice::TxErrorCode::NO_ERROR) {
+        _recordInsertOnCommit(opCtx, keyString);
+    }
     return TxErrorCodeToMongoStatus(err);
 }
 
@@ -795,6 +834,7 @@ void EloqStandardIndex::unindex(OperationContext* opCtx,
                                            txservice::OperationType::Delete,
                                            false);
     uassertStatusOK(TxErrorCodeToMongoStatus(err));
+    _recordDeleteOnCommit(opCtx, keyString);
 }
 
 }  // namespace mongo
@@ -17,12 +17,15 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 
+#include "mongo/db/modules/eloq/src/eloq_index_stats.h"
+
 #include "mongo/db/modules/eloq/tx_service/include/type.h"
 
 namespace mongo {
@@ -90,6 +93,14 @@ protected:
     const IndexDescriptor* _desc;
     const BSONObj _keyPattern;
     const BSONObj _collation;
+
+    // Key sample and count feeding EloqCardinalityEstimator.
+    const std::shared_ptr<EloqIndexStats> _stats;
+
+    // Record the insert or delete of 'keyString' in _stats once the unit of work commits, if
+    // _stats are complete and the write is counted or may drop a sampled key.
+    void _recordInsertOnCommit(OperationContext* opCtx, const KeyString& keyString) const;
+    void _recordDeleteOnCommit(OperationContext* opCtx, const KeyString& keyString) const;
 };
 
 class EloqIdIndex final : public EloqIndex {
@@ -0,0 +1,358 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/log.h"
+
+#include "mongo/db/modules/eloq/src/base/eloq_key.h"
+#include "mongo/db/modules/eloq/src/base/eloq_util.h"
+#include "mongo/db/modules/eloq/src/eloq_index_stats.h"
+
+namespace mongo {
+
+namespace {
+
+// Bounds with more ranges than this, e.g. large $in lists, are not estimated.
+constexpr size_t kMaxEstimatedRanges = 256;
+
+PseudoRandom& threadLocalRandom() {
+    thread_local PseudoRandom random(SecureRandom::create()->nextInt64());
+    return random;
+}
+
+std::string encodeBound(const BSONObj& key, Ordering ordering, KeyString::Discriminator side) {
+    KeyString ks{KeyString::kLatestVersion, key, ordering, side};
+    return std::string{ks.getBuffer(), ks.getSize()};
+}
+
+/**
+ * Returns the fraction of keys between 'start' and 'end'. Bounds are oriented in scan order, so for
+ * a reverse scan 'start' is the upper end of the range.
+ */
+double fractionBetween(const EloqKeyHistogram& histogram,
+                       BSONObj start,
+                       bool startInclusive,
+                       BSONObj end,
+                       bool endInclusive,
+                       Ordering ordering) {
+    std::string startBefore = encodeBound(start, ordering, KeyString::kExclusiveBefore);
+    std::string endBefore = encodeBound(end, ordering, KeyString::kExclusiveBefore);
+    if (endBefore < startBefore) {
+        std::swap(start, end);
+        std::swap(startInclusive, endInclusive);
+        std::swap(startBefore, endBefore);
+    }
+
+    std::string lo = startInclusive ? std::move(startBefore)
+                                    : encodeBound(start, ordering, KeyString::kExclusiveAfter);
+    std::string hi = endInclusive ? encodeBound(end, ordering, KeyString::kExclusiveAfter)
+                                  : std::move(endBefore);
+    return histogram.fractionInRange(lo, hi);
+}
+
+BSONObj keyPrefix(const std::vector<BSONElement>& elems) {
+    BSONObjBuilder builder;
+    for (const auto& elem : elems) {
+        builder.appendAs(elem, "");
+    }
+    return builder.obj();
+}
+
+/**
+ * Adds to 'fraction' the share of keys within 'bounds', expanding the point intervals of leading
+ * fields into key prefixes. The intervals of the first field that is not all points end the
+ * prefix; any later fields are treated as unbounded. Returns false if there are too many ranges.
+ */
+bool addFractionInBounds(const EloqKeyHistogram& histogram,
+                         const IndexBounds& bounds,
+                         Ordering ordering,
+                         size_t field,
+                         std::vector<BSONElement>* prefix,
+                         size_t* numRanges,
+                         double* fraction) {
+    if (field == bounds.fields.size()) {
+        if (++*numRanges > kMaxEstimatedRanges) {
+            return false;
+        }
+        BSONObj key = keyPrefix(*prefix);
+        *fraction += fractionBetween(histogram, key, true, key, true, ordering);
+        return true;
+    }
+
+    const auto& intervals = bounds.fields[field].intervals;
+    bool allPoints = std::all_of(
+        intervals.begin(), intervals.end(), [](const Interval& i) { return i.isPoint(); });
+    for (const Interval& interval : intervals) {
+        prefix->push_back(interval.start);
+        if (allPoints) {
+            if (!addFractionInBounds(
+                    histogram, bounds, ordering, field + 1, prefix, numRanges, fraction)) {
+                return false;
+            }
+            prefix->pop_back();
+            continue;
+        }
+
+        if (++*numRanges > kMaxEstimatedRanges) {
+            return false;
+        }
+        BSONObj start = keyPrefix(*prefix);
+        prefix->back() = interval.end;
+        BSONObj end = keyPrefix(*prefix);
+        prefix->pop_back();
+        *fraction += fractionBetween(
+            histogram, start, interval.startInclusive, end, interval.endInclusive, ordering);
+    }
+    return true;
+}
+
+}  // namespace
+
+EloqKeyHistogram::EloqKeyHistogram(const std::vector<std::string>& sortedSample) {
+    invariant(!sortedSample.empty());
+    size_t numBuckets = std::min(kMaxBuckets, sortedSample.size());
+    _bounds.reserve(numBuckets + 1);
+    for (size_t i = 0; i <= numBuckets; ++i) {
+        _bounds.push_back(sortedSample[i * (sortedSample.size() - 1) / numBuckets]);
+    }
+}
+
+double EloqKeyHistogram::_fractionBelow(std::string_view key) const {
+    if (key <= _bounds.front()) {
+        return 0;
+    }
+    if (key >= _bounds.back()) {
+        return 1;
+    }
+
+    auto upper = std::upper_bound(_bounds.begin(), _bounds.end(), key);
+    size_t bucket = upper - _bounds.begin() - 1;
+    double pos = Eloq::MongoKey::InterpolatePackedKey(key, _bounds[bucket], *upper);
+    return (bucket + pos) / numBuckets();
+}
+
+double EloqKeyHistogram::fractionInRange(std::string_view lo, std::string_view hi) const {
+    if (hi < lo) {
+        return 0;
+    }
+    if (_bounds.front() == _bounds.back()) {
+        // A single distinct key.
+        return lo <= _bounds.front() && _bounds.front() <= hi ? 1 : 0;
+    }
+    return std::max(_fractionBelow(hi) - _fractionBelow(lo), 0.0);
+}
+
+std::optional<size_t> EloqIndexStats::_pickSampleSlot(uint64_t weight) {
+    // Reservoir sampling: the n-th key replaces a random one of the kSampleSize sampled keys with
+    // probability kSampleSize / n, and a key standing for 'weight' keys with 'weight' times that.
+    uint64_t seen = _insertsSeen.fetch_add(weight, std::memory_order_relaxed);
+    if (seen < kSampleSize) {
+        return seen;
+    }
+    uint64_t draw = static_cast<uint64_t>(threadLocalRandom().nextInt64()) % (seen + weight);
+    if (draw < kSampleSize * weight) {
+        return draw % kSampleSize;
+    }
+    return std::nullopt;
+}
+
+void EloqIndexStats::_storeSample(size_t slot, std::string_view key) {
+    std::lock_guard<std::mutex> lk(_mutex);
+    if (slot >= _sample.size()) {
+        _sample.resize(slot + 1);
+    }
+    auto [it, inserted] = _sampleSlots.try_emplace(std::string{key}, slot);
+    if (!inserted) {
+        // A refresh scan saw the key of an insert which is counted as well.
+        return;
+    }
+    auto& sampled = _sample[slot];
+    if (!sampled.empty()) {
+        _sampleSlots.erase(sampled);
+    }
+    sampled.assign(key.data(), key.size());
+    ++_sampleChanges;
+
+    size_t bit = _filterBit(key);
+    _sampledKeyFilter[bit / 64].fetch_or(uint64_t{1} << (bit % 64), std::memory_order_relaxed);
+}
+
+void EloqIndexStats::_removeSample(std::string_view key) {
+    std::lock_guard<std::mutex> lk(_mutex);
+    auto it = _sampleSlots.find(absl::string_view{key.data(), key.size()});
+    if (it == _sampleSlots.end()) {
+        return;
+    }
+    // The emptied slot is skipped by histogram() until a later insert is picked for it.
+    _sample[it->second].clear();
+    _sampleSlots.erase(it);
+    ++_sampleChanges;
+}
+
+void EloqIndexStats::_reset() {
+    _complete.store(false);
+    std::lock_guard<std::mutex> lk(_mutex);
+    _sample.clear();
+    _sampleSlots.clear();
+    for (auto& word : _sampledKeyFilter) {
+        word.store(0, std::memory_order_relaxed);
+    }
+    _sampleChanges = 0;
+    _histogram.reset();
+    _insertsSeen.store(0);
+    _numKeys.store(0);
+}
+
+std::shared_ptr<const EloqKeyHistogram> EloqIndexStats::histogram() {
+    std::vector<std::string> sample;
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (_histogram && _sampleChanges <= _sample.size() / 8) {
+            return _histogram;
+        }
+        sample.reserve(_sample.size());
+        for (const auto& key : _sample) {
+            // Slots claimed by inserts that raced with a refresh may still be empty.
+            if (!key.empty()) {
+                sample.push_back(key);
+            }
+        }
+        _sampleChanges = 0;
+    }
+    if (sample.empty()) {
+        return nullptr;
+    }
+
+    // Sort outside of the mutex so that inserts picked for the sample do not wait on it.
+    std::sort(sample.begin(), sample.end());
+    auto histogram = std::make_shared<const EloqKeyHistogram>(sample);
+
+    std::lock_guard<std::mutex> lk(_mutex);
+    _histogram = histogram;
+    return histogram;
+}
+
+void EloqIndexStats::report(BSONObjBuilder* builder, bool withBuckets) {
+    builder->append("complete", complete());
+    builder->append("trusted", trusted());
+    builder->append("numKeys", numKeys());
+    builder->append("changesSinceRefresh",
+                    _changesSinceRefresh.load(std::memory_order_relaxed));
+    builder->append("insertsSeen", static_cast<long long>(_insertsSeen.load()));
+    auto hist = histogram();
+    builder->append("numBuckets", static_cast<int>(hist ? hist->numBuckets() : 0));
+    if (hist && withBuckets) {
+        BSONArrayBuilder bounds(builder->subarrayStart("bucketBounds"));
+        for (const auto& bound : hist->bounds()) {
+            bounds.append(toHexLower(bound.data(), static_cast<int>(bound.size())));
+        }
+    }
+}
+
+EloqIndexStatsRegistry& EloqIndexStatsRegistry::get() {
+    static EloqIndexStatsRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<EloqIndexStats> EloqIndexStatsRegistry::getOrCreate(
+    std::string_view indexTableName) {
+    std::lock_guard<std::mutex> lk(_mutex);
+    auto& entry = _stats[std::string{indexTableName}];
+    auto stats = entry.lock();
+    if (!stats) {
+        stats = std::make_shared<EloqIndexStats>();
+        entry = stats;
+    }
+    return stats;
+}
+
+std::shared_ptr<EloqIndexStats> EloqIndexStatsRegistry::find(std::string_view indexTableName) {
+    std::lock_guard<std::mutex> lk(_mutex);
+    auto it = _stats.find(std::string{indexTableName});
+    if (it == _stats.end()) {
+        return nullptr;
+    }
+    auto stats = it->second.lock();
+    if (!stats) {
+        _stats.erase(it);
+    }
+    return stats;
+}
+
+boost::optional<double> EloqCardinalityEstimator::estimateKeysExamined(
+    OperationContext* opCtx,
+    const NamespaceString& nss,
+    const IndexEntry& index,
+    const IndexBounds& bounds) {
+    if (index.type != INDEX_BTREE) {
+        return boost::none;
+    }
+
+    auto stats = EloqIndexStatsRegistry::get().find(
+        eloqIndexTableName(nss.ns(), index.name, index.keyPattern, index.unique));
+    if (!stats || !stats->trusted()) {
+        return boost::none;
+    }
+    auto histogram = stats->histogram();
+    if (!histogram) {
+        return 0.0;
+    }
+
+    Ordering ordering = Ordering::make(index.keyPattern);
+    double fraction = 0;
+    if (bounds.isSimpleRange) {
+        fraction = fractionBetween(*histogram,
+                                   bounds.startKey,
+                                   IndexBounds::isStartIncludedInBound(bounds.boundInclusion),
+                                   bounds.endKey,
+                                   IndexBounds::isEndIncludedInBound(bounds.boundInclusion),
+                                   ordering);
+    } else {
+        std::vector<BSONElement> prefix;
+        size_t numRanges = 0;
+        if (!addFractionInBounds(
+                *histogram, bounds, ordering, 0, &prefix, &numRanges, &fraction)) {
+            return boost::none;
+        }
+    }
+    return std::min(fraction, 1.0) * stats->numKeys();
+}
+
+std::string eloqIndexTableName(std::string_view ns,
+                               std::string_view indexName,
+                               const BSONObj& keyPattern,
+                               bool unique) {
+    // The _id index shares the table of the collection.
+    auto tableName = IndexDescriptor::isIdIndexPattern(keyPattern)
+        ? Eloq::MongoTableToTxServiceTableName(ns, true)
+        : Eloq::MongoIndexToTxServiceTableName(ns, indexName, unique);
+    return std::string{tableName.StringView()};
+}
+
+}  // namespace mongo
@@ -0,0 +1,265 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/query/cardinality_estimator.h"
+
+namespace mongo {
+
+/**
+ * Equi-depth histogram over the KeyString encoded keys of an index: every bucket holds the same
+ * share of the keys, so frequent values get narrow buckets. Positions inside a bucket are
+ * interpolated on the key bytes.
+ */
+class EloqKeyHistogram {
+public:
+    static constexpr size_t kMaxBuckets = 64;
+
+    /**
+     * Builds the histogram of a sample of keys, which must be sorted and non-empty.
+     */
+    explicit EloqKeyHistogram(const std::vector<std::string>& sortedSample);
+
+    /**
+     * Returns the estimated fraction of keys k with lo <= k <= hi.
+     */
+    double fractionInRange(std::string_view lo, std::string_view hi) const;
+
+    size_t numBuckets() const {
+        return _bounds.size() - 1;
+    }
+
+    /**
+     * Bucket i holds the keys between bounds()[i] and bounds()[i + 1].
+     */
+    const std::vector<std::string>& bounds() const {
+        return _bounds;
+    }
+
+private:
+    // Estimated fraction of keys below 'key'.
+    double _fractionBelow(std::string_view key) const;
+
+    std::vector<std::string> _bounds;
+};
+
+/**
+ * Key statistics of one index: a uniform reservoir sample of its keys, and the number of keys it
+ * holds. Only committed writes are recorded, and only once refresh() has scanned the whole index.
+ * Of those, one in kWriteSampleRate per thread is counted, standing for kWriteSampleRate writes.
+ * Inserts only take the mutex when their key is picked for the sample, and deletes when their key
+ * may be in it.
+ *
+ * The statistics are only trusted once refresh() has scanned the whole index, since inserts
+ * before this process started, and keys added by index builds in txservice, are never observed.
+ * They stop being trusted again once the writes counted since make up more than a quarter of the
+ * keys seen by that scan, or kTrustedFor after it, since writes committed through other nodes are
+ * never observed either.
+ */
+class EloqIndexStats {
+public:
+    static constexpr size_t kSampleSize = 2048;
+    static constexpr uint64_t kWriteSampleRate = 16;
+    static constexpr std::chrono::minutes kTrustedFor{10};
+
+    /**
+     * Returns whether the current write of the calling thread is one that is counted.
+     */
+    static bool countsWrite() {
+        thread_local uint64_t writes = 0;
+        return ++writes % kWriteSampleRate == 0;
+    }
+
+    /**
+     * Whether the KeyString encoded 'key' may be in the sample, so that a delete of it must be
+     * recorded.
+     */
+    bool mayBeSampled(std::string_view key) const {
+        return _maybeSampled(key);
+    }
+
+    /**
+     * Counts a committed insert of the KeyString encoded 'key' that countsWrite() picked.
+     */
+    void recordInsert(std::string_view key) {
+        _changesSinceRefresh.fetch_add(kWriteSampleRate, std::memory_order_relaxed);
+        _addKey(key, kWriteSampleRate);
+    }
+
+    /**
+     * Drops the KeyString encoded 'key' of a committed delete from the sample, and counts the
+     * delete if countsWrite() picked it.
+     */
+    void recordDelete(std::string_view key, bool counted) {
+        if (counted) {
+            _changesSinceRefresh.fetch_add(kWriteSampleRate, std::memory_order_relaxed);
+            _numKeys.fetch_sub(kWriteSampleRate, std::memory_order_relaxed);
+        }
+        if (_maybeSampled(key)) {
+            _removeSample(key);
+        }
+    }
+
+    /**
+     * Resamples the index from 'scan', which calls back with every key of the index. Inserts
+     * committing concurrently are counted as well, which may overcount them slightly.
+     */
+    template <typename Scan>
+    void refresh(Scan&& scan) {
+        _reset();
+        scan([this](std::string_view key) { _addKey(key, 1); });
+        _numKeysAtRefresh.store(numKeys());
+        _changesSinceRefresh.store(0);
+        _refreshedAt.store(std::chrono::steady_clock::now().time_since_epoch().count());
+        _complete.store(true);
+    }
+
+    bool complete() const {
+        return _complete.load();
+    }
+
+    /**
+     * Whether the statistics are complete, and the last refresh() is recent and the index has not
+     * changed much since.
+     */
+    bool trusted() const {
+        const std::chrono::steady_clock::duration sinceRefresh{
+            std::chrono::steady_clock::now().time_since_epoch().count() - _refreshedAt.load()};
+        return complete() && sinceRefresh <= kTrustedFor &&
+            _changesSinceRefresh.load(std::memory_order_relaxed) <=
+            std::max<long long>(_numKeysAtRefresh.load(), kSampleSize) / 4;
+    }
+
+    long long numKeys() const {
+        return std::max<long long>(_numKeys.load(std::memory_order_relaxed), 0);
+    }
+
+    /**
+     * Returns the histogram of the current sample, rebuilt when an eighth of the sample has been
+     * replaced since it was last built. Returns nullptr if the sample is empty.
+     */
+    std::shared_ptr<const EloqKeyHistogram> histogram();
+
+    void report(BSONObjBuilder* builder, bool withBuckets);
+
+private:
+    // Bits of _sampledKeyFilter, a Bloom filter with one hash over the keys stored in the sample.
+    static constexpr size_t kFilterBits = size_t{1} << 16;
+
+    // Adds 'key', standing for 'weight' keys.
+    void _addKey(std::string_view key, uint64_t weight) {
+        _numKeys.fetch_add(weight, std::memory_order_relaxed);
+        if (auto slot = _pickSampleSlot(weight)) {
+            _storeSample(*slot, key);
+        }
+    }
+
+    static size_t _filterBit(std::string_view key) {
+        return std::hash<std::string_view>{}(key) % kFilterBits;
+    }
+
+    bool _maybeSampled(std::string_view key) const {
+        size_t bit = _filterBit(key);
+        return _sampledKeyFilter[bit / 64].load(std::memory_order_relaxed) &
+            (uint64_t{1} << (bit % 64));
+    }
+
+    std::optional<size_t> _pickSampleSlot(uint64_t weight);
+    void _storeSample(size_t slot, std::string_view key);
+    void _removeSample(std::string_view key);
+    void _reset();
+
+    std::atomic<long long> _numKeys{0};
+    std::atomic<uint64_t> _insertsSeen{0};
+    std::atomic<bool> _complete{false};
+    std::atomic<long long> _numKeysAtRefresh{0};
+    std::atomic<long long> _changesSinceRefresh{0};
+    // steady_clock ticks of the last refresh().
+    std::atomic<std::chrono::steady_clock::rep> _refreshedAt{0};
+
+    // Bits are set under _mutex and only cleared by _reset(), so keys replaced in the sample may
+    // leave stale bits behind, which only cost deletes a lookup under the mutex.
+    std::array<std::atomic<uint64_t>, kFilterBits / 64> _sampledKeyFilter{};
+
+    std::mutex _mutex;
+    std::vector<std::string> _sample;
+    // Slot in _sample of each sampled key. Keys are unique within an index.
+    absl::flat_hash_map<std::string, size_t> _sampleSlots;
+    uint64_t _sampleChanges{0};
+    std::shared_ptr<const EloqKeyHistogram> _histogram;
+};
+
+/**
+ * Process-wide lookup of index statistics by the txservice table name of the index. Statistics
+ * live as long as some EloqIndex holds them, so they go away with dropped indexes.
+ */
+class EloqIndexStatsRegistry {
+public:
+    static EloqIndexStatsRegistry& get();
+
+    /**
+     * Returns the statistics of 'indexTableName', creating them if needed.
+     */
+    std::shared_ptr<EloqIndexStats> getOrCreate(std::string_view indexTableName);
+
+    /**
+     * Returns the statistics of 'indexTableName', or nullptr if no open index has any.
+     */
+    std::shared_ptr<EloqIndexStats> find(std::string_view indexTableName);
+
+private:
+    std::mutex _mutex;
+    absl::flat_hash_map<std::string, std::weak_ptr<EloqIndexStats>> _stats;
+};
+
+/**
+ * Estimates index scans from the histograms of EloqIndexStatsRegistry.
+ */
+class EloqCardinalityEstimator final : public CardinalityEstimator {
+public:
+    boost::optional<double> estimateKeysExamined(OperationContext* opCtx,
+                                                 const NamespaceString& nss,
+                                                 const IndexEntry& index,
+                                                 const IndexBounds& bounds) override;
+};
+
+/**
+ * Returns the txservice table name holding the index 'indexName' of collection 'ns'.
+ */
+std::string eloqIndexTableName(std::string_view ns,
+                               std::string_view indexName,
+                               const BSONObj& keyPattern,
+                               bool unique);
+
+}  // namespace mongo
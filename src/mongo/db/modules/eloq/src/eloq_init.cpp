@@ -23,6 +23,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/query/cardinality_estimator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/kv/kv_storage_engine.h"
 #include "mongo/db/storage/storage_engine_init.h"
@@ -31,6 +32,7 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/util/log.h"
 
+#include "mongo/db/modules/eloq/src/eloq_index_stats.h"
 #include "mongo/db/modules/eloq/src/eloq_kv_engine.h"
 #include "src/base/eloq_util.h"
 
@@ -52,6 +54,10 @@ public:
 
         auto storageEngine = std::make_unique<KVStorageEngine>(kv.release(), options);
         storageEngine->setUseNoopLockImpl(true);
+
+        // Let the planner prune candidate plans with the key histograms of Eloq indexes.
+        CardinalityEstimator::set(getGlobalServiceContext(),
+                                  std::make_unique<EloqCardinalityEstimator>());
         return storageEngine.release();
     }
 
@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <chrono>
+#include <cstring>
 #include <thread>
 #include <utility>
 
@@ -743,9 +744,13 @@ bool EloqRecordStore::findRecord(OperationContext* opCtx,
     auto ru = EloqRecoveryUnit::get(opCtx);
 
     Eloq::MongoKey mongoKey(id);
-    Eloq::MongoRecord mongoRecord;
     uint64_t keySchemaVersion = ru->getIndexSchema(_tableName)->SchemaTs();
 
+    // Reads the document straight into a ref-counted buffer, which the RecordData below takes
+    // over. Callers such as Collection::docFor keep the BSON past the snapshot, which the owned
+    // buffer allows without a second copy.
+    Eloq::MongoReadRecord mongoRecord;
+
     bool isForWrite = opCtx->isUpsert();
     auto [exists, err] =
         ru->getKV(opCtx, _tableName, keySchemaVersion, &mongoKey, &mongoRecord, isForWrite);
@@ -755,9 +760,8 @@ bool EloqRecordStore::findRecord(OperationContext* opCtx,
         return false;
     }
 
-    *out =
-        RecordData{mongoRecord.EncodedBlobData(), static_cast<int>(mongoRecord.EncodedBlobSize())}
-            .getOwned();
+    const int size = static_cast<int>(mongoRecord.EncodedBlobSize());
+    *out = RecordData{mongoRecord.ReleaseEncodedBlob(), size};
 
 
     // timer.stop();
@@ -939,7 +943,7 @@ Status EloqRecordStore::updateRecord(OperationContext* opCtx,
 }
 
 bool EloqRecordStore::updateWithDamagesSupported() const {
-    return false;
+    return !_isCatalog;
 }
 
 StatusWith<RecordData> EloqRecordStore::updateWithDamages(
@@ -948,8 +952,28 @@ StatusWith<RecordData> EloqRecordStore::updateWithDamages(
     const RecordData& oldRec,
     const char* damageSource,
     const mutablebson::DamageVector& damages) {
-    MONGO_UNREACHABLE;
-    return Status::OK();
+    MONGO_LOG(1) << "EloqRecordStore::updateWithDamages"
+                 << ". id: " << loc << ", damages: " << damages.size();
+
+    // The damages only overwrite fixed-width values, so the new record has the same size as the
+    // old one. Patch a copy of the old bytes instead of re-serializing the whole document.
+    const int len = oldRec.size();
+    SharedBuffer newData = SharedBuffer::allocate(len);
+    std::memcpy(newData.get(), oldRec.data(), len);
+    for (const mutablebson::DamageEvent& damage : damages) {
+        invariant(damage.targetOffset + damage.size <= static_cast<size_t>(len));
+        std::memcpy(newData.get() + damage.targetOffset,
+                    damageSource + damage.sourceOffset,
+                    damage.size);
+    }
+
+    // Indexes are never affected by an in-place update, but an index being built concurrently
+    // still needs its keys checked, which updateRecord() takes care of.
+    Status status = updateRecord(opCtx, loc, newData.get(), len, false, nullptr);
+    if (!status.isOK()) {
+        return status;
+    }
+    return RecordData(std::move(newData), len);
 }
 
 std::unique_ptr<SeekableRecordCursor> EloqRecordStore::getCursor(OperationContext* opCtx,
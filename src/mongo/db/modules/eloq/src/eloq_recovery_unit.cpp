@@ -26,6 +26,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/bson/timestamp.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/recovery_unit.h"
 #include "mongo/db/storage/snapshot.h"
 #include "mongo/util/assert_util.h"
@@ -51,6 +52,7 @@ namespace recorder {
 bvar::LatencyRecorder kCommitLatency{"mongo_commit"};
 bvar::LatencyRecorder kDBRequestHandleLatency{"mongo_dbrequest_handle"};
 bvar::Adder<int64_t> kConflictCounter("mongo_transaction_conflict_total");
+bvar::Adder<int64_t> kPointReadFastCloseCounter("mongo_point_read_fast_close_total");
 
 }  // namespace recorder
 
@@ -69,6 +71,9 @@ std::atomic<uint64_t> nextSnapshotId{1};
 
 }  // namespace
 
+// Ends auto-commit transactions that only read a single key with AbortTx instead of CommitTx.
+MONGO_EXPORT_SERVER_PARAMETER(eloqPointReadFastPath, bool, true);
+
 txservice::AlterTableInfo getAlterTableInfo(std::string_view oldMetadata,
                                             std::string_view newMetadata) {
 
@@ -150,7 +155,12 @@ void EloqRecoveryUnit::reset() {
     _active = false;
     _isTimestamped = false;
     _inMultiDocumentTransation = false;
+    _txnHasWrites = false;
+    _txnHasScans = false;
+    _txnPointReads = 0;
     _kvPair.reset();
+    _writeIntents.clear();
+    _hotKeySlot.reset();
     _commitTimestamp.reset();
     _prepareTimestamp.reset();
     _lastTimestampSet.reset();
@@ -298,6 +308,7 @@ bool EloqRecoveryUnit::inActiveTxn() const {
 }
 
 void EloqRecoveryUnit::registerCursor(EloqCursor* cursor) {
+    _txnHasScans = true;
     _cursors.emplace(cursor);
 }
 
@@ -324,6 +335,7 @@ std::pair<bool, txservice::TxErrorCode> EloqRecoveryUnit::readCatalog(
     MONGO_LOG(1) << "EloqRecoveryUnit::readCatalog"
                  << ". catalogKey: " << catalogKey.ToString() << ". isForWrite: " << isForWrite
                  << ",txn:" << _txm->TxNumber();
+    _txnHasWrites |= isForWrite;
 
     txservice::TxKey catalogTxKey{&catalogKey};
     const CoroutineFunctors& coro = Client::getCurrent()->coroutineFunctors();
@@ -360,6 +372,7 @@ txservice::TxErrorCode EloqRecoveryUnit::setKV(const txservice::TableName& table
     MONGO_LOG(1) << "EloqRecoveryUnit::setKV. "
                  << "tableName: " << tableName.StringView() << ". mongoKey: " << key->ToString();
     getTxm();
+    _txnHasWrites = true;
     auto err = _txm->TxUpsert(tableName,
                               keySchemaVersion,
                               txservice::TxKey(std::move(key)),
@@ -379,19 +392,27 @@ std::pair<bool, txservice::TxErrorCode> EloqRecoveryUnit::getKV(
     const txservice::TableName& tableName,
     uint64_t keySchemaVersion,
     const Eloq::MongoKey* key,
-    Eloq::MongoRecord* record,
+    txservice::TxRecord* record,
     bool isForWrite) {
     MONGO_LOG(1) << "EloqRecoveryUnit::getKV"
                  << ". tableName: " << tableName.StringView() << ". txn: " << _txm->TxNumber()
                  << ", isolation: " << (int)_txm->GetIsolationLevel()
                  << ", isForWrite: " << isForWrite << ". mongoKey: " << key->ToString();
     getTxm();
+    EloqTraceSpan span(_traceId, EloqTracer::SpanKind::kGetKV, 1);
     txservice::TxKey txKey(key);
     const CoroutineFunctors& coro = Client::getCurrent()->coroutineFunctors();
 
+    if (isForWrite) {
+        _txnHasWrites = true;
+        _trackWriteIntent(tableName, *key);
+    }
+    ++_txnPointReads;
+
+    constexpr int kMaxAttempts = 10;
     bool exists = false;
     txservice::TxErrorCode err = txservice::TxErrorCode::NO_ERROR;
-    for (int i = 0; i < 10; ++i) {
+    for (int i = 0; i < kMaxAttempts; ++i) {
         txservice::ReadTxRequest readTxReq(&tableName,
                                            keySchemaVersion,
                                            &txKey,
@@ -416,6 +437,14 @@ std::pair<bool, txservice::TxErrorCode> EloqRecoveryUnit::getKV(
         if (err == txservice::TxErrorCode::READ_WRITE_CONFLICT ||
             err == txservice::TxErrorCode::WRITE_WRITE_CONFLICT) {
             recorder::kConflictCounter << 1;
+            auto& contention = EloqContentionManager::get();
+            EloqContentionManager::KeyRef keyRef(tableName, *key);
+            contention.recordKeyConflict(keyRef);
+            if (i + 1 < kMaxAttempts) {
+                // The conflict is returned as is after the last attempt, so do not delay it.
+                EloqTraceSpan retrySpan(_traceId, EloqTracer::SpanKind::kRetry, i);
+                contention.backoff(i, keyRef);
+            }
             continue;
         } else if (err != txservice::TxErrorCode::NO_ERROR) {
             MONGO_LOG(1) << "EloqRecoveryUnit::getKV fail"
@@ -466,6 +495,9 @@ txservice::TxErrorCode EloqRecoveryUnit::batchGetKV(OperationContext* opCtx,
     MONGO_LOG(1) << "EloqRecoveryUnit::batchGetKV. tableName: " << tableName.StringView()
                  << ", batch size: " << batch.size();
     const CoroutineFunctors& coro = Client::getCurrent()->coroutineFunctors();
+    _txnHasWrites |= isForWrite;
+    _txnPointReads += batch.size();
+    EloqTraceSpan span(_traceId, EloqTracer::SpanKind::kGetKV, batch.size());
 
     bool isForShare = false;
     bool readLocal = false;
@@ -487,6 +519,7 @@ txservice::TxErrorCode EloqRecoveryUnit::batchGetKV(OperationContext* opCtx,
     } else if (err == txservice::TxErrorCode::DEAD_LOCK_ABORT ||
                err == txservice::TxErrorCode::READ_WRITE_CONFLICT ||
                err == txservice::TxErrorCode::WRITE_WRITE_CONFLICT) {
+        EloqContentionManager::get().recordTableConflict(tableName);
         MONGO_LOG(0) << "EloqRecoveryUnit::batchGetKV tableName: " << tableName.StringView() << ", "
                      << batchReadTxReq.ErrorMsg();
     } else {
@@ -500,6 +533,7 @@ void EloqRecoveryUnit::notifyReloadCache(OperationContext* opCtx) {
     MONGO_LOG(1) << "EloqRecoveryUnit::notifyReloadCache";
 
     getTxm();
+    _txnHasWrites = true;
 
     const CoroutineFunctors& coro = Client::getCurrent()->coroutineFunctors();
     txservice::ReloadCacheTxRequest reloadTxReq(coro.yieldFuncPtr, coro.resumeFuncPtr, _txm);
@@ -516,6 +550,7 @@ Status EloqRecoveryUnit::createTable(const txservice::TableName& tableName,
                  << ". tableName: " << tableName.StringView()
                  << ". metadata: " << BSONObj(metadata.data());
     getTxm();
+    _txnHasWrites = true;
 
     std::string schemaImage{EloqDS::SerializeSchemaImage(std::string{metadata}, "", "")};
     Eloq::MongoTableSchema tempSchema(tableName, schemaImage, 0);
@@ -564,6 +599,7 @@ Status EloqRecoveryUnit::dropTable(const txservice::TableName& tableName,
     MONGO_LOG(1) << "EloqRecoveryUnit::dropTable"
                  << ". tableName: " << tableName.StringView();
     getTxm();
+    _txnHasWrites = true;
 
     std::string emptyImage{""};
     const CoroutineFunctors& coro = Client::getCurrent()->coroutineFunctors();
@@ -612,6 +648,7 @@ Status EloqRecoveryUnit::updateTable(const txservice::TableName& tableName,
     MONGO_LOG(1) << "EloqRecoveryUnit::updateTable"
                  << ". tableName: " << tableName.StringView();
     getTxm();
+    _txnHasWrites = true;
 
     /**
      * Generate new catalog image.
@@ -919,6 +956,24 @@ void EloqRecoveryUnit::_commit() {
     }
 }
 
+void EloqRecoveryUnit::_trackWriteIntent(const txservice::TableName& tableName,
+                                         const Eloq::MongoKey& key) {
+    EloqContentionManager::KeyRef keyRef(tableName, key);
+    // Only the first hot key of a transaction is queued on, so two transactions can never wait
+    // for each other's slots.
+    if (!_hotKeySlot) {
+        _hotKeySlot = EloqContentionManager::get().acquireHotKeySlot(keyRef);
+    }
+    if (_writeIntents.size() < kMaxTrackedWriteIntents) {
+        _writeIntents.push_back(std::move(keyRef));
+    }
+}
+
+bool EloqRecoveryUnit::_isReadOnlyPointRead() const {
+    return eloqPointReadFastPath.load() && !_inMultiDocumentTransation && !_txnHasWrites &&
+        !_txnHasScans && _txnPointReads <= 1;
+}
+
 void EloqRecoveryUnit::_txnOpen(txservice::IsolationLevel isolationLevel) {
     MONGO_LOG(1) << "EloqRecoveryUnit::_txnOpen";
     invariant(!_active);
@@ -926,6 +981,8 @@ void EloqRecoveryUnit::_txnOpen(txservice::IsolationLevel isolationLevel) {
         isolationLevel = txservice::IsolationLevel::Snapshot;
     }
     MONGO_LOG(1) << "Opening transaction with isolation level: " << isolationLevel;
+    _traceId = EloqTracer::get().sampleOperation();
+    EloqTraceSpan span(_traceId, EloqTracer::SpanKind::kTxnOpen);
     _txm = txservice::NewTxInit(
         _txService, isolationLevel, eloqGlobalOptions.ccProtocol, UINT32_MAX, localThreadId);
     _active = true;
@@ -941,7 +998,15 @@ void EloqRecoveryUnit::_txnClose(bool commit) {
 
     bool succeed = true;
     txservice::TxErrorCode err = txservice::TxErrorCode::NO_ERROR;
-    if (commit) {
+    EloqTraceSpan commitSpan(commit ? _traceId : 0, EloqTracer::SpanKind::kCommit);
+    if (commit && _isReadOnlyPointRead()) {
+        // A single read has already observed a committed version and holds nothing that needs
+        // validating or logging, so releasing it is all that is left to do.
+        MONGO_LOG(1) << "EloqRecoveryUnit::_txnClose. "
+                     << "txm read-only point read " << _txm->TxNumber();
+        recorder::kPointReadFastCloseCounter << 1;
+        txservice::AbortTx(_txm, coro.yieldFuncPtr, coro.resumeFuncPtr);
+    } else if (commit) {
         MONGO_LOG(1) << "EloqRecoveryUnit::_txnClose. "
                      << "txm commit " << _txm->TxNumber();
 
@@ -949,6 +1014,14 @@ void EloqRecoveryUnit::_txnClose(bool commit) {
         if (!succeed) {
             MONGO_LOG(1) << "txm commit fail. "
                          << "errorCode:" << err;
+            if (err == txservice::TxErrorCode::READ_WRITE_CONFLICT ||
+                err == txservice::TxErrorCode::WRITE_WRITE_CONFLICT) {
+                auto& contention = EloqContentionManager::get();
+                contention.recordCommitConflict();
+                for (const auto& keyRef : _writeIntents) {
+                    contention.recordKeyConflict(keyRef);
+                }
+            }
         }
     } else {
         MONGO_LOG(1) << "EloqRecoveryUnit::_txnClose. "
@@ -956,6 +1029,7 @@ void EloqRecoveryUnit::_txnClose(bool commit) {
         // rollback
         txservice::AbortTx(_txm, coro.yieldFuncPtr, coro.resumeFuncPtr);
     }
+    commitSpan.setArg(static_cast<int64_t>(err));
 
     // We reset the _lastTimestampSet between transactions. Since it is legal for one
     // transaction on a RecoveryUnit to call setTimestamp() and another to call
@@ -964,8 +1038,15 @@ void EloqRecoveryUnit::_txnClose(bool commit) {
     _txm = nullptr;
     _active = false;
     _inMultiDocumentTransation = false;
+    _txnHasWrites = false;
+    _txnHasScans = false;
+    _txnPointReads = 0;
+    _traceId = 0;
     _mySnapshotId = nextSnapshotId.fetch_add(1);
     _kvPair.reset();
+    _writeIntents.clear();
+    // Hand a hot key to the next queued writer only once this transaction's locks are released.
+    _hotKeySlot.reset();
     _discoveredTableMap.clear();
     // _unreadyTableMap.clear();
 
@@ -34,7 +34,9 @@
 #include "mongo/db/modules/eloq/src/base/eloq_key.h"
 #include "mongo/db/modules/eloq/src/base/eloq_record.h"
 #include "mongo/db/modules/eloq/src/base/eloq_table_schema.h"
+#include "mongo/db/modules/eloq/src/eloq_contention_manager.h"
 #include "mongo/db/modules/eloq/src/eloq_cursor.h"
+#include "mongo/db/modules/eloq/src/eloq_tracing.h"
 
 #include "mongo/db/modules/eloq/tx_service/include/catalog_key_record.h"
 #include "mongo/db/modules/eloq/tx_service/include/cc_protocol.h"
@@ -130,6 +132,11 @@ public:
     txservice::TransactionExecution* getTxm();
     bool inActiveTxn() const;
 
+    // Trace id of the open transaction's operation, 0 unless it was sampled. See EloqTracer.
+    uint64_t traceId() const {
+        return _traceId;
+    }
+
     void registerCursor(EloqCursor* cursor);
     void closeAllCursors();
     void unregisterCursor(EloqCursor* cursor);
@@ -151,7 +158,7 @@ public:
         const txservice::TableName& tableName,
         uint64_t keySchemaVersion,
         const Eloq::MongoKey* key,
-        Eloq::MongoRecord* record,
+        txservice::TxRecord* record,
         bool isForWrite);
     // store in the internal kvpair
     [[nodiscard]] std::pair<bool, txservice::TxErrorCode> getKVInternal(
@@ -214,6 +221,12 @@ private:
     void _txnOpen(txservice::IsolationLevel isolationLevel);
     void _txnClose(bool commit);
 
+    void _trackWriteIntent(const txservice::TableName& tableName, const Eloq::MongoKey& key);
+
+    // True if the open transaction is an auto-commit read of at most one key which wrote nothing
+    // and opened no scan. Such a transaction has nothing to validate or commit.
+    bool _isReadOnlyPointRead() const;
+
 private:
     txservice::TxService* _txService;         // not owned
     const OperationContext* _opCtx{nullptr};  // not owned;
@@ -225,10 +238,24 @@ private:
     bool _isTimestamped{false};
     bool _inMultiDocumentTransation{false};
 
+    // Shape of the open transaction, see _isReadOnlyPointRead().
+    bool _txnHasWrites{false};
+    bool _txnHasScans{false};
+    uint32_t _txnPointReads{0};
+
+    uint64_t _traceId{0};
+
     absl::flat_hash_set<EloqCursor*> _cursors;
 
     EloqKVPair _kvPair;
 
+    // Keys read for write in the current transaction, so that a commit-time conflict can be
+    // attributed to them. Bounded by kMaxTrackedWriteIntents.
+    static constexpr size_t kMaxTrackedWriteIntents = 4;
+    std::vector<EloqContentionManager::KeyRef> _writeIntents;
+    // Exclusive access to a hot key, held until the transaction closes.
+    std::unique_ptr<EloqContentionManager::HotKeySlot> _hotKeySlot;
+
     Timestamp _commitTimestamp;
     Timestamp _prepareTimestamp;
     boost::optional<Timestamp> _lastTimestampSet;
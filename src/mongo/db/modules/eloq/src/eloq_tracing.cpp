@@ -0,0 +1,236 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <utility>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/stringutils.h"
+
+#include "mongo/db/modules/eloq/src/eloq_tracing.h"
+
+namespace mongo {
+
+// Traces one in this many operations of each thread; 0 disables tracing.
+MONGO_EXPORT_SERVER_PARAMETER(eloqTraceSamplePeriod, int, 0);
+
+namespace {
+
+// Appends 'nanos' as microseconds with nanosecond precision, the unit of Chrome trace timestamps.
+void appendMicros(std::string* out, uint64_t nanos) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%" PRIu64 ".%03" PRIu64, nanos / 1000, nanos % 1000);
+    out->append(buf);
+}
+
+void appendUnsigned(std::string* out, uint64_t value) {
+    out->append(std::to_string(value));
+}
+
+}  // namespace
+
+/**
+ * Owned by each thread that recorded a span. Retires the thread's ring on thread exit, leaving its
+ * spans readable until the ring is dropped.
+ */
+class EloqTracer::ThreadRingHandle {
+public:
+    ~ThreadRingHandle() {
+        if (ring) {
+            ring->retired.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    ThreadRing* ring{nullptr};
+};
+
+EloqTracer& EloqTracer::get() {
+    static EloqTracer tracer;
+    return tracer;
+}
+
+const char* EloqTracer::spanKindName(SpanKind kind) {
+    switch (kind) {
+        case SpanKind::kTxnOpen:
+            return "txnOpen";
+        case SpanKind::kGetKV:
+            return "getKV";
+        case SpanKind::kScanBatch:
+            return "scanBatch";
+        case SpanKind::kCommit:
+            return "commit";
+        case SpanKind::kRetry:
+            return "retry";
+    }
+    return "unknown";
+}
+
+uint64_t EloqTracer::sampleOperation() {
+    const int period = eloqTraceSamplePeriod.load();
+    if (MONGO_likely(period <= 0)) {
+        return 0;
+    }
+    // Counting per thread keeps sampling off any shared cache line.
+    thread_local uint64_t operations = 0;
+    if (++operations % period != 0) {
+        return 0;
+    }
+    return _nextTraceId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EloqTracer::record(SpanRecord record) {
+    thread_local ThreadRingHandle handle;
+    if (MONGO_unlikely(!handle.ring)) {
+        handle.ring = _registerThread();
+    }
+    ThreadRing* ring = handle.ring;
+    record.threadId = ring->threadId;
+
+    // A seqlock over the whole ring: readers check 'claimed' after copying to discard any slot
+    // this write may have torn, and only read slots below 'published'.
+    const uint64_t pos = ring->published.load(std::memory_order_relaxed);
+    ring->claimed.store(pos + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    ring->records[pos % kRingCapacity] = record;
+    ring->published.store(pos + 1, std::memory_order_release);
+}
+
+std::vector<EloqTracer::SpanRecord> EloqTracer::collect(size_t limit) {
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        rings = _rings;
+    }
+    const uint64_t clearedAtNanos = _clearedAtNanos.load(std::memory_order_relaxed);
+
+    std::vector<SpanRecord> spans;
+    for (const auto& ring : rings) {
+        const uint64_t published = ring->published.load(std::memory_order_acquire);
+        const uint64_t first = published > kRingCapacity ? published - kRingCapacity : 0;
+        const size_t base = spans.size();
+        for (uint64_t pos = first; pos < published; ++pos) {
+            spans.push_back(ring->records[pos % kRingCapacity]);
+        }
+
+        // The slot of a record being written is shared with the record kRingCapacity before it,
+        // so everything up to that one may have been overwritten while it was copied.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claimed = ring->claimed.load(std::memory_order_relaxed);
+        const uint64_t firstIntact = claimed > kRingCapacity ? claimed - kRingCapacity : 0;
+        if (firstIntact > first) {
+            const size_t torn = std::min<uint64_t>(firstIntact - first, spans.size() - base);
+            spans.erase(spans.begin() + base, spans.begin() + base + torn);
+        }
+    }
+
+    spans.erase(std::remove_if(spans.begin(),
+                               spans.end(),
+                               [&](const SpanRecord& span) {
+                                   return span.startNanos < clearedAtNanos;
+                               }),
+                spans.end());
+    std::sort(spans.begin(), spans.end(), [](const SpanRecord& lhs, const SpanRecord& rhs) {
+        return lhs.startNanos < rhs.startNanos;
+    });
+    if (spans.size() > limit) {
+        spans.erase(spans.begin(), spans.end() - limit);
+    }
+    return spans;
+}
+
+std::string EloqTracer::toChromeTraceJson(const std::vector<SpanRecord>& spans) {
+    std::string out;
+    out.reserve(64 + spans.size() * 128);
+    out.append("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    bool first = true;
+    auto beginEvent = [&] {
+        if (!first) {
+            out.push_back(',');
+        }
+        first = false;
+    };
+
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        for (const auto& ring : _rings) {
+            beginEvent();
+            out.append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":");
+            appendUnsigned(&out, ring->threadId);
+            out.append(",\"args\":{\"name\":\"");
+            out.append(escape(ring->threadName));
+            out.append("\"}}");
+        }
+    }
+
+    for (const auto& span : spans) {
+        beginEvent();
+        out.append("{\"name\":\"");
+        out.append(spanKindName(span.kind));
+        out.append("\",\"cat\":\"eloq\",\"ph\":\"X\",\"pid\":1,\"tid\":");
+        appendUnsigned(&out, span.threadId);
+        out.append(",\"ts\":");
+        appendMicros(&out, span.startNanos);
+        out.append(",\"dur\":");
+        appendMicros(&out, span.durationNanos);
+        out.append(",\"args\":{\"traceId\":");
+        appendUnsigned(&out, span.traceId);
+        out.append(",\"arg\":");
+        out.append(std::to_string(span.arg));
+        out.append("}}");
+    }
+
+    out.append("]}");
+    return out;
+}
+
+void EloqTracer::clear() {
+    _clearedAtNanos.store(nowNanos(), std::memory_order_relaxed);
+}
+
+EloqTracer::ThreadRing* EloqTracer::_registerThread() {
+    std::lock_guard<std::mutex> lk(_mutex);
+
+    size_t retired = std::count_if(_rings.begin(), _rings.end(), [](const auto& ring) {
+        return ring->retired.load(std::memory_order_relaxed);
+    });
+    for (auto it = _rings.begin(); retired > kMaxRetiredRings && it != _rings.end();) {
+        if ((*it)->retired.load(std::memory_order_relaxed)) {
+            it = _rings.erase(it);
+            --retired;
+        } else {
+            ++it;
+        }
+    }
+
+    _rings.push_back(std::make_shared<ThreadRing>(_nextThreadId++, getThreadName().toString()));
+    return _rings.back().get();
+}
+
+void EloqTraceSpan::_finish() {
+    const uint64_t endNanos = EloqTracer::nowNanos();
+    EloqTracer::get().record(
+        {_traceId, _startNanos, endNanos - _startNanos, _arg, 0 /* threadId */, _kind});
+}
+
+}  // namespace mongo
@@ -0,0 +1,160 @@
+/**
+ *    Copyright (C) 2025 EloqData Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the license:
+ *    1. GNU Affero General Public License, version 3, as published by the Free
+ *    Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mongo/platform/compiler.h"
+
+namespace mongo {
+
+/**
+ * Sampled tracing of the Eloq storage hot path: transaction open, point reads, scan batches,
+ * commits and conflict retries.
+ *
+ * Tracing is always compiled in and toggled with the eloqTraceSamplePeriod server parameter.
+ * Sampling is decided once per operation, when EloqRecoveryUnit opens its transaction: a sampled
+ * operation gets a non-zero trace id, and every span it opens is recorded under that id. Spans of
+ * unsampled operations are skipped by a single branch on the zero trace id.
+ *
+ * Each thread that records a span gets a fixed-size ring of SpanRecords which it alone writes to,
+ * so recording takes no locks. Readers copy the rings without stopping the writers and discard the
+ * records that may have been overwritten while they copied.
+ */
+class EloqTracer {
+public:
+    static constexpr size_t kRingCapacity = 2048;
+    // Rings of exited threads kept around for their spans, the oldest being dropped first.
+    static constexpr size_t kMaxRetiredRings = 16;
+
+    enum class SpanKind : uint8_t { kTxnOpen, kGetKV, kScanBatch, kCommit, kRetry };
+
+    struct SpanRecord {
+        uint64_t traceId;
+        uint64_t startNanos;
+        uint64_t durationNanos;
+        // Kind specific: the transaction number, the number of keys or tuples read, the retry
+        // attempt or the commit error code.
+        int64_t arg;
+        uint32_t threadId;
+        SpanKind kind;
+    };
+
+    static EloqTracer& get();
+
+    static const char* spanKindName(SpanKind kind);
+
+    static uint64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    /**
+     * Decides whether the operation about to open a transaction is traced. Returns its trace id,
+     * or 0 when it is not sampled.
+     */
+    uint64_t sampleOperation();
+
+    // Appends 'record' to the calling thread's ring.
+    void record(SpanRecord record);
+
+    /**
+     * Returns up to 'limit' of the most recent spans over all threads, ordered by start time.
+     * Spans recorded before the last clear() are left out.
+     */
+    std::vector<SpanRecord> collect(size_t limit);
+
+    /**
+     * Renders 'spans' in the Chrome trace event format, loadable by chrome://tracing and
+     * Perfetto. Each span becomes a complete ("X") event, each thread a named track.
+     */
+    std::string toChromeTraceJson(const std::vector<SpanRecord>& spans);
+
+    void clear();
+
+private:
+    struct ThreadRing {
+        ThreadRing(uint32_t id, std::string name) : threadId(id), threadName(std::move(name)) {}
+
+        const uint32_t threadId;
+        const std::string threadName;
+        std::atomic<bool> retired{false};
+        // Number of records whose write has started, and that have been completely written. Only
+        // the owning thread advances them.
+        std::atomic<uint64_t> claimed{0};
+        std::atomic<uint64_t> published{0};
+        std::array<SpanRecord, kRingCapacity> records;
+    };
+
+    class ThreadRingHandle;
+
+    ThreadRing* _registerThread();
+
+    std::atomic<uint64_t> _nextTraceId{1};
+    std::atomic<uint64_t> _clearedAtNanos{0};
+
+    std::mutex _mutex;
+    // Guarded by _mutex.
+    uint32_t _nextThreadId{1};
+    std::vector<std::shared_ptr<ThreadRing>> _rings;
+};
+
+/**
+ * Records the time from construction to destruction as one span of the operation 'traceId'.
+ * Does nothing beyond testing 'traceId' when the operation is not sampled.
+ */
+class EloqTraceSpan {
+public:
+    EloqTraceSpan(uint64_t traceId, EloqTracer::SpanKind kind, int64_t arg = 0)
+        : _traceId(traceId), _kind(kind), _arg(arg) {
+        if (MONGO_unlikely(_traceId != 0)) {
+            _startNanos = EloqTracer::nowNanos();
+        }
+    }
+
+    EloqTraceSpan(const EloqTraceSpan&) = delete;
+    EloqTraceSpan& operator=(const EloqTraceSpan&) = delete;
+
+    ~EloqTraceSpan() {
+        if (MONGO_unlikely(_traceId != 0)) {
+            _finish();
+        }
+    }
+
+    void setArg(int64_t arg) {
+        _arg = arg;
+    }
+
+private:
+    void _finish();
+
+    const uint64_t _traceId;
+    const EloqTracer::SpanKind _kind;
+    int64_t _arg;
+    uint64_t _startNanos{0};
+};
+
+}  // namespace mongo
@@ -271,6 +271,18 @@ TEST(CommandWriteOpsParsers, RealMultiInsert) {
     }
 }
 
+TEST(CommandWriteOpsParsers, InsertDocumentsFromSequenceAreNotCopied) {
+    const auto ns = NamespaceString("test", "foo");
+    auto cmd =
+        BSON("insert" << ns.coll() << "documents" << BSON_ARRAY(BSON("x" << 0) << BSON("x" << 1)));
+    auto request = toOpMsg(ns.db(), cmd, /*useDocSequence*/ true);
+    const auto op = InsertOp::parse(request);
+    ASSERT_EQ(op.getDocuments().size(), 2u);
+    for (size_t i = 0; i < op.getDocuments().size(); ++i) {
+        ASSERT_EQ(op.getDocuments()[i].objdata(), request.sequences[0].objs[i].objdata());
+    }
+}
+
 TEST(CommandWriteOpsParsers, MultiInsertWithStmtId) {
     const auto ns = NamespaceString("test", "foo");
     const BSONObj obj0 = BSON("x" << 0);
@@ -72,6 +72,14 @@ intrusive_ptr<DocumentSource> DocumentSourceCollStats::createFromBson(
                                       << typeName(elem.type()),
                         elem["histograms"].isBoolean());
             }
+            if (!elem["percentiles"].eoo()) {
+                uassert(ErrorCodes::TypeMismatch,
+                        str::stream() << "percentiles option to latencyStats must be bool, got "
+                                      << elem
+                                      << " of type "
+                                      << typeName(elem["percentiles"].type()),
+                        elem["percentiles"].isBoolean());
+            }
         } else if ("storageStats" == fieldName) {
             uassert(40279,
                     str::stream() << "storageStats argument must be an object, but got " << elem
@@ -118,11 +126,13 @@ DocumentSource::GetNextResult DocumentSourceCollStats::getNext() {
     if (_collStatsSpec.hasField("latencyStats")) {
         // If the latencyStats field exists, it must have been validated as an object when parsing.
         bool includeHistograms = false;
+        bool includePercentiles = false;
         if (_collStatsSpec["latencyStats"].type() == BSONType::Object) {
             includeHistograms = _collStatsSpec["latencyStats"]["histograms"].boolean();
+            includePercentiles = _collStatsSpec["latencyStats"]["percentiles"].boolean();
         }
         pExpCtx->mongoProcessInterface->appendLatencyStats(
-            pExpCtx->opCtx, pExpCtx->ns, includeHistograms, &builder);
+            pExpCtx->opCtx, pExpCtx->ns, includeHistograms, includePercentiles, &builder);
     }
 
     if (_collStatsSpec.hasField("storageStats")) {
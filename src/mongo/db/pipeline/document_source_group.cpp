@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <numeric>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -51,6 +53,52 @@ REGISTER_DOCUMENT_SOURCE(group,
                          LiteParsedDocumentSourceDefault::parse,
                          DocumentSourceGroup::createFromBson);
 
+namespace {
+
+size_t spillPartition(uint64_t keyHash) {
+    return keyHash >> (64 - DocumentSourceGroup::kSpillPartitionBits);
+}
+
+/**
+ * Returns the state of 'accums' to spill, merged back by mergeSpilledState().
+ */
+Value spilledState(const intrusive_ptr<Accumulator>* accums, size_t numAccumulators) {
+    switch (numAccumulators) {
+        case 0:  // no values, essentially a distinct
+            return Value();
+        case 1:  // just one value, use optimized serialization as single Value
+            return accums[0]->getValue(/*toBeMerged=*/true);
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                states.push_back(accums[i]->getValue(/*toBeMerged=*/true));
+            }
+            return Value(std::move(states));
+        }
+    }
+}
+
+void mergeSpilledState(const Value& state,
+                       const intrusive_ptr<Accumulator>* accums,
+                       size_t numAccumulators) {
+    switch (numAccumulators) {  // mirrors switch in spilledState()
+        case 0:
+            break;
+        case 1:
+            accums[0]->process(state, true);
+            break;
+        default: {
+            const vector<Value>& states = state.getArray();
+            for (size_t i = 0; i < numAccumulators; i++) {
+                accums[i]->process(states[i], true);
+            }
+        }
+    }
+}
+
+}  // namespace
+
 const char* DocumentSourceGroup::getSourceName() const {
     return "$group";
 }
@@ -80,47 +128,51 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
-    // We aren't streaming, and we have spilled to disk.
-    if (!_sorterIterator)
-        return GetNextResult::makeEOF();
+    // We aren't streaming, and we have spilled to disk. Partitions are returned one at a time.
+    while (!_sorterIterator && _nextGroup == _groups->size()) {
+        if (_nextPartition == kNumSpillPartitions) {
+            dispose();
+            return GetNextResult::makeEOF();
+        }
+        loadPartition(_nextPartition++);
+    }
 
+    if (_sorterIterator) {
+        return getNextMerged();
+    }
+    return getNextStandard();
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::getNextMerged() {
     _currentId = _firstPartOfNextGroup.first;
     const size_t numAccumulators = _accumulatedFields.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
         // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
         // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
+        mergeSpilledState(
+            _firstPartOfNextGroup.second, _currentAccumulators.data(), numAccumulators);
 
         if (!_sorterIterator->more()) {
-            dispose();
+            _sorterIterator.reset();
             break;
         }
 
         _firstPartOfNextGroup = _sorterIterator->next();
     }
 
-    return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    return makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->needsMerge);
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
-    // Not spilled, and not streaming.
-    if (_groups->empty())
+    // Not streaming. Returns the groups of '_groups', which hold all groups unless we spilled.
+    if (_nextGroup == _groups->size())
         return GetNextResult::makeEOF();
 
-    Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+    const GroupHashTable::Group group = _nextGroup++;
+    Document out =
+        makeDocument(_groups->key(group), _groups->accumulators(group), pExpCtx->needsMerge);
 
-    if (++groupsIterator == _groups->end())
+    if (_nextGroup == _groups->size() && !_spilled)
         dispose();
 
     return std::move(out);
@@ -158,7 +210,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
         id = computeId(*_firstDocOfNextGroup);
     } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
 
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+    Document out = makeDocument(_currentId, _currentAccumulators.data(), pExpCtx->needsMerge);
     _currentId = std::move(id);
 
     return std::move(out);
@@ -166,11 +218,16 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
-    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    if (_groups) {
+        _groups->clear();
+    }
+    _spilledRuns.clear();
+    _sortedFiles.clear();
     _sorterIterator.reset();
 
     // Make us look done.
-    groupsIterator = _groups->end();
+    _nextGroup = 0;
+    _nextPartition = kNumSpillPartitions;
 
     _firstDocOfNextGroup = boost::none;
 }
@@ -224,7 +281,14 @@ Value DocumentSourceGroup::serialize(boost::optional<ExplainOptions::Verbosity>
     if (explain && findRelevantInputSort()) {
         return Value(DOC("$streamingGroup" << insides.freeze()));
     }
-    return Value(DOC(getSourceName() << insides.freeze()));
+
+    MutableDocument out(DOC(getSourceName() << insides.freeze()));
+    if (explain && *explain >= ExplainOptions::Verbosity::kExecStats) {
+        BSONObjBuilder spillStats;
+        _spiller.stats().appendTo(&spillStats);
+        out["spillStats"] = Value(spillStats.obj());
+    }
+    return out.freezeToValue();
 }
 
 DocumentSource::GetDepsReturn DocumentSourceGroup::getDependencies(DepsTracker* deps) const {
@@ -264,7 +328,6 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _inputSort(BSONObj()),
       _streaming(false),
       _initialized(false),
-      _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
       _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {}
 
@@ -357,8 +420,6 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
 
 namespace {
 
-using GroupsMap = DocumentSourceGroup::GroupsMap;
-
 class SorterComparator {
 public:
     typedef pair<Value, Value> Data;
@@ -373,18 +434,6 @@ private:
     ValueComparator _valueComparator;
 };
 
-class SpillSTLComparator {
-public:
-    SpillSTLComparator(ValueComparator valueComparator) : _valueComparator(valueComparator) {}
-
-    bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
-        return _valueComparator.evaluate(lhs->first < rhs->first);
-    }
-
-private:
-    ValueComparator _valueComparator;
-};
-
 bool containsOnlyFieldPathsAndConstants(ExpressionObject* expressionObj) {
     for (auto&& it : expressionObj->getChildExpressions()) {
         const intrusive_ptr<Expression>& childExp = it.second;
@@ -426,26 +475,6 @@ void getFieldPathMap(ExpressionObject* expressionObj,
         }
     }
 }
-
-void getFieldPathListForSpilled(ExpressionObject* expressionObj,
-                                std::string prefix,
-                                std::vector<std::string>* fields) {
-    // Given an expression, attempt to compute a vector of strings, each representing the path
-    // through the object to a leaf. For example, for the expression represented by
-    // {x: 2, y: {z: "$a.b"}}, the output would be ["x", "y.z"].
-    for (auto&& it : expressionObj->getChildExpressions()) {
-        intrusive_ptr<Expression> childExp = it.second;
-        ExpressionObject* expObj = dynamic_cast<ExpressionObject*>(childExp.get());
-
-        std::string newPrefix = prefix.empty() ? it.first : prefix + "." + it.first;
-
-        if (expObj) {
-            getFieldPathListForSpilled(expObj, newPrefix, fields);
-        } else {
-            fields->push_back(newPrefix);
-        }
-    }
-}
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
@@ -478,48 +507,36 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     }
 
 
+    if (!_groups) {
+        _groups =
+            stdx::make_unique<GroupHashTable>(pExpCtx->getValueComparator(), numAccumulators);
+    }
+
+    // When spilling in the background, '_groups' is refilled while the previous spill is written,
+    // so each of them gets half of the memory limit.
+    const size_t spillThreshold =
+        _allowDiskUse ? _spiller.spillThreshold(_maxMemoryUsageBytes) : _maxMemoryUsageBytes;
+
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        if (_memoryUsageBytes > spillThreshold) {
             uassert(16945,
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _allowDiskUse);
-            _sortedFiles.push_back(spill());
+            spillPartitioned();
             _memoryUsageBytes = 0;
         }
 
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
         auto rootDocument = input.releaseDocument();
-        Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
 
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
+        bool inserted;
+        intrusive_ptr<Accumulator>* group = findOrInsertGroup(computeId(rootDocument), &inserted);
 
+        /* tickle all the accumulators for the group we found */
         for (size_t i = 0; i < numAccumulators; i++) {
             group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
                               _doingMerge);
@@ -532,9 +549,9 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             if (!inserted &&                 // is a dup
                 !pExpCtx->inMongos &&        // can't spill to disk in mongos
                 !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
+                _spilledRuns.size() < 20) {  // don't open too many FDs
 
-                _sortedFiles.push_back(spill());
+                spillPartitioned();
             }
         }
     }
@@ -548,30 +565,21 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
+            if (!_spilledRuns.empty()) {
                 _spilled = true;
                 if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
+                    spillPartitioned();
                 }
+                _spiller.waitForSpills();
+                _memoryUsageBytes = 0;
 
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
-
-                // prepare current to accumulate data
+                // prepare current to accumulate data when merging sorted runs
                 _currentAccumulators.reserve(numAccumulators);
                 for (auto&& accumulatedField : _accumulatedFields) {
                     _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
                 }
-
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
             }
+            _nextGroup = 0;
 
             // This must happen last so that, unless control gets here, we will re-enter
             // initialization after getting a GetNextResult::ResultState::kPauseExecution.
@@ -582,44 +590,140 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+intrusive_ptr<Accumulator>* DocumentSourceGroup::findOrInsertGroup(Value id, bool* inserted) {
+    const uint64_t keyHash = _groups->hash(id);
+    const size_t idSize = id.getApproximateSize();
+    const GroupHashTable::Group group = _groups->findOrInsert(std::move(id), keyHash, inserted);
+    intrusive_ptr<Accumulator>* accums = _groups->accumulators(group);
+
+    if (*inserted) {
+        _memoryUsageBytes += idSize;
+
+        // Add the accumulators
+        for (size_t i = 0; i < _accumulatedFields.size(); i++) {
+            accums[i] = _accumulatedFields[i].makeAccumulator(pExpCtx);
+        }
+    } else {
+        for (size_t i = 0; i < _accumulatedFields.size(); i++) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= accums[i]->memUsageForSorter();
+        }
     }
+    return accums;
+}
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+void DocumentSourceGroup::spillPartitioned() {
+    // Hand the groups to the spill job, which may run on another thread while '_groups' fills up
+    // again. The writer is created here so that the order of '_spilledRuns' matches the order of
+    // the spills.
+    std::shared_ptr<GroupHashTable> groups = std::move(_groups);
+    _groups = stdx::make_unique<GroupHashTable>(pExpCtx->getValueComparator(),
+                                                _accumulatedFields.size());
+    auto writer = std::make_shared<SortedFileWriter<Value, Value>>(
+        SortOptions().TempDir(pExpCtx->tempDir));
+    auto iter = std::make_shared<sorter::DeferredIterator<Value, Value>>();
+    auto partitionSizes = std::make_shared<std::vector<size_t>>(kNumSpillPartitions, 0);
+
+    _spiller.spill([groups, writer, iter, partitionSizes] {
+        // Counting sort of the groups by partition, using the hashes computed on insertion.
+        std::vector<size_t>& sizes = *partitionSizes;
+        for (GroupHashTable::Group group = 0; group < groups->size(); ++group) {
+            ++sizes[spillPartition(groups->keyHash(group))];
+        }
+        std::vector<size_t> next(kNumSpillPartitions, 0);
+        for (size_t partition = 1; partition < kNumSpillPartitions; ++partition) {
+            next[partition] = next[partition - 1] + sizes[partition - 1];
+        }
+        std::vector<GroupHashTable::Group> order(groups->size());
+        for (GroupHashTable::Group group = 0; group < groups->size(); ++group) {
+            order[next[spillPartition(groups->keyHash(group))]++] = group;
+        }
 
-    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir));
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
-            }
-            break;
+        for (auto group : order) {
+            writer->addAlreadySorted(
+                groups->key(group),
+                spilledState(groups->accumulators(group), groups->numAccumulators()));
+        }
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+        iter->reset(writer->done());
+        return writer->bytesWritten();
+    });
+
+    _spilledRuns.push_back({std::move(iter), std::move(partitionSizes)});
+}
+
+shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spillSorted() {
+    std::shared_ptr<GroupHashTable> groups = std::move(_groups);
+    _groups = stdx::make_unique<GroupHashTable>(pExpCtx->getValueComparator(),
+                                                _accumulatedFields.size());
+    auto writer = std::make_shared<SortedFileWriter<Value, Value>>(
+        SortOptions().TempDir(pExpCtx->tempDir));
+    auto iter = std::make_shared<sorter::DeferredIterator<Value, Value>>();
+
+    // The ExpressionContext owns the collator used by the comparator.
+    _spiller.spill([ groups, writer, iter, expCtx = pExpCtx ] {
+        std::vector<GroupHashTable::Group> order(groups->size());
+        std::iota(order.begin(), order.end(), 0);
+        const ValueComparator& comparator = expCtx->getValueComparator();
+        std::stable_sort(order.begin(), order.end(), [&](auto lhs, auto rhs) {
+            return comparator.evaluate(groups->key(lhs) < groups->key(rhs));
+        });
+
+        for (auto group : order) {
+            writer->addAlreadySorted(
+                groups->key(group),
+                spilledState(groups->accumulators(group), groups->numAccumulators()));
+        }
+
+        iter->reset(writer->done());
+        return writer->bytesWritten();
+    });
+
+    return iter;
+}
+
+void DocumentSourceGroup::loadPartition(size_t partition) {
+    _groups->clear();
+    _nextGroup = 0;
+    _memoryUsageBytes = 0;
+
+    const size_t numAccumulators = _accumulatedFields.size();
+    const size_t spillThreshold =
+        _allowDiskUse ? _spiller.spillThreshold(_maxMemoryUsageBytes) : _maxMemoryUsageBytes;
+    for (auto&& run : _spilledRuns) {
+        for (size_t n = (*run.partitionSizes)[partition]; n > 0; --n) {
+            if (_memoryUsageBytes > spillThreshold) {
+                // The partition does not fit in memory, merge it by sorting instead.
+                _sortedFiles.push_back(spillSorted());
+                _memoryUsageBytes = 0;
             }
-            break;
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
-                }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+            auto data = run.iterator->next();
+            bool inserted;
+            intrusive_ptr<Accumulator>* group = findOrInsertGroup(std::move(data.first), &inserted);
+            mergeSpilledState(data.second, group, numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _memoryUsageBytes += group[i]->memUsageForSorter();
             }
-            break;
+        }
     }
 
-    _groups->clear();
+    if (_sortedFiles.empty()) {
+        return;
+    }
+
+    if (!_groups->empty()) {
+        _sortedFiles.push_back(spillSorted());
+    }
+    _spiller.waitForSpills();
+    _memoryUsageBytes = 0;
 
-    return shared_ptr<Sorter<Value, Value>::Iterator>(writer.done());
+    _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+        _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+    _sortedFiles.clear();
+
+    verify(_sorterIterator->more());  // we put data in, we should get something out.
+    _firstPartOfNextGroup = _sorterIterator->next();
 }
 
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
@@ -695,27 +799,24 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // Spilled groups are returned one hash partition at a time, so only a streaming $group has an
+    // output order.
+    if (!_streaming) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
     BSONObjBuilder sortOrder;
 
     if (_idFieldNames.empty()) {
-        if (_spilled) {
-            sortOrder.append("_id", 1);
-        } else {
-            // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
-            // get the sort order out of it.
-            if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
-                FieldPath _idSort = obj->getFieldPath();
-
-                sortOrder.append(
-                    "_id",
-                    _inputSort.getIntField(_idSort.getFieldName(_idSort.getPathLength() - 1)));
-            }
+        // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
+        // get the sort order out of it.
+        if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
+            FieldPath _idSort = obj->getFieldPath();
+
+            sortOrder.append(
+                "_id", _inputSort.getIntField(_idSort.getFieldName(_idSort.getPathLength() - 1)));
         }
-    } else if (_streaming) {
+    } else {
         // At this point, we know that _streaming is true, so _id must have only contained
         // ExpressionObjects, ExpressionConstants or ExpressionFieldPaths. We now process each
         // '_idExpression'.
@@ -749,21 +850,6 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
 
             sortOrder.append(itr->second, _inputSort.getIntField(sortString));
         }
-    } else {
-        // We are blocking and have spilled to disk.
-        std::vector<std::string> outputSort;
-        for (size_t i = 0; i < _idFieldNames.size(); i++) {
-            intrusive_ptr<Expression> exp = _idExpressions[i];
-            if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
-                // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
-                getFieldPathListForSpilled(obj, "_id." + _idFieldNames[i], &outputSort);
-            } else {
-                outputSort.push_back("_id." + _idFieldNames[i]);
-            }
-        }
-        for (auto&& field : outputSort) {
-            sortOrder.append(field, 1);
-        }
     }
 
     return allPrefixes(sortOrder.obj());
@@ -806,7 +892,7 @@ Value DocumentSourceGroup::expandId(const Value& val) {
 }
 
 Document DocumentSourceGroup::makeDocument(const Value& id,
-                                           const Accumulators& accums,
+                                           const intrusive_ptr<Accumulator>* accums,
                                            bool mergeableOutput) {
     const size_t n = _accumulatedFields.size();
     MutableDocument out(1 + n);
@@ -34,6 +34,7 @@
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/group_hash_table.h"
 #include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
@@ -41,10 +42,16 @@ namespace mongo {
 class DocumentSourceGroup final : public DocumentSource, public NeedsMergerDocumentSource {
 public:
     using Accumulators = std::vector<boost::intrusive_ptr<Accumulator>>;
-    using GroupsMap = ValueUnorderedMap<Accumulators>;
 
     static const size_t kDefaultMaxMemoryUsageBytes = 100 * 1024 * 1024;
 
+    /**
+     * Spilled groups are partitioned by the top bits of their key hash, so that each partition can
+     * be merged on its own once all input has been consumed.
+     */
+    static constexpr size_t kSpillPartitionBits = 4;
+    static constexpr size_t kNumSpillPartitions = size_t(1) << kSpillPartitionBits;
+
     // Virtuals from DocumentSource.
     boost::intrusive_ptr<DocumentSource> optimize() final;
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
@@ -110,6 +117,15 @@ private:
     explicit DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext>& pExpCtx,
                                  size_t maxMemoryUsageBytes = kDefaultMaxMemoryUsageBytes);
 
+    /**
+     * The groups of one spill, written to a single file in partition order.
+     */
+    struct SpilledRun {
+        std::shared_ptr<Sorter<Value, Value>::Iterator> iterator;
+        // Number of groups of each partition, set by the spill job.
+        std::shared_ptr<std::vector<size_t>> partitionSizes;
+    };
+
     /**
      * getNext() dispatches to one of these three depending on what type of $group it is. All three
      * of these methods expect '_currentAccumulators' to have been reset before being called, and
@@ -119,6 +135,11 @@ private:
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Returns the next group merged from '_sorterIterator', which is reset once it is exhausted.
+     */
+    GetNextResult getNextMerged();
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -138,13 +159,35 @@ private:
     GetNextResult initialize();
 
     /**
-     * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
-     * does not exhaust the previous stage before returning, and thus does not maintain as large a
-     * store of documents at any one time, only an unsorted group can spill to disk.
+     * Hands the groups to '_spiller', which writes them to a file partitioned by key hash, and
+     * adds the file to '_spilledRuns'. The file may only be read after '_spiller' waited for the
+     * spills. Note: Since a sorted $group does not exhaust the previous stage before returning,
+     * and thus does not maintain as large a store of documents at any one time, only an unsorted
+     * group can spill to disk.
+     */
+    void spillPartitioned();
+
+    /**
+     * Like spillPartitioned(), but writes the groups sorted by key for a merge through
+     * '_sorterIterator'. Used when a single partition does not fit in memory.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    std::shared_ptr<Sorter<Value, Value>::Iterator> spillSorted();
 
-    Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
+    /**
+     * Merges the groups of 'partition' from all spilled runs into '_groups', falling back to a
+     * sort-based merge if they exceed the memory limit.
+     */
+    void loadPartition(size_t partition);
+
+    /**
+     * Adds a group to '_groups' with fresh accumulators, or finds the existing one, keeping
+     * '_memoryUsageBytes' up to date for the key.
+     */
+    boost::intrusive_ptr<Accumulator>* findOrInsertGroup(Value id, bool* inserted);
+
+    Document makeDocument(const Value& id,
+                          const boost::intrusive_ptr<Accumulator>* accums,
+                          bool mergeableOutput);
 
     /**
      * Computes the internal representation of the group key.
@@ -172,21 +215,26 @@ private:
     Value _currentId;
     Accumulators _currentAccumulators;
 
-    // We use boost::optional to defer initialization until the ExpressionContext containing the
-    // correct comparator is injected, since the groups must be built using the comparator's
+    // Created by initialize() rather than the constructor, once the ExpressionContext containing
+    // the correct comparator is injected, since the groups must be built using the comparator's
     // definition of equality.
-    boost::optional<GroupsMap> _groups;
+    std::unique_ptr<GroupHashTable> _groups;
 
-    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
-    bool _spilled;
+    // The next group of '_groups' to return.
+    GroupHashTable::Group _nextGroup = 0;
 
-    // Only used when '_spilled' is false.
-    GroupsMap::iterator groupsIterator;
+    std::vector<SpilledRun> _spilledRuns;
+    bool _spilled;
+    SpillScheduler _spiller;
 
-    // Only used when '_spilled' is true.
+    // Only used when '_spilled' is true: the next partition to load into '_groups' and, while a
+    // partition that did not fit in memory is merged, its sorted runs.
+    size_t _nextPartition = 0;
+    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     const bool _allowDiskUse;
 
+    // Only used when '_sorterIterator' is set.
     std::pair<Value, Value> _firstPartOfNextGroup;
     // Only used when '_sorted' is true.
     boost::optional<Document> _firstDocOfNextGroup;
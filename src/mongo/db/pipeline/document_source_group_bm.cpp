@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/client.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/aggregation_request.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Generates 'numDocs' documents {k: <key>, v: <int>}, with keys drawn from 'numGroups' distinct
+ * integers, without materializing the input.
+ */
+class GeneratedSource final : public DocumentSourceMock {
+public:
+    GeneratedSource(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                    long long numDocs,
+                    long long numGroups)
+        : DocumentSourceMock({}, expCtx), _numDocs(numDocs), _numGroups(numGroups) {}
+
+    GetNextResult getNext() override {
+        if (_produced == _numDocs) {
+            return GetNextResult::makeEOF();
+        }
+        ++_produced;
+        const long long key = _random.nextInt64(_numGroups);
+        return Document{{"k", key}, {"v", static_cast<int>(_produced & 0xff)}};
+    }
+
+private:
+    const long long _numDocs;
+    const long long _numGroups;
+    long long _produced = 0;
+    PseudoRandom _random{42};
+};
+
+/**
+ * Runs {$group: {_id: '$k', total: {$sum: '$v'}, n: {$sum: 1}}} over state.range(1) documents
+ * with state.range(0) distinct keys. With state.range(2) == 1 the memory limit is small enough
+ * that the stage spills.
+ */
+void BM_GroupBySum(benchmark::State& state) {
+    const long long numGroups = state.range(0);
+    const long long numDocs = state.range(1);
+    const bool spill = state.range(2) == 1;
+
+    auto client = getGlobalServiceContext()->makeClient("BM_GroupBySum");
+    auto opCtx = client->makeOperationContext();
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest(
+        opCtx.get(), AggregationRequest(NamespaceString("test.group_bm"), {})));
+    unittest::TempDir tempDir("DocumentSourceGroupBM");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = spill;
+    const size_t maxMemoryUsageBytes = spill ? 16 * 1024 * 1024 : size_t(16) * 1024 * 1024 * 1024;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    const std::vector<AccumulationStatement> accumulators{
+        {"total",
+         ExpressionFieldPath::parse(expCtx, "$v", vps),
+         AccumulationStatement::getFactory("$sum")},
+        {"n",
+         ExpressionConstant::create(expCtx, Value(1)),
+         AccumulationStatement::getFactory("$sum")}};
+
+    long long outputGroups = 0;
+    for (auto keepRunning : state) {
+        boost::intrusive_ptr<GeneratedSource> source(
+            new GeneratedSource(expCtx, numDocs, numGroups));
+        auto group = DocumentSourceGroup::create(expCtx,
+                                                 ExpressionFieldPath::parse(expCtx, "$k", vps),
+                                                 accumulators,
+                                                 maxMemoryUsageBytes);
+        group->setSource(source.get());
+        for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+            benchmark::DoNotOptimize(result);
+            ++outputGroups;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * numDocs);
+    state.counters["groups"] = static_cast<double>(outputGroups) / state.iterations();
+}
+
+BENCHMARK(BM_GroupBySum)
+    ->ArgNames({"groups", "docs", "spill"})
+    ->Args({1000, 1000 * 1000, 0})
+    ->Args({1000 * 1000, 4 * 1000 * 1000, 0})
+    ->Args({1000 * 1000, 4 * 1000 * 1000, 1})
+    ->Args({10 * 1000 * 1000, 20 * 1000 * 1000, 0})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mongo
@@ -50,6 +50,7 @@
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
@@ -139,6 +140,49 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldMergeGroupsAcrossManySpills) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    VariablesParseState vps = expCtx->variablesParseState;
+    AccumulationStatement countStatement{"count",
+                                         ExpressionConstant::create(expCtx, Value(1)),
+                                         AccumulationStatement::getFactory("$sum")};
+    auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$_id", vps);
+    auto group = DocumentSourceGroup::create(
+        expCtx, groupByExpression, {countStatement}, maxMemoryUsageBytes);
+
+    // Every key is seen once per pass, so each of its groups is spilled more than once. The
+    // partitions are larger than the memory limit and have to be merged as sorted runs.
+    const int kNumGroups = 1000;
+    const int kNumPasses = 3;
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int pass = 0; pass < kNumPasses; ++pass) {
+        for (int id = 0; id < kNumGroups; ++id) {
+            inputs.emplace_back(Document{{"_id", id}});
+        }
+    }
+    auto mock = DocumentSourceMock::create(inputs);
+    group->setSource(mock.get());
+
+    stdx::unordered_map<int, int> counts;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_TRUE(counts.emplace(doc["_id"].coerceToInt(), doc["count"].coerceToInt()).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+
+    ASSERT_EQ(counts.size(), size_t(kNumGroups));
+    for (auto&& idAndCount : counts) {
+        ASSERT_EQ(idAndCount.second, kNumPasses);
+    }
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
@@ -63,6 +63,17 @@ std::string pipelineToString(const vector<BSONObj>& pipeline) {
     sb << "]";
     return sb.str();
 }
+
+// Storage engines that do not track data sizes report 0 for a non-empty collection. Its size is
+// then estimated from the record count at this many bytes per document.
+constexpr long long kAssumedBytesPerRecord = 1024;
+
+long long estimatedDataSizeBytes(const MongoProcessInterface::CollectionSizeEstimate& estimate) {
+    if (estimate.dataSizeBytes > 0 || estimate.numRecords <= 0) {
+        return estimate.dataSizeBytes;
+    }
+    return estimate.numRecords * kAssumedBytesPerRecord;
+}
 }  // namespace
 
 constexpr size_t DocumentSourceLookUp::kMaxSubPipelineDepth;
@@ -203,6 +214,18 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
 
 }  // namespace
 
+StringData DocumentSourceLookUp::joinStrategyName(JoinStrategy strategy) {
+    switch (strategy) {
+        case JoinStrategy::kPerDocument:
+            return "perDocument"_sd;
+        case JoinStrategy::kHashJoin:
+            return "hashJoin"_sd;
+        case JoinStrategy::kBatchedProbe:
+            return "batchedProbe"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     pExpCtx->checkForInterrupt();
 
@@ -210,13 +233,244 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
         return unwindResult();
     }
 
+    if (!_joinStrategy) {
+        _batchSize = std::max(internalDocumentSourceLookupBatchSize.load(), 1);
+        if (!canJoinInBatches()) {
+            _joinStrategy = JoinStrategy::kPerDocument;
+        } else {
+            // Look at how much input there is before committing to a strategy: a single input
+            // document is best served by its own query.
+            auto batch = readInputBatch();
+            if (batch.empty()) {
+                return nextBufferedResult();
+            }
+            _joinStrategy = chooseJoinStrategy(batch.size());
+            joinFirstBatch(std::move(batch));
+        }
+    }
+
+    if (!_batchOutput.empty() || _batchEndResult) {
+        return nextBufferedResult();
+    }
+
+    switch (*_joinStrategy) {
+        case JoinStrategy::kHashJoin:
+            return getNextHashJoin();
+        case JoinStrategy::kBatchedProbe:
+            return getNextBatchedProbe();
+        case JoinStrategy::kPerDocument:
+            break;
+    }
+
     auto nextInput = pSource->getNext();
     if (!nextInput.isAdvanced()) {
         return nextInput;
     }
 
     auto inputDoc = nextInput.releaseDocument();
+    auto results = lookUpWithPipeline(inputDoc);
+    return makeOutput(std::move(inputDoc), std::move(results));
+}
+
+bool DocumentSourceLookUp::canJoinInBatches() const {
+    if (wasConstructedWithPipelineSyntax() || _unwindSrc ||
+        !LookUpJoinTable::canIndexPath(*_foreignField) || !pExpCtx->opCtx || _batchSize <= 1) {
+        return false;
+    }
+    // Without statistics (on mongos), stay with the query per document.
+    return static_cast<bool>(
+        pExpCtx->mongoProcessInterface->estimateCollectionSize(pExpCtx->opCtx, _resolvedNs));
+}
+
+DocumentSourceLookUp::JoinStrategy DocumentSourceLookUp::chooseJoinStrategy(
+    size_t numInputs) const {
+    if (numInputs <= 1) {
+        return JoinStrategy::kPerDocument;
+    }
+
+    // Reading the whole foreign collection only pays off when the input fills a batch, and not
+    // when every lookup would be an index seek anyway.
+    if (numInputs >= _batchSize) {
+        const auto estimate =
+            pExpCtx->mongoProcessInterface->estimateCollectionSize(pExpCtx->opCtx, _resolvedNs);
+        if (estimate &&
+            estimatedDataSizeBytes(*estimate) <=
+                internalDocumentSourceLookupHashJoinMaxBytes.load() &&
+            !pExpCtx->mongoProcessInterface->hasIndexWithLeadingField(
+                pExpCtx->opCtx, _resolvedNs, _foreignField->fullPath())) {
+            return JoinStrategy::kHashJoin;
+        }
+    }
+    return JoinStrategy::kBatchedProbe;
+}
+
+std::vector<Document> DocumentSourceLookUp::readInputBatch() {
+    std::vector<Document> batch;
+    while (batch.size() < _batchSize) {
+        auto nextInput = pSource->getNext();
+        if (!nextInput.isAdvanced()) {
+            // Return the pause or EOF after the output of the batch.
+            _batchEndResult = std::move(nextInput);
+            break;
+        }
+        batch.push_back(nextInput.releaseDocument());
+    }
+    return batch;
+}
+
+DocumentSource::GetNextResult DocumentSourceLookUp::nextBufferedResult() {
+    if (!_batchOutput.empty()) {
+        auto output = std::move(_batchOutput.front());
+        _batchOutput.pop_front();
+        return std::move(output);
+    }
+
+    invariant(_batchEndResult);
+    auto result = std::move(*_batchEndResult);
+    _batchEndResult = boost::none;
+    return result;
+}
+
+void DocumentSourceLookUp::joinFirstBatch(std::vector<Document> batch) {
+    switch (*_joinStrategy) {
+        case JoinStrategy::kHashJoin:
+            // Read the whole foreign collection, through the pipeline of a view if it is one.
+            _joinTable = stdx::make_unique<LookUpJoinTable>(_fromExpCtx->getValueComparator(),
+                                                            *_foreignField);
+            if (fillJoinTable(BSON("$match" << BSONObj()),
+                              internalDocumentSourceLookupHashJoinMaxBytes.load(),
+                              _joinTable.get())) {
+                for (auto&& inputDoc : batch) {
+                    _batchOutput.push_back(probeJoinTable(std::move(inputDoc)));
+                }
+                return;
+            }
+            // The collection has grown past the statistics it was chosen by. Rather than spilling
+            // it, which would reorder our output, resolve the join keys with queries.
+            _joinTable.reset();
+            _joinStrategy = JoinStrategy::kBatchedProbe;
+            joinBatch(std::move(batch));
+            return;
+        case JoinStrategy::kBatchedProbe:
+            joinBatch(std::move(batch));
+            return;
+        case JoinStrategy::kPerDocument:
+            for (auto&& inputDoc : batch) {
+                auto results = lookUpWithPipeline(inputDoc);
+                _batchOutput.push_back(makeOutput(std::move(inputDoc), std::move(results)));
+            }
+            return;
+    }
+    MONGO_UNREACHABLE;
+}
+
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextHashJoin() {
+    auto nextInput = pSource->getNext();
+    if (!nextInput.isAdvanced()) {
+        return nextInput;
+    }
+    return probeJoinTable(nextInput.releaseDocument());
+}
 
+Document DocumentSourceLookUp::probeJoinTable(Document inputDoc) {
+    std::vector<Value> joinKeys;
+    if (!collectJoinKeys(inputDoc, &joinKeys)) {
+        auto results = lookUpWithPipeline(inputDoc);
+        return makeOutput(std::move(inputDoc), std::move(results));
+    }
+
+    std::vector<Document> matches;
+    _joinTable->probe(joinKeys, &matches);
+    return makeOutput(std::move(inputDoc), matches);
+}
+
+DocumentSource::GetNextResult DocumentSourceLookUp::getNextBatchedProbe() {
+    auto batch = readInputBatch();
+    if (!batch.empty()) {
+        joinBatch(std::move(batch));
+    }
+    return nextBufferedResult();
+}
+
+void DocumentSourceLookUp::joinBatch(std::vector<Document> batch) {
+    // Gather the distinct join keys of the batch, leaving documents we cannot probe for with keys
+    // (or that would make the query too large) to the per-document pipeline.
+    const size_t kMaxJoinKeysBytes = BSONObjMaxUserSize / 2;
+    std::vector<std::vector<Value>> joinKeys(batch.size());
+    std::vector<bool> canProbe(batch.size(), false);
+    auto distinctKeys = _fromExpCtx->getValueComparator().makeUnorderedValueSet();
+    BSONArrayBuilder inValues;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!collectJoinKeys(batch[i], &joinKeys[i])) {
+            continue;
+        }
+        size_t keysBytes = 0;
+        for (auto&& joinKey : joinKeys[i]) {
+            keysBytes += joinKey.getApproximateSize();
+        }
+        if (inValues.len() + keysBytes > kMaxJoinKeysBytes) {
+            continue;
+        }
+        canProbe[i] = true;
+        for (auto&& joinKey : joinKeys[i]) {
+            if (distinctKeys.insert(joinKey).second) {
+                inValues << joinKey;
+            }
+        }
+    }
+
+    LookUpJoinTable table(_fromExpCtx->getValueComparator(), *_foreignField);
+    bool tableIsComplete = false;
+    if (!distinctKeys.empty()) {
+        auto matchStage =
+            BSON("$match" << BSON(_foreignField->fullPath() << BSON("$in" << inValues.arr())));
+        tableIsComplete = fillJoinTable(
+            std::move(matchStage), internalDocumentSourceLookupHashJoinMaxBytes.load(), &table);
+        if (!tableIsComplete) {
+            table.clear();
+        }
+    }
+
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (canProbe[i] && tableIsComplete) {
+            std::vector<Document> matches;
+            table.probe(joinKeys[i], &matches);
+            _batchOutput.push_back(makeOutput(std::move(batch[i]), matches));
+        } else {
+            auto results = lookUpWithPipeline(batch[i]);
+            _batchOutput.push_back(makeOutput(std::move(batch[i]), std::move(results)));
+        }
+    }
+}
+
+bool DocumentSourceLookUp::collectJoinKeys(const Document& inputDoc,
+                                           std::vector<Value>* joinKeys) const {
+    bool canProbe = true;
+    document_path_support::visitAllValuesAtPath(inputDoc, *_localField, [&](const Value& value) {
+        canProbe = canProbe && LookUpJoinTable::canProbe(value);
+        joinKeys->push_back(value);
+    });
+    // Missing values are joined as null.
+    return canProbe && !joinKeys->empty();
+}
+
+bool DocumentSourceLookUp::fillJoinTable(BSONObj matchStage,
+                                         size_t maxBytes,
+                                         LookUpJoinTable* table) {
+    // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
+    _resolvedPipeline.back() = std::move(matchStage);
+    auto pipeline = buildPipeline(Document());
+
+    while (auto result = pipeline->getNext()) {
+        table->insert(std::move(*result));
+        if (table->approximateSizeBytes() > maxBytes) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<Value> DocumentSourceLookUp::lookUpWithPipeline(const Document& inputDoc) {
     // If we have not absorbed a $unwind, we cannot absorb a $match. If we have absorbed a $unwind,
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
@@ -243,12 +497,33 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
                 objsize <= BSONObjMaxInternalSize);
         results.emplace_back(std::move(*result));
     }
+    return results;
+}
 
+Document DocumentSourceLookUp::makeOutput(Document inputDoc, std::vector<Value> matches) {
     MutableDocument output(std::move(inputDoc));
-    output.setNestedField(_as, Value(std::move(results)));
+    output.setNestedField(_as, Value(std::move(matches)));
     return output.freeze();
 }
 
+Document DocumentSourceLookUp::makeOutput(Document inputDoc,
+                                          const std::vector<Document>& matches) {
+    std::vector<Value> results;
+    results.reserve(matches.size());
+    int objsize = 0;
+    for (auto&& match : matches) {
+        objsize += match.getApproximateSize();
+        uassert(4568,
+                str::stream() << "Total size of documents in " << _fromNs.coll()
+                              << " matching "
+                              << _foreignField->fullPath()
+                              << " exceeds maximum document size",
+                objsize <= BSONObjMaxInternalSize);
+        results.emplace_back(match);
+    }
+    return makeOutput(std::move(inputDoc), std::move(results));
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -433,6 +708,8 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _joinTable.reset();
+    _batchOutput.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
@@ -653,6 +930,11 @@ void DocumentSourceLookUp::serializeToArray(
                           << (indexPath ? Value(indexPath->fullPath()) : Value())));
         }
 
+        // The strategy depends on the input, so it is only known once the stage has run.
+        if (!wasConstructedWithPipelineSyntax() && _joinStrategy) {
+            output[getSourceName()]["strategy"] = Value(joinStrategyName(*_joinStrategy));
+        }
+
         // Only add _matchSrc for explain when $lookup was constructed with localField/foreignField
         // syntax. For pipeline sytax, _matchSrc will be included as part of the pipeline
         // definition.
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <deque>
 
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_match.h"
@@ -36,6 +37,7 @@
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
+#include "mongo/db/pipeline/lookup_join_table.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
 
@@ -49,6 +51,22 @@ class DocumentSourceLookUp final : public DocumentSource, public NeedsMergerDocu
 public:
     static constexpr size_t kMaxSubPipelineDepth = 20;
 
+    /**
+     * How a $lookup specified with localField/foreignField syntax finds the foreign documents of
+     * its input documents.
+     */
+    enum class JoinStrategy {
+        // Queries the foreign collection for every input document.
+        kPerDocument,
+        // Reads the foreign collection into a LookUpJoinTable once and probes it.
+        kHashJoin,
+        // Queries the foreign collection with the join keys of a batch of input documents at once
+        // and probes the results.
+        kBatchedProbe,
+    };
+
+    static StringData joinStrategyName(JoinStrategy strategy);
+
     class LiteParsed final : public LiteParsedDocumentSource {
     public:
         static std::unique_ptr<LiteParsed> parse(const AggregationRequest& request,
@@ -187,6 +205,10 @@ public:
         return buildPipeline(inputDoc);
     }
 
+    boost::optional<JoinStrategy> getJoinStrategy_forTest() const {
+        return _joinStrategy;
+    }
+
 protected:
     void doDispose() final;
 
@@ -244,6 +266,70 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Returns true if the stage may join its input in batches: a localField/foreignField join
+     * without an absorbed $unwind, on a process that has statistics about the foreign collection.
+     */
+    bool canJoinInBatches() const;
+
+    /**
+     * Picks the join strategy once the first 'numInputs' input documents are buffered. One input
+     * document is joined with its own query. A full batch of input is joined through a hash table
+     * over the foreign collection if that is small and not indexed on the foreign field, and any
+     * other input with batched probes.
+     */
+    JoinStrategy chooseJoinStrategy(size_t numInputs) const;
+
+    /**
+     * Reads up to '_batchSize' documents from our source. A pause or EOF that ends the batch early
+     * is kept in '_batchEndResult'.
+     */
+    std::vector<Document> readInputBatch();
+
+    /**
+     * Returns the next document of '_batchOutput', or the result that ended its batch.
+     */
+    GetNextResult nextBufferedResult();
+
+    /**
+     * Joins the documents buffered to choose the strategy with it, building the hash table if
+     * there is one, and queues the output in '_batchOutput'.
+     */
+    void joinFirstBatch(std::vector<Document> batch);
+
+    GetNextResult getNextHashJoin();
+    GetNextResult getNextBatchedProbe();
+
+    Document probeJoinTable(Document inputDoc);
+
+    /**
+     * Joins each document of 'batch' and queues the output in '_batchOutput'.
+     */
+    void joinBatch(std::vector<Document> batch);
+
+    /**
+     * Collects the values of the local field of 'inputDoc' into 'joinKeys'. Returns false if a
+     * LookUpJoinTable cannot be probed with them.
+     */
+    bool collectJoinKeys(const Document& inputDoc, std::vector<Value>* joinKeys) const;
+
+    /**
+     * Runs the foreign pipeline with 'matchStage' as its last stage and inserts its results into
+     * 'table'. Returns false, leaving 'table' partially filled, once the table exceeds 'maxBytes'.
+     */
+    bool fillJoinTable(BSONObj matchStage, size_t maxBytes, LookUpJoinTable* table);
+
+    /**
+     * Returns the foreign documents matching 'inputDoc' by running the foreign pipeline.
+     */
+    std::vector<Value> lookUpWithPipeline(const Document& inputDoc);
+
+    /**
+     * Returns 'inputDoc' with 'matches' in the 'as' field.
+     */
+    Document makeOutput(Document inputDoc, std::vector<Value> matches);
+    Document makeOutput(Document inputDoc, const std::vector<Document>& matches);
+
     /**
      * Copies 'vars' and 'vps' to the Variables and VariablesParseState objects in 'expCtx'. These
      * copies provide access to 'let' defined variables in sub-pipeline execution.
@@ -332,6 +418,17 @@ private:
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
+
+    // Chosen on the first call to getNext(), from the input documents it buffers. The hash join
+    // downgrades itself to a batched probe if the foreign collection does not fit in memory.
+    boost::optional<JoinStrategy> _joinStrategy;
+    size_t _batchSize = 1;
+    std::unique_ptr<LookUpJoinTable> _joinTable;
+
+    // Output of the current batch, and the result from our source that ended the batch early, if
+    // any.
+    std::deque<Document> _batchOutput;
+    boost::optional<GetNextResult> _batchEndResult;
 };
 
 }  // namespace mongo
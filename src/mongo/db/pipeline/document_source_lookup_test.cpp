@@ -35,6 +35,7 @@
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/json.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/document_source_lookup.h"
@@ -490,18 +491,32 @@ TEST(MakeMatchStageFromInput, ArrayValueWithRegexUsesOrQuery) {
 class MockMongoInterface final : public StubMongoProcessInterface {
 public:
     MockMongoInterface(deque<DocumentSource::GetNextResult> mockResults,
-                       bool removeLeadingQueryStages = false)
+                       bool removeLeadingQueryStages = false,
+                       boost::optional<CollectionSizeEstimate> sizeEstimate = boost::none)
         : _mockResults(std::move(mockResults)),
-          _removeLeadingQueryStages(removeLeadingQueryStages) {}
+          _removeLeadingQueryStages(removeLeadingQueryStages),
+          _sizeEstimate(sizeEstimate) {}
 
     bool isSharded(OperationContext* opCtx, const NamespaceString& ns) final {
         return false;
     }
 
+    boost::optional<CollectionSizeEstimate> estimateCollectionSize(
+        OperationContext* opCtx, const NamespaceString& nss) const final {
+        return _sizeEstimate;
+    }
+
+    bool hasIndexWithLeadingField(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  StringData fieldPath) const final {
+        return foreignFieldIndexed;
+    }
+
     StatusWith<std::unique_ptr<Pipeline, PipelineDeleter>> makePipeline(
         const std::vector<BSONObj>& rawPipeline,
         const boost::intrusive_ptr<ExpressionContext>& expCtx,
         const MakePipelineOptions opts) final {
+        ++numPipelinesMade;
         auto pipeline = Pipeline::parse(rawPipeline, expCtx);
         if (!pipeline.isOK()) {
             return pipeline.getStatus();
@@ -532,9 +547,13 @@ public:
         return Status::OK();
     }
 
+    int numPipelinesMade = 0;
+    bool foreignFieldIndexed = false;
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    boost::optional<CollectionSizeEstimate> _sizeEstimate;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -588,6 +607,225 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
     lookup->dispose();
 }
 
+/**
+ * Runs {$lookup: {from: 'foreign', localField: 'x', foreignField: 'a', as: 'joined'}} over
+ * 'localInputs' against a foreign collection of 'foreignDocs' with size 'sizeEstimate', checking
+ * that pauses are propagated and that the output matches the per-document strategy's.
+ */
+class DocumentSourceLookUpJoinStrategyTest : public DocumentSourceLookUpTest {
+protected:
+    using JoinStrategy = DocumentSourceLookUp::JoinStrategy;
+    using CollectionSizeEstimate = MongoProcessInterface::CollectionSizeEstimate;
+
+    void setUp() override {
+        DocumentSourceLookUpTest::setUp();
+        _originalBatchSize = internalDocumentSourceLookupBatchSize.load();
+        _originalHashJoinMaxBytes = internalDocumentSourceLookupHashJoinMaxBytes.load();
+    }
+
+    void tearDown() override {
+        internalDocumentSourceLookupBatchSize.store(_originalBatchSize);
+        internalDocumentSourceLookupHashJoinMaxBytes.store(_originalHashJoinMaxBytes);
+        DocumentSourceLookUpTest::tearDown();
+    }
+
+    intrusive_ptr<DocumentSourceLookUp> makeLookUp(
+        boost::optional<CollectionSizeEstimate> sizeEstimate) {
+        auto expCtx = getExpCtx();
+        NamespaceString fromNs("test", "foreign");
+        expCtx->setResolvedNamespace_forTest(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+        auto lookupSpec = BSON("$lookup" << BSON("from"
+                                                 << "foreign"
+                                                 << "localField"
+                                                 << "x"
+                                                 << "foreignField"
+                                                 << "a"
+                                                 << "as"
+                                                 << "joined"));
+        auto lookup = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+
+        deque<DocumentSource::GetNextResult> foreignDocs{Document(fromjson("{_id: 0, a: 1}")),
+                                                         Document(fromjson("{_id: 1, a: [1, 2]}")),
+                                                         Document(fromjson("{_id: 2, a: 3}")),
+                                                         Document(fromjson("{_id: 3}"))};
+        _processInterface = std::make_shared<MockMongoInterface>(
+            std::move(foreignDocs), false, sizeEstimate);
+        expCtx->mongoProcessInterface = _processInterface;
+
+        return static_cast<DocumentSourceLookUp*>(lookup.get());
+    }
+
+    /**
+     * Joins a fixed input, with a pause in the middle, and checks the output.
+     */
+    void assertJoinsInput(DocumentSourceLookUp* lookup) {
+        auto localSource =
+            DocumentSourceMock::create({Document(fromjson("{x: 1}")),
+                                        Document(fromjson("{x: [2, 3]}")),
+                                        DocumentSource::GetNextResult::makePauseExecution(),
+                                        Document(fromjson("{y: 1}")),
+                                        Document(fromjson("{x: 4}")),
+                                        Document(fromjson("{x: [1, 1]}"))});
+        lookup->setSource(localSource.get());
+
+        auto assertNext = [&](const char* expected) {
+            auto next = lookup->getNext();
+            ASSERT_TRUE(next.isAdvanced());
+            ASSERT_DOCUMENT_EQ(next.releaseDocument(), Document(fromjson(expected)));
+        };
+
+        assertNext("{x: 1, joined: [{_id: 0, a: 1}, {_id: 1, a: [1, 2]}]}");
+        assertNext("{x: [2, 3], joined: [{_id: 1, a: [1, 2]}, {_id: 2, a: 3}]}");
+        ASSERT_TRUE(lookup->getNext().isPaused());
+        // A missing local field joins with missing foreign fields, which is left to the query.
+        assertNext("{y: 1, joined: [{_id: 3}]}");
+        assertNext("{x: 4, joined: []}");
+        assertNext("{x: [1, 1], joined: [{_id: 0, a: 1}, {_id: 1, a: [1, 2]}]}");
+        ASSERT_TRUE(lookup->getNext().isEOF());
+        ASSERT_TRUE(lookup->getNext().isEOF());
+        lookup->dispose();
+    }
+
+    std::shared_ptr<MockMongoInterface> _processInterface;
+
+private:
+    int _originalBatchSize;
+    int _originalHashJoinMaxBytes;
+};
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, QueriesPerDocumentWithoutCollectionStatistics) {
+    auto lookup = makeLookUp(boost::none);
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kPerDocument);
+    ASSERT_EQ(_processInterface->numPipelinesMade, 5);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, QueriesPerDocumentForSingleInputDocument) {
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 4;
+    estimate.dataSizeBytes = 100;
+    auto lookup = makeLookUp(estimate);
+
+    auto localSource = DocumentSourceMock::create({Document(fromjson("{x: 3}"))});
+    lookup->setSource(localSource.get());
+    auto next = lookup->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.releaseDocument(),
+                       Document(fromjson("{x: 3, joined: [{_id: 2, a: 3}]}")));
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+
+    // A small foreign collection is not read whole for one input document.
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kPerDocument);
+    ASSERT_EQ(_processInterface->numPipelinesMade, 1);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, HashJoinsSmallForeignCollection) {
+    // The two documents before the pause fill the first batch.
+    internalDocumentSourceLookupBatchSize.store(2);
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 4;
+    estimate.dataSizeBytes = 100;
+    auto lookup = makeLookUp(estimate);
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kHashJoin);
+    // One scan of the foreign collection, and one query for the document without a join key.
+    ASSERT_EQ(_processInterface->numPipelinesMade, 2);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, ProbesIndexedForeignFieldInBatches) {
+    internalDocumentSourceLookupBatchSize.store(2);
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 4;
+    estimate.dataSizeBytes = 100;
+    auto lookup = makeLookUp(estimate);
+    _processInterface->foreignFieldIndexed = true;
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kBatchedProbe);
+    // One query for each of the three batches, and one for the document without a join key.
+    ASSERT_EQ(_processInterface->numPipelinesMade, 4);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, ProbesInBatchesIfInputDoesNotFillBatch) {
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 4;
+    estimate.dataSizeBytes = 100;
+    auto lookup = makeLookUp(estimate);
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kBatchedProbe);
+    // The pause ends the first batch early. The second batch needs one query for its join keys
+    // and one for the document without a join key.
+    ASSERT_EQ(_processInterface->numPipelinesMade, 3);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, ProbesLargeForeignCollectionInBatches) {
+    internalDocumentSourceLookupBatchSize.store(2);
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 1000 * 1000;
+    estimate.dataSizeBytes = 1024LL * 1024 * 1024;
+    auto lookup = makeLookUp(estimate);
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kBatchedProbe);
+    ASSERT_EQ(_processInterface->numPipelinesMade, 4);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, FallsBackToBatchesIfHashTableDoesNotFit) {
+    internalDocumentSourceLookupBatchSize.store(2);
+    internalDocumentSourceLookupHashJoinMaxBytes.store(64);
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 4;
+    estimate.dataSizeBytes = 10;
+    auto lookup = makeLookUp(estimate);
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kBatchedProbe);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, EstimatesUnknownDataSizeFromRecordCount) {
+    // A storage engine without data size tracking reports 0 bytes.
+    internalDocumentSourceLookupBatchSize.store(2);
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 4;
+    estimate.dataSizeBytes = 0;
+    auto lookup = makeLookUp(estimate);
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kHashJoin);
+    ASSERT_EQ(_processInterface->numPipelinesMade, 2);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, ProbesInBatchesIfUnknownDataSizeHasManyRecords) {
+    internalDocumentSourceLookupBatchSize.store(2);
+    CollectionSizeEstimate estimate;
+    estimate.numRecords = 1000 * 1000;
+    estimate.dataSizeBytes = 0;
+    auto lookup = makeLookUp(estimate);
+    assertJoinsInput(lookup.get());
+    ASSERT(*lookup->getJoinStrategy_forTest() == JoinStrategy::kBatchedProbe);
+    ASSERT_EQ(_processInterface->numPipelinesMade, 4);
+}
+
+TEST_F(DocumentSourceLookUpJoinStrategyTest, ExplainReportsJoinStrategy) {
+    internalDocumentSourceLookupBatchSize.store(2);
+    CollectionSizeEstimate estimate;
+    auto lookup = makeLookUp(estimate);
+
+    // The strategy is only known once the stage has seen its input.
+    vector<Value> explain;
+    lookup->serializeToArray(explain, kExplain);
+    ASSERT_EQ(explain.size(), 1UL);
+    ASSERT_TRUE(explain[0]["$lookup"]["strategy"].missing());
+
+    assertJoinsInput(lookup.get());
+    explain.clear();
+    lookup->serializeToArray(explain, kExplain);
+    ASSERT_VALUE_EQ(explain[0]["$lookup"]["strategy"], Value("hashJoin"_sd));
+
+    // The strategy is not part of the stage's specification.
+    vector<Value> serialization;
+    lookup->serializeToArray(serialization);
+    ASSERT_TRUE(serialization[0]["$lookup"]["strategy"].missing());
+}
+
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/collation/collation_index_key.h"
+#include "mongo/db/sorter/normalized_key_prefix.h"
 
 namespace mongo {
 
@@ -131,12 +132,18 @@ DocumentSource::GetNextResult DocumentSourceSort::getNext() {
 void DocumentSourceSort::serializeToArray(
     std::vector<Value>& array, boost::optional<ExplainOptions::Verbosity> explain) const {
     if (explain) {  // always one Value for combined $sort + $limit
-        array.push_back(Value(DOC(
+        MutableDocument stage(DOC(
             kStageName << DOC("sortKey" << sortKeyPattern(SortKeySerialization::kForExplain)
                                         << "mergePresorted"
                                         << (_mergingPresorted ? Value(true) : Value())
                                         << "limit"
-                                        << (_limitSrc ? Value(_limitSrc->getLimit()) : Value())))));
+                                        << (_limitSrc ? Value(_limitSrc->getLimit()) : Value()))));
+        if (*explain >= ExplainOptions::Verbosity::kExecStats) {
+            BSONObjBuilder spillStats;
+            _spillStats.appendTo(&spillStats);
+            stage["spillStats"] = Value(spillStats.obj());
+        }
+        array.push_back(stage.freezeToValue());
     } else {  // one Value for $sort and maybe a Value for $limit
         MutableDocument inner(sortKeyPattern(SortKeySerialization::kForPipelineSerialization));
         if (_mergingPresorted) {
@@ -362,6 +369,7 @@ void DocumentSourceSort::loadingDone() {
         _sorter.reset(MySorter::make(makeSortOptions(), Comparator(*this)));
     }
     _output.reset(_sorter->done());
+    _spillStats = _sorter->spillStats();
     _sorter.reset();
     _populated = true;
 }
@@ -516,6 +524,52 @@ int DocumentSourceSort::compare(const Value& lhs, const Value& rhs) const {
     return 0;
 }
 
+namespace {
+/**
+ * The Value counterpart of sorter::normalizedKeyPrefix(const BSONElement&), consistent with
+ * Value::compare() under the simple collation.
+ */
+uint64_t normalizedValuePrefix(const Value& value) {
+    const BSONType type = value.getType();
+    switch (type) {
+        case NumberInt:
+        case NumberLong:
+        case NumberDouble:
+            return sorter::normalizedKeyPrefix(
+                type, sorter::normalizedNumberPayload(value.coerceToDouble()));
+        case NumberDecimal: {
+            const Decimal128 decimal = value.getDecimal();
+            return sorter::normalizedKeyPrefix(
+                type, decimal.isNaN() ? 0 : sorter::normalizedNumberPayload(decimal.toDouble()));
+        }
+        case String:
+            return sorter::normalizedKeyPrefix(
+                type, sorter::normalizedBytesPayload(value.getStringData()));
+        case Symbol:
+            return sorter::normalizedKeyPrefix(type,
+                                               sorter::normalizedBytesPayload(value.getSymbol()));
+        case jstOID: {
+            const OID oid = value.getOid();
+            return sorter::normalizedKeyPrefix(
+                type, sorter::normalizedBytesPayload(StringData(oid.view().view(), OID::kOIDSize)));
+        }
+        case Bool:
+            return sorter::normalizedKeyPrefix(type, value.getBool() ? 1ULL << 63 : 0);
+        case Date:
+            return sorter::normalizedKeyPrefix(
+                type, sorter::normalizedSignedPayload(value.getDate().toMillisSinceEpoch()));
+        default:
+            return sorter::normalizedKeyPrefix(type, 0);
+    }
+}
+}  // namespace
+
+uint64_t DocumentSourceSort::normalizedKeyPrefix(const Value& key) const {
+    // Compound sort keys are arrays with one element per component, see extractKeyFast().
+    const Value& first = _sortPattern.size() == 1 ? key : key[0];
+    return sorter::directedKeyPrefix(normalizedValuePrefix(first), _sortPattern[0].isAscending);
+}
+
 intrusive_ptr<DocumentSource> DocumentSourceSort::getShardSource() {
     verify(!_mergingPresorted);
     return this;
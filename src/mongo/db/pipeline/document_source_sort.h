@@ -166,6 +166,13 @@ private:
             return _source.compare(lhs.first, rhs.first);
         }
 
+        bool hasNormalizedKeyPrefix() const {
+            return true;
+        }
+        uint64_t normalizedKeyPrefix(const MySorter::Data& data) const {
+            return _source.normalizedKeyPrefix(data.first);
+        }
+
     private:
         const DocumentSourceSort& _source;
     };
@@ -237,6 +244,12 @@ private:
 
     int compare(const Value& lhs, const Value& rhs) const;
 
+    /**
+     * Normalized key prefix of the first component of the sort key 'key', consistent with
+     * compare(). See sorter.h.
+     */
+    uint64_t normalizedKeyPrefix(const Value& key) const;
+
     /**
      * Absorbs 'limit', enabling a top-k sort. It is safe to call this multiple times, it will keep
      * the smallest limit.
@@ -265,6 +278,7 @@ private:
     bool _mergingPresorted;  // TODO SERVER-34009 Remove this flag.
     std::unique_ptr<MySorter> _sorter;
     std::unique_ptr<MySorter::Iterator> _output;
+    SorterSpillStats _spillStats;
 };
 
 }  // namespace mongo
@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/group_hash_table.h"
+
+#include <limits>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+// The finalizer of MurmurHash3's 64-bit variant. Value hashes are built with hash_combine(),
+// whose low bits alone index a power-of-two table poorly.
+uint64_t mixHash(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+}  // namespace
+
+GroupHashTable::GroupHashTable(const ValueComparator& comparator, size_t numAccumulators)
+    : _comparator(comparator), _numAccumulators(numAccumulators), _slots(kInitialSlots) {}
+
+uint64_t GroupHashTable::hash(const Value& key) const {
+    return mixHash(_comparator.hash(key));
+}
+
+GroupHashTable::Group GroupHashTable::findOrInsert(Value key, uint64_t keyHash, bool* inserted) {
+    const uint32_t tag = hashTag(keyHash);
+    size_t mask = _slots.size() - 1;
+    for (size_t i = keyHash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = _slots[i];
+        if (slot.groupPlusOne == 0) {
+            break;
+        }
+        if (slot.hashTag == tag) {
+            const Group group = slot.groupPlusOne - 1;
+            if (_groups[group].hash == keyHash &&
+                _comparator.evaluate(_groups[group].key == key)) {
+                *inserted = false;
+                return group;
+            }
+        }
+    }
+
+    // Keep the load factor at most 1/2 so that probe sequences stay short.
+    if ((_groups.size() + 1) * 2 > _slots.size()) {
+        grow();
+        mask = _slots.size() - 1;
+    }
+
+    const Group group = _groups.size();
+    invariant(group < std::numeric_limits<uint32_t>::max());
+    if (_numAccumulators > 0 && group % kGroupsPerChunk == 0) {
+        _accumulatorChunks.emplace_back(
+            new boost::intrusive_ptr<Accumulator>[kGroupsPerChunk * _numAccumulators]);
+    }
+    _groups.push_back({std::move(key), keyHash});
+
+    size_t i = keyHash & mask;
+    while (_slots[i].groupPlusOne != 0) {
+        i = (i + 1) & mask;
+    }
+    _slots[i] = {tag, static_cast<uint32_t>(group + 1)};
+
+    *inserted = true;
+    return group;
+}
+
+void GroupHashTable::grow() {
+    std::vector<Slot> slots(_slots.size() * 2);
+    const size_t mask = slots.size() - 1;
+    for (const Slot& slot : _slots) {
+        if (slot.groupPlusOne == 0) {
+            continue;
+        }
+        size_t i = _groups[slot.groupPlusOne - 1].hash & mask;
+        while (slots[i].groupPlusOne != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = slot;
+    }
+    _slots.swap(slots);
+}
+
+void GroupHashTable::clear() {
+    std::vector<Entry>().swap(_groups);
+    _accumulatorChunks.clear();
+    std::vector<Slot>(kInitialSlots).swap(_slots);
+}
+
+}  // namespace mongo
@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/intrusive_ptr.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+
+namespace mongo {
+
+/**
+ * The hash table behind an unsorted $group, mapping each group key to the accumulators of the
+ * group.
+ *
+ * Groups are numbered in insertion order and kept in contiguous storage together with the hash of
+ * their key, so neither growing the table nor partitioning its groups hashes a key again. Lookups
+ * go through an open-addressing index of 8-byte slots, probed linearly, which holds the group
+ * number and the upper half of the key hash so that most mismatches are rejected without
+ * comparing Values. The accumulators of a group are 'numAccumulators' adjacent pointers in a
+ * chunked arena rather than a vector of their own.
+ */
+class GroupHashTable {
+    MONGO_DISALLOW_COPYING(GroupHashTable);
+
+public:
+    using Group = size_t;
+
+    GroupHashTable(const ValueComparator& comparator, size_t numAccumulators);
+
+    /**
+     * Hash of 'key' consistent with the comparator's notion of equality. All 64 bits are mixed, so
+     * any subset of them may be used, e.g. to partition groups.
+     */
+    uint64_t hash(const Value& key) const;
+
+    /**
+     * Returns the group of 'key', whose hash(key) is 'keyHash', adding it if there is none. The
+     * accumulators of a new group are null and must be set by the caller.
+     */
+    Group findOrInsert(Value key, uint64_t keyHash, bool* inserted);
+
+    size_t size() const {
+        return _groups.size();
+    }
+
+    bool empty() const {
+        return _groups.empty();
+    }
+
+    size_t numAccumulators() const {
+        return _numAccumulators;
+    }
+
+    const Value& key(Group group) const {
+        return _groups[group].key;
+    }
+
+    uint64_t keyHash(Group group) const {
+        return _groups[group].hash;
+    }
+
+    /**
+     * The 'numAccumulators()' accumulators of 'group'. The pointers stay valid until clear().
+     */
+    boost::intrusive_ptr<Accumulator>* accumulators(Group group) {
+        if (_numAccumulators == 0) {
+            return nullptr;
+        }
+        return _accumulatorChunks[group / kGroupsPerChunk].get() +
+            (group % kGroupsPerChunk) * _numAccumulators;
+    }
+
+    /**
+     * Removes all groups and releases their accumulators.
+     */
+    void clear();
+
+private:
+    struct Entry {
+        Value key;
+        uint64_t hash;
+    };
+
+    struct Slot {
+        uint32_t hashTag;
+        uint32_t groupPlusOne;  // 0 for an empty slot.
+    };
+
+    static constexpr size_t kGroupsPerChunk = 1024;
+    static constexpr size_t kInitialSlots = 16;
+
+    static uint32_t hashTag(uint64_t keyHash) {
+        return static_cast<uint32_t>(keyHash >> 32);
+    }
+
+    void grow();
+
+    ValueComparator _comparator;
+    const size_t _numAccumulators;
+
+    std::vector<Entry> _groups;
+    std::vector<Slot> _slots;
+    std::vector<std::unique_ptr<boost::intrusive_ptr<Accumulator>[]>> _accumulatorChunks;
+};
+
+}  // namespace mongo
@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+
+#include "mongo/db/pipeline/group_hash_table.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using boost::intrusive_ptr;
+
+GroupHashTable::Group insert(GroupHashTable* table, Value key, bool* inserted) {
+    const uint64_t keyHash = table->hash(key);
+    return table->findOrInsert(std::move(key), keyHash, inserted);
+}
+
+TEST(GroupHashTableTest, FindsInsertedGroups) {
+    GroupHashTable table(ValueComparator(), 0);
+    bool inserted;
+    ASSERT_EQ(insert(&table, Value(1), &inserted), 0U);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(insert(&table, Value("a"_sd), &inserted), 1U);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(insert(&table, Value(1), &inserted), 0U);
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(table.size(), 2U);
+    ASSERT_VALUE_EQ(table.key(1), Value("a"_sd));
+    ASSERT_EQ(table.keyHash(1), table.hash(Value("a"_sd)));
+}
+
+TEST(GroupHashTableTest, NumericKeysThatCompareEqualShareAGroup) {
+    GroupHashTable table(ValueComparator(), 0);
+    bool inserted;
+    ASSERT_EQ(insert(&table, Value(5), &inserted), 0U);
+    ASSERT_EQ(insert(&table, Value(5LL), &inserted), 0U);
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(insert(&table, Value(5.0), &inserted), 0U);
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(table.size(), 1U);
+}
+
+TEST(GroupHashTableTest, UsesTheCollatorForEquality) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kToLowerString);
+    GroupHashTable table(ValueComparator(&collator), 0);
+    bool inserted;
+    ASSERT_EQ(insert(&table, Value("abc"_sd), &inserted), 0U);
+    ASSERT_EQ(insert(&table, Value("ABC"_sd), &inserted), 0U);
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(insert(&table, Value("abd"_sd), &inserted), 1U);
+    ASSERT_TRUE(inserted);
+}
+
+TEST(GroupHashTableTest, GrowsPastManyGroups) {
+    GroupHashTable table(ValueComparator(), 0);
+    const int kGroups = 100 * 1000;
+    bool inserted;
+    for (int i = 0; i < kGroups; ++i) {
+        ASSERT_EQ(insert(&table, Value(i), &inserted), GroupHashTable::Group(i));
+        ASSERT_TRUE(inserted);
+    }
+    for (int i = 0; i < kGroups; ++i) {
+        ASSERT_EQ(insert(&table, Value(i), &inserted), GroupHashTable::Group(i));
+        ASSERT_FALSE(inserted);
+    }
+    ASSERT_EQ(table.size(), size_t(kGroups));
+}
+
+TEST(GroupHashTableTest, AccumulatorsStayInPlaceAsTheTableGrows) {
+    intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    const size_t kAccumulators = 3;
+    GroupHashTable table(ValueComparator(), kAccumulators);
+
+    bool inserted;
+    auto first = table.accumulators(insert(&table, Value(0), &inserted));
+    for (size_t i = 0; i < kAccumulators; ++i) {
+        first[i] = AccumulatorSum::create(expCtx);
+        first[i]->process(Value(int(i)), false);
+    }
+
+    for (int i = 1; i < 10 * 1000; ++i) {
+        auto accums = table.accumulators(insert(&table, Value(i), &inserted));
+        for (size_t j = 0; j < kAccumulators; ++j) {
+            ASSERT_FALSE(accums[j]);
+            accums[j] = AccumulatorSum::create(expCtx);
+        }
+    }
+
+    ASSERT_EQ(table.accumulators(insert(&table, Value(0), &inserted)), first);
+    for (size_t i = 0; i < kAccumulators; ++i) {
+        ASSERT_VALUE_EQ(first[i]->getValue(false), Value(int(i)));
+    }
+}
+
+TEST(GroupHashTableTest, ClearRemovesAllGroups) {
+    GroupHashTable table(ValueComparator(), 1);
+    bool inserted;
+    for (int i = 0; i < 2000; ++i) {
+        insert(&table, Value(i), &inserted);
+    }
+    table.clear();
+    ASSERT_TRUE(table.empty());
+    ASSERT_EQ(insert(&table, Value(1999), &inserted), 0U);
+    ASSERT_TRUE(inserted);
+    ASSERT_FALSE(table.accumulators(0)[0]);
+}
+
+TEST(GroupHashTableTest, HashUsesAllBits) {
+    // Spilled groups are partitioned by the top bits of the hash, which must not be constant for
+    // small integer keys.
+    GroupHashTable table(ValueComparator(), 0);
+    std::set<uint64_t> topBits;
+    for (int i = 0; i < 1000; ++i) {
+        topBits.insert(table.hash(Value(i)) >> 60);
+    }
+    ASSERT_EQ(topBits.size(), 16U);
+}
+
+}  // namespace
+}  // namespace mongo
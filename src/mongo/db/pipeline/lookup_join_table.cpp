@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/lookup_join_table.h"
+
+#include <algorithm>
+
+#include "mongo/db/pipeline/document_path_support.h"
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+
+LookUpJoinTable::LookUpJoinTable(const ValueComparator& comparator, FieldPath foreignField)
+    : _comparator(comparator),
+      _foreignField(std::move(foreignField)),
+      _index(_comparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+bool LookUpJoinTable::canIndexPath(const FieldPath& foreignField) {
+    for (size_t i = 0; i < foreignField.getPathLength(); ++i) {
+        if (parseUnsignedBase10Integer(foreignField.getFieldName(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LookUpJoinTable::canProbe(const Value& joinKey) {
+    switch (joinKey.getType()) {
+        case EOO:
+        case jstNULL:
+        case Undefined:
+        case Array:
+        case RegEx:
+            return false;
+        default:
+            return true;
+    }
+}
+
+void LookUpJoinTable::insert(Document document) {
+    const size_t position = _documents.size();
+    _approximateSizeBytes += document.getApproximateSize();
+
+    document_path_support::visitAllValuesAtPath(
+        document, _foreignField, [&](const Value& value) {
+            auto& positions = _index[value];
+            if (positions.empty()) {
+                _approximateSizeBytes += value.getApproximateSize();
+            }
+            // An array may hold the same value more than once.
+            if (positions.empty() || positions.back() != position) {
+                positions.push_back(position);
+                _approximateSizeBytes += sizeof(size_t);
+            }
+        });
+
+    _documents.push_back(std::move(document));
+}
+
+void LookUpJoinTable::probe(const std::vector<Value>& joinKeys,
+                            std::vector<Document>* out) const {
+    std::vector<size_t> matches;
+    for (auto&& joinKey : joinKeys) {
+        dassert(canProbe(joinKey));
+        auto it = _index.find(joinKey);
+        if (it != _index.end()) {
+            matches.insert(matches.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    // A document may match several of the join keys.
+    if (joinKeys.size() > 1) {
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+    }
+
+    out->reserve(out->size() + matches.size());
+    for (auto position : matches) {
+        out->push_back(_documents[position]);
+    }
+}
+
+void LookUpJoinTable::clear() {
+    _documents.clear();
+    _index.clear();
+    _approximateSizeBytes = 0;
+}
+
+}  // namespace mongo
@@ -0,0 +1,104 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+
+namespace mongo {
+
+/**
+ * An in-memory index over documents of the foreign collection of a $lookup, used to join on
+ * equality of 'localField' and 'foreignField' without querying the foreign collection for every
+ * input document.
+ *
+ * Each document is indexed under every value at the foreign field path, traversing arrays the way
+ * the query matcher does, so that probing with a join key accepted by canProbe() returns the
+ * documents the query {<foreignField>: {$eq: <joinKey>}} would return. Values compare with the
+ * collation of 'comparator'.
+ */
+class LookUpJoinTable {
+    MONGO_DISALLOW_COPYING(LookUpJoinTable);
+
+public:
+    LookUpJoinTable(const ValueComparator& comparator, FieldPath foreignField);
+
+    /**
+     * Returns whether documents can be indexed on 'foreignField'. Paths with numeric components
+     * are excluded, since the matcher treats them as both array positions and field names.
+     */
+    static bool canIndexPath(const FieldPath& foreignField);
+
+    /**
+     * Returns whether probing with 'joinKey' is equivalent to an equality query. Nulls also
+     * match missing fields, arrays also match whole arrays and regular expressions have special
+     * $in semantics, so they are left to the query system.
+     */
+    static bool canProbe(const Value& joinKey);
+
+    void insert(Document document);
+
+    /**
+     * Appends to 'out' every document matching at least one of 'joinKeys', once and in insertion
+     * order.
+     */
+    void probe(const std::vector<Value>& joinKeys, std::vector<Document>* out) const;
+
+    size_t size() const {
+        return _documents.size();
+    }
+
+    /**
+     * The memory used by the indexed documents and keys, not including the overhead of the hash
+     * table.
+     */
+    size_t approximateSizeBytes() const {
+        return _approximateSizeBytes;
+    }
+
+    void clear();
+
+private:
+    const ValueComparator _comparator;
+    const FieldPath _foreignField;
+
+    std::vector<Document> _documents;
+
+    // Positions in '_documents' of the documents with each value, in increasing order.
+    ValueUnorderedMap<std::vector<size_t>> _index;
+
+    size_t _approximateSizeBytes = 0;
+};
+
+}  // namespace mongo
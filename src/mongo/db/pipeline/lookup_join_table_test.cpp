@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/bson/json.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/lookup_join_table.h"
+#include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const ValueComparator defaultComparator{nullptr};
+
+std::vector<Document> probe(const LookUpJoinTable& table, std::vector<Value> joinKeys) {
+    std::vector<Document> out;
+    table.probe(joinKeys, &out);
+    return out;
+}
+
+TEST(LookUpJoinTableTest, ProbesScalarValues) {
+    LookUpJoinTable table(defaultComparator, FieldPath("a"));
+    table.insert(Document(fromjson("{_id: 0, a: 1}")));
+    table.insert(Document(fromjson("{_id: 1, a: 'x'}")));
+    table.insert(Document(fromjson("{_id: 2, a: 1.0}")));
+    table.insert(Document(fromjson("{_id: 3}")));
+
+    auto matches = probe(table, {Value(1)});
+    ASSERT_EQ(matches.size(), 2U);
+    ASSERT_VALUE_EQ(matches[0]["_id"], Value(0));
+    ASSERT_VALUE_EQ(matches[1]["_id"], Value(2));
+
+    ASSERT_EQ(probe(table, {Value("x"_sd)}).size(), 1U);
+    ASSERT_EQ(probe(table, {Value(2)}).size(), 0U);
+    ASSERT_EQ(table.size(), 4U);
+}
+
+TEST(LookUpJoinTableTest, IndexesArrayElementsAlongThePath) {
+    LookUpJoinTable table(defaultComparator, FieldPath("a.b"));
+    table.insert(Document(fromjson("{_id: 0, a: [{b: 1}, {b: 2}]}")));
+    table.insert(Document(fromjson("{_id: 1, a: {b: [2, 3, 2]}}")));
+    table.insert(Document(fromjson("{_id: 2, a: [[{b: 2}]]}")));
+
+    auto matches = probe(table, {Value(2)});
+    ASSERT_EQ(matches.size(), 2U);
+    ASSERT_VALUE_EQ(matches[0]["_id"], Value(0));
+    ASSERT_VALUE_EQ(matches[1]["_id"], Value(1));
+}
+
+TEST(LookUpJoinTableTest, ReturnsEachMatchOnceInInsertionOrder) {
+    LookUpJoinTable table(defaultComparator, FieldPath("a"));
+    table.insert(Document(fromjson("{_id: 0, a: [3, 1]}")));
+    table.insert(Document(fromjson("{_id: 1, a: 2}")));
+    table.insert(Document(fromjson("{_id: 2, a: 1}")));
+
+    auto matches = probe(table, {Value(2), Value(1), Value(3)});
+    ASSERT_EQ(matches.size(), 3U);
+    ASSERT_VALUE_EQ(matches[0]["_id"], Value(0));
+    ASSERT_VALUE_EQ(matches[1]["_id"], Value(1));
+    ASSERT_VALUE_EQ(matches[2]["_id"], Value(2));
+}
+
+TEST(LookUpJoinTableTest, RespectsCollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kToLowerString);
+    LookUpJoinTable table(ValueComparator(&collator), FieldPath("a"));
+    table.insert(Document(fromjson("{_id: 0, a: 'ABC'}")));
+
+    ASSERT_EQ(probe(table, {Value("abc"_sd)}).size(), 1U);
+}
+
+TEST(LookUpJoinTableTest, TracksAndReleasesMemory) {
+    LookUpJoinTable table(defaultComparator, FieldPath("a"));
+    ASSERT_EQ(table.approximateSizeBytes(), 0U);
+    table.insert(Document(fromjson("{_id: 0, a: 'some string'}")));
+    ASSERT_GT(table.approximateSizeBytes(), 0U);
+
+    table.clear();
+    ASSERT_EQ(table.size(), 0U);
+    ASSERT_EQ(table.approximateSizeBytes(), 0U);
+    ASSERT_EQ(probe(table, {Value("some string"_sd)}).size(), 0U);
+}
+
+TEST(LookUpJoinTableTest, OnlyProbesValuesWithEqualitySemantics) {
+    ASSERT_TRUE(LookUpJoinTable::canProbe(Value(1)));
+    ASSERT_TRUE(LookUpJoinTable::canProbe(Value("x"_sd)));
+    ASSERT_TRUE(LookUpJoinTable::canProbe(Value(Document{{"a", 1}})));
+    ASSERT_FALSE(LookUpJoinTable::canProbe(Value()));
+    ASSERT_FALSE(LookUpJoinTable::canProbe(Value(BSONNULL)));
+    ASSERT_FALSE(LookUpJoinTable::canProbe(Value(BSONUndefined)));
+    ASSERT_FALSE(LookUpJoinTable::canProbe(Value(std::vector<Value>{Value(1)})));
+    ASSERT_FALSE(LookUpJoinTable::canProbe(Value(BSONRegEx("^a"))));
+
+    ASSERT_TRUE(LookUpJoinTable::canIndexPath(FieldPath("a.b")));
+    ASSERT_FALSE(LookUpJoinTable::canIndexPath(FieldPath("a.0.b")));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -72,6 +72,11 @@ public:
         bool attachCursorSource = true;
     };
 
+    struct CollectionSizeEstimate {
+        long long numRecords = 0;
+        long long dataSizeBytes = 0;
+    };
+
     void reset(){}
 
     virtual ~MongoProcessInterface(){};
@@ -112,6 +117,7 @@ public:
     virtual void appendLatencyStats(OperationContext* opCtx,
                                     const NamespaceString& nss,
                                     bool includeHistograms,
+                                    bool includePercentiles,
                                     BSONObjBuilder* builder) const = 0;
 
     /**
@@ -129,6 +135,23 @@ public:
                                      const NamespaceString& nss,
                                      BSONObjBuilder* builder) const = 0;
 
+    /**
+     * Returns the number of records and the data size of collection "nss", as tracked by the
+     * storage engine. A collection that does not exist is empty. A data size of 0 for a non-empty
+     * collection means the storage engine does not track it. Returns boost::none if the sizes are
+     * not available on this process.
+     */
+    virtual boost::optional<CollectionSizeEstimate> estimateCollectionSize(
+        OperationContext* opCtx, const NamespaceString& nss) const = 0;
+
+    /**
+     * Returns true if collection "nss" has a ready, non-partial btree or hashed index whose first
+     * key field is "fieldPath", so that an equality match on that field is an index seek.
+     */
+    virtual bool hasIndexWithLeadingField(OperationContext* opCtx,
+                                          const NamespaceString& nss,
+                                          StringData fieldPath) const = 0;
+
     /**
      * Gets the collection options for the collection given by 'nss'.
      */
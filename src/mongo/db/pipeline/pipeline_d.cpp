@@ -54,6 +54,8 @@
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/kill_sessions.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/namespace_string.h"
@@ -629,8 +631,10 @@ CollectionIndexUsageMap PipelineD::MongoDInterface::getIndexStats(OperationConte
 void PipelineD::MongoDInterface::appendLatencyStats(OperationContext* opCtx,
                                                     const NamespaceString& nss,
                                                     bool includeHistograms,
+                                                    bool includePercentiles,
                                                     BSONObjBuilder* builder) const {
-    Top::get(opCtx->getServiceContext()).appendLatencyStats(nss.ns(), includeHistograms, builder);
+    Top::get(opCtx->getServiceContext())
+        .appendLatencyStats(nss.ns(), includeHistograms, includePercentiles, builder);
 }
 
 Status PipelineD::MongoDInterface::appendStorageStats(OperationContext* opCtx,
@@ -646,6 +650,40 @@ Status PipelineD::MongoDInterface::appendRecordCount(OperationContext* opCtx,
     return appendCollectionRecordCount(opCtx, nss, builder);
 }
 
+boost::optional<MongoProcessInterface::CollectionSizeEstimate>
+PipelineD::MongoDInterface::estimateCollectionSize(OperationContext* opCtx,
+                                                   const NamespaceString& nss) const {
+    AutoGetCollectionForReadCommand autoColl(opCtx, nss);
+    CollectionSizeEstimate estimate;
+    if (Collection* collection = autoColl.getCollection()) {
+        estimate.numRecords = collection->numRecords(opCtx);
+        estimate.dataSizeBytes = collection->dataSize(opCtx);
+    }
+    return estimate;
+}
+
+bool PipelineD::MongoDInterface::hasIndexWithLeadingField(OperationContext* opCtx,
+                                                          const NamespaceString& nss,
+                                                          StringData fieldPath) const {
+    AutoGetCollectionForReadCommand autoColl(opCtx, nss);
+    Collection* collection = autoColl.getCollection();
+    if (!collection) {
+        return false;
+    }
+
+    auto it = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (it.more()) {
+        const IndexDescriptor* descriptor = it.next();
+        const auto& accessMethod = descriptor->getAccessMethodName();
+        if (!descriptor->isPartial() &&
+            (accessMethod == IndexNames::BTREE || accessMethod == IndexNames::HASHED) &&
+            descriptor->keyPattern().firstElementFieldName() == fieldPath) {
+            return true;
+        }
+    }
+    return false;
+}
+
 BSONObj PipelineD::MongoDInterface::getCollectionOptions(const NamespaceString& nss) {
     const auto infos = _client.getCollectionInfos(nss.db().toString(), BSON("name" << nss.coll()));
     return infos.empty() ? BSONObj() : infos.front().getObjectField("options").getOwned();
@@ -76,6 +76,7 @@ public:
         void appendLatencyStats(OperationContext* opCtx,
                                 const NamespaceString& nss,
                                 bool includeHistograms,
+                                bool includePercentiles,
                                 BSONObjBuilder* builder) const final;
         Status appendStorageStats(OperationContext* opCtx,
                                   const NamespaceString& nss,
@@ -84,6 +85,11 @@ public:
         Status appendRecordCount(OperationContext* opCtx,
                                  const NamespaceString& nss,
                                  BSONObjBuilder* builder) const final;
+        boost::optional<CollectionSizeEstimate> estimateCollectionSize(
+            OperationContext* opCtx, const NamespaceString& nss) const final;
+        bool hasIndexWithLeadingField(OperationContext* opCtx,
+                                      const NamespaceString& nss,
+                                      StringData fieldPath) const final;
         BSONObj getCollectionOptions(const NamespaceString& nss) final;
         Status renameIfOptionsAndIndexesHaveNotChanged(
             OperationContext* opCtx,
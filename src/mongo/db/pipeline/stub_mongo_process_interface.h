@@ -71,6 +71,7 @@ public:
     void appendLatencyStats(OperationContext* opCtx,
                             const NamespaceString& nss,
                             bool includeHistograms,
+                            bool includePercentiles,
                             BSONObjBuilder* builder) const override {
         MONGO_UNREACHABLE;
     }
@@ -88,6 +89,17 @@ public:
         MONGO_UNREACHABLE;
     }
 
+    boost::optional<CollectionSizeEstimate> estimateCollectionSize(
+        OperationContext* opCtx, const NamespaceString& nss) const override {
+        return boost::none;
+    }
+
+    bool hasIndexWithLeadingField(OperationContext* opCtx,
+                                  const NamespaceString& nss,
+                                  StringData fieldPath) const override {
+        return false;
+    }
+
     BSONObj getCollectionOptions(const NamespaceString& nss) override {
         MONGO_UNREACHABLE;
     }
@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cardinality_estimator.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getEstimator =
+    ServiceContext::declareDecoration<std::unique_ptr<CardinalityEstimator>>();
+
+bool addKeysExamined(OperationContext* opCtx,
+                     const CanonicalQuery& query,
+                     CardinalityEstimator* estimator,
+                     const QuerySolutionNode* node,
+                     double* keysExamined) {
+    if (node->getType() == STAGE_IXSCAN) {
+        const auto* ixscan = static_cast<const IndexScanNode*>(node);
+        auto estimate =
+            estimator->estimateKeysExamined(opCtx, query.nss(), ixscan->index, ixscan->bounds);
+        if (!estimate) {
+            return false;
+        }
+        *keysExamined += *estimate;
+        return true;
+    }
+
+    if (node->children.empty()) {
+        // A collection scan or a special index access, which we have no statistics for.
+        return false;
+    }
+
+    for (const auto* child : node->children) {
+        if (!addKeysExamined(opCtx, query, estimator, child, keysExamined)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+CardinalityEstimator* CardinalityEstimator::get(ServiceContext* service) {
+    return getEstimator(service).get();
+}
+
+void CardinalityEstimator::set(ServiceContext* service,
+                               std::unique_ptr<CardinalityEstimator> estimator) {
+    getEstimator(service) = std::move(estimator);
+}
+
+boost::optional<double> estimateSolutionKeysExamined(OperationContext* opCtx,
+                                                     const CanonicalQuery& query,
+                                                     CardinalityEstimator* estimator,
+                                                     const QuerySolution& solution) {
+    double keysExamined = 0;
+    if (!solution.root ||
+        !addKeysExamined(opCtx, query, estimator, solution.root.get(), &keysExamined)) {
+        return boost::none;
+    }
+    return keysExamined;
+}
+
+void pruneSolutionsByEstimatedCardinality(OperationContext* opCtx,
+                                          const CanonicalQuery& query,
+                                          CardinalityEstimator* estimator,
+                                          std::vector<std::unique_ptr<QuerySolution>>* solutions) {
+    const double ratio = internalQueryPlannerEstimatePruneRatio.load();
+    if (!estimator || ratio <= 0 || solutions->size() < 2 ||
+        !query.getQueryRequest().getSort().isEmpty()) {
+        return;
+    }
+
+    std::vector<double> estimates;
+    estimates.reserve(solutions->size());
+    for (const auto& solution : *solutions) {
+        auto estimate = estimateSolutionKeysExamined(opCtx, query, estimator, *solution);
+        if (!estimate) {
+            return;
+        }
+        estimates.push_back(*estimate);
+    }
+
+    const double cheapest = *std::min_element(estimates.begin(), estimates.end());
+    const double threshold =
+        std::max(cheapest * ratio, double(internalQueryPlannerEstimatePruneMinKeys.load()));
+
+    size_t kept = 0;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (estimates[i] > threshold) {
+            LOG(2) << "Pruning candidate plan estimated to examine " << estimates[i]
+                   << " keys, against " << cheapest << " for the cheapest candidate. "
+                   << redact(query.toStringShort());
+            continue;
+        }
+        if (kept != i) {
+            (*solutions)[kept] = std::move((*solutions)[i]);
+        }
+        ++kept;
+    }
+    solutions->resize(kept);
+}
+
+}  // namespace mongo
@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/index_entry.h"
+
+namespace mongo {
+
+class CanonicalQuery;
+class NamespaceString;
+class OperationContext;
+class ServiceContext;
+struct QuerySolution;
+
+/**
+ * Storage engines that keep statistics about their index keys may install a CardinalityEstimator
+ * on the ServiceContext. The planner consults it to discard candidate plans that are obviously
+ * worse than the best one before they are trial-run by the MultiPlanStage.
+ */
+class CardinalityEstimator {
+public:
+    virtual ~CardinalityEstimator() = default;
+
+    static CardinalityEstimator* get(ServiceContext* service);
+    static void set(ServiceContext* service, std::unique_ptr<CardinalityEstimator> estimator);
+
+    /**
+     * Returns the estimated number of keys an index scan over 'bounds' of the index described by
+     * 'index' examines, or boost::none if there are not enough statistics to tell.
+     */
+    virtual boost::optional<double> estimateKeysExamined(OperationContext* opCtx,
+                                                         const NamespaceString& nss,
+                                                         const IndexEntry& index,
+                                                         const IndexBounds& bounds) = 0;
+};
+
+/**
+ * Returns the estimated number of index keys 'solution' examines, which is the sum over its index
+ * scans. Returns boost::none if any leaf of the solution is not an index scan, or if 'estimator'
+ * cannot estimate one of them.
+ */
+boost::optional<double> estimateSolutionKeysExamined(OperationContext* opCtx,
+                                                     const CanonicalQuery& query,
+                                                     CardinalityEstimator* estimator,
+                                                     const QuerySolution& solution);
+
+/**
+ * Removes from 'solutions' every candidate whose estimated number of keys examined is more than
+ * 'internalQueryPlannerEstimatePruneRatio' times that of the cheapest candidate, and more than
+ * 'internalQueryPlannerEstimatePruneMinKeys'. Does nothing unless every candidate has an estimate,
+ * or if the query has a sort, where a plan scanning more keys may still win by providing the
+ * order. At least one solution always remains.
+ */
+void pruneSolutionsByEstimatedCardinality(OperationContext* opCtx,
+                                          const CanonicalQuery& query,
+                                          CardinalityEstimator* estimator,
+                                          std::vector<std::unique_ptr<QuerySolution>>* solutions);
+
+}  // namespace mongo
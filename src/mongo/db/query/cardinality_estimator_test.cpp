@@ -0,0 +1,184 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cardinality_estimator.h"
+
+#include <map>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString nss("test.collection");
+
+/**
+ * Estimates a fixed number of keys for each index it knows by name.
+ */
+class FixedCardinalityEstimator : public CardinalityEstimator {
+public:
+    boost::optional<double> estimateKeysExamined(OperationContext* opCtx,
+                                                 const NamespaceString& nss,
+                                                 const IndexEntry& index,
+                                                 const IndexBounds& bounds) override {
+        auto it = keysByIndex.find(index.name);
+        if (it == keysByIndex.end()) {
+            return boost::none;
+        }
+        return it->second;
+    }
+
+    std::map<std::string, double> keysByIndex;
+};
+
+class PruneSolutionsTest : public mongo::unittest::Test {
+protected:
+    CanonicalQuery::UPtr canonicalize(const char* filter, const char* sort = "{}") {
+        auto qr = ObjectPool<QueryRequest>::newObject(nss);
+        qr->setFilter(fromjson(filter));
+        qr->setSort(fromjson(sort));
+        const boost::intrusive_ptr<ExpressionContext> expCtx;
+        return uassertStatusOK(
+            CanonicalQuery::canonicalize(_opCtx.get(),
+                                         std::move(qr),
+                                         expCtx,
+                                         ExtensionsCallbackNoop(),
+                                         MatchExpressionParser::kAllowAllSpecialFeatures));
+    }
+
+    static std::unique_ptr<QuerySolution> indexScanSolution(const std::string& indexName) {
+        auto fetch = stdx::make_unique<FetchNode>();
+        fetch->children.push_back(new IndexScanNode(IndexEntry(BSON(indexName << 1), indexName)));
+        auto solution = stdx::make_unique<QuerySolution>();
+        solution->root = std::move(fetch);
+        return solution;
+    }
+
+    static std::unique_ptr<QuerySolution> collScanSolution() {
+        auto solution = stdx::make_unique<QuerySolution>();
+        solution->root = stdx::make_unique<CollectionScanNode>();
+        return solution;
+    }
+
+    static std::vector<std::string> indexNames(
+        const std::vector<std::unique_ptr<QuerySolution>>& solutions) {
+        std::vector<std::string> names;
+        for (const auto& solution : solutions) {
+            auto* ixscan = static_cast<const IndexScanNode*>(solution->root->children[0]);
+            names.push_back(ixscan->index.name);
+        }
+        return names;
+    }
+
+    std::vector<std::unique_ptr<QuerySolution>> solutionsFor(
+        std::initializer_list<const char*> indexes) {
+        std::vector<std::unique_ptr<QuerySolution>> solutions;
+        for (const char* name : indexes) {
+            solutions.push_back(indexScanSolution(name));
+        }
+        return solutions;
+    }
+
+    QueryTestServiceContext _serviceContext;
+    ServiceContext::UniqueOperationContext _opCtx = _serviceContext.makeOperationContext();
+    FixedCardinalityEstimator _estimator;
+};
+
+TEST_F(PruneSolutionsTest, DropsCandidatesFarWorseThanTheCheapest) {
+    _estimator.keysByIndex = {{"a", 10}, {"b", 50000}, {"c", 5000}, {"d", 200}};
+    auto cq = canonicalize("{a: 1, b: 1, c: 1, d: 1}");
+    auto solutions = solutionsFor({"a", "b", "c", "d"});
+
+    pruneSolutionsByEstimatedCardinality(_opCtx.get(), *cq, &_estimator, &solutions);
+
+    // 'd' is more than ten times 'a', but under the minimum number of keys worth pruning.
+    ASSERT(indexNames(solutions) == (std::vector<std::string>{"a", "d"}));
+}
+
+TEST_F(PruneSolutionsTest, KeepsAllCandidatesWithoutAnEstimateForEach) {
+    _estimator.keysByIndex = {{"a", 10}, {"b", 50000}};
+    auto cq = canonicalize("{a: 1, b: 1, c: 1}");
+    auto solutions = solutionsFor({"a", "b", "c"});
+
+    pruneSolutionsByEstimatedCardinality(_opCtx.get(), *cq, &_estimator, &solutions);
+    ASSERT_EQ(solutions.size(), 3U);
+
+    solutions = solutionsFor({"a", "b"});
+    solutions.push_back(collScanSolution());
+    pruneSolutionsByEstimatedCardinality(_opCtx.get(), *cq, &_estimator, &solutions);
+    ASSERT_EQ(solutions.size(), 3U);
+}
+
+TEST_F(PruneSolutionsTest, KeepsAllCandidatesForSortedQueries) {
+    _estimator.keysByIndex = {{"a", 10}, {"b", 50000}};
+    auto cq = canonicalize("{a: 1, b: 1}", "{b: 1}");
+    auto solutions = solutionsFor({"a", "b"});
+
+    pruneSolutionsByEstimatedCardinality(_opCtx.get(), *cq, &_estimator, &solutions);
+    ASSERT_EQ(solutions.size(), 2U);
+}
+
+TEST_F(PruneSolutionsTest, KeepsAllCandidatesWhenDisabled) {
+    _estimator.keysByIndex = {{"a", 10}, {"b", 50000}};
+    auto cq = canonicalize("{a: 1, b: 1}");
+    auto solutions = solutionsFor({"a", "b"});
+
+    const double oldRatio = internalQueryPlannerEstimatePruneRatio.load();
+    internalQueryPlannerEstimatePruneRatio.store(0);
+    pruneSolutionsByEstimatedCardinality(_opCtx.get(), *cq, &_estimator, &solutions);
+    internalQueryPlannerEstimatePruneRatio.store(oldRatio);
+
+    ASSERT_EQ(solutions.size(), 2U);
+}
+
+TEST_F(PruneSolutionsTest, SumsKeysOverEveryIndexScanOfASolution) {
+    _estimator.keysByIndex = {{"a", 600}, {"b", 600}, {"c", 1000}};
+    auto cq = canonicalize("{a: 1, b: 1, c: 1}");
+
+    auto intersection = stdx::make_unique<QuerySolution>();
+    auto andHash = stdx::make_unique<AndHashNode>();
+    andHash->children.push_back(new IndexScanNode(IndexEntry(BSON("a" << 1), "a")));
+    andHash->children.push_back(new IndexScanNode(IndexEntry(BSON("b" << 1), "b")));
+    intersection->root = std::move(andHash);
+
+    auto estimate = estimateSolutionKeysExamined(_opCtx.get(), *cq, &_estimator, *intersection);
+    ASSERT(estimate);
+    ASSERT_EQ(*estimate, 1200);
+}
+
+}  // namespace
+}  // namespace mongo
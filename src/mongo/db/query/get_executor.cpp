@@ -62,6 +62,7 @@
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/cardinality_estimator.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
@@ -443,6 +444,13 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         }
     }
 
+    // Drop candidates that index statistics show to be far worse than the best one, so that they
+    // are not trial-run.
+    pruneSolutionsByEstimatedCardinality(opCtx,
+                                         *canonicalQuery,
+                                         CardinalityEstimator::get(opCtx->getServiceContext()),
+                                         &solutions);
+
     if (1 == solutions.size()) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
         PlanStage* rawRoot;
@@ -33,6 +33,7 @@
 #include "mongo/db/query/plan_cache.h"
 
 #include <algorithm>
+#include <functional>
 #include <math.h>
 #include <memory>
 #include <vector>
@@ -45,6 +46,7 @@
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -554,9 +556,20 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+PlanCache::PlanCache() : PlanCache(std::string()) {}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+PlanCache::PlanCache(const std::string& ns) : _ns(ns) {
+    // Split the configured size exactly over the shards, so that the cache never holds more than
+    // internalQueryCacheSize entries. Below kNumShards there is one shard per entry, and a size
+    // of 0 leaves a single shard that caches nothing.
+    const size_t maxSize = std::max(internalQueryCacheSize.load(), 0);
+    const size_t numShards = std::max<size_t>(1, std::min(maxSize, kNumShards));
+    _shards.reserve(numShards);
+    for (size_t i = 0; i < numShards; ++i) {
+        const size_t shardSize = maxSize / numShards + (i < maxSize % numShards ? 1 : 0);
+        _shards.push_back(stdx::make_unique<Shard>(shardSize));
+    }
+}
 
 PlanCache::~PlanCache() {}
 
@@ -747,8 +760,10 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    PlanCacheKey key = computeKey(query);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
+    std::unique_ptr<PlanCacheEntry> evictedEntry = shard.cache.add(key, entry);
 
     if (NULL != evictedEntry.get()) {
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
@@ -762,9 +777,10 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
     PlanCacheKey key = computeKey(query);
     verify(crOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = shard.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -782,9 +798,10 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Shard& shard = shardFor(ck);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Status cacheStatus = shard.cache.get(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -799,13 +816,17 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    PlanCacheKey key = computeKey(canonicalQuery);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
+    return shard.cache.remove(key);
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        shard->cache.clear();
+    }
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -820,9 +841,10 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
     PlanCacheKey key = computeKey(query);
     verify(entryOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = shard.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -834,25 +856,37 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 }
 
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
     typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        for (ConstIterator i = shard->cache.begin(); i != shard->cache.end(); i++) {
+            PlanCacheEntry* entry = i->second;
+            entries.push_back(entry->clone());
+        }
     }
 
     return entries;
 }
 
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    PlanCacheKey key = computeKey(cq);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
+    return shard.cache.hasKey(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t total = 0;
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        total += shard->cache.size();
+    }
+    return total;
+}
+
+PlanCache::Shard& PlanCache::shardFor(const PlanCacheKey& key) const {
+    return *_shards[std::hash<PlanCacheKey>()(key) % _shards.size()];
 }
 
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
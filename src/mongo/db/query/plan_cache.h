@@ -29,7 +29,9 @@
 #pragma once
 
 #include <boost/optional/optional.hpp>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
@@ -387,7 +389,7 @@ public:
     Status getEntry(const CanonicalQuery& cq, PlanCacheEntry** entryOut) const;
 
     /**
-     * Returns a vector of all cache entries.
+     * Returns a vector of all cache entries, most recently used first within each shard.
      * Caller owns the result vector and is responsible for cleaning up
      * the cache entry copies.
      * Used by planCacheListQueryShapes and index_filter_commands_test.cpp.
@@ -414,15 +416,34 @@ public:
      */
     void notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries);
 
+    /**
+     * The cache is partitioned into at most this many shards by the hash of the plan cache key.
+     */
+    static constexpr size_t kNumShards = 16;
+
 private:
+    /**
+     * One partition of the cache. Each shard has its own LRU list, bounded by its share of
+     * internalQueryCacheSize, and its own mutex, so that lookups of different query shapes do not
+     * serialize on a single lock. Eviction is least recently used within a shard, not across the
+     * whole cache.
+     */
+    struct Shard {
+        explicit Shard(size_t maxSize) : cache(maxSize) {}
+
+        // Protects 'cache'.
+        mutable stdx::mutex mutex;
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry> cache;
+    };
+
     void encodeKeyForMatch(const MatchExpression* tree, StringBuilder* keyBuilder) const;
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+    Shard& shardFor(const PlanCacheKey& key) const;
 
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    // Allocated separately so that the mutexes of different shards do not share a cache line.
+    std::vector<std::unique_ptr<Shard>> _shards;
 
     // Full namespace of collection.
     std::string _ns;
@@ -0,0 +1,135 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/query_test_service_context.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const int kMaxPerfThreads = 16;
+
+const NamespaceString nss("test.collection");
+
+CanonicalQuery::UPtr canonicalize(OperationContext* opCtx, const BSONObj& filter) {
+    auto qr = ObjectPool<QueryRequest>::newObject(nss);
+    qr->setFilter(filter);
+    const boost::intrusive_ptr<ExpressionContext> expCtx;
+    auto statusWithCQ =
+        CanonicalQuery::canonicalize(opCtx,
+                                     std::move(qr),
+                                     expCtx,
+                                     ExtensionsCallbackNoop(),
+                                     MatchExpressionParser::kAllowAllSpecialFeatures);
+    return uassertStatusOK(std::move(statusWithCQ));
+}
+
+PlanRankingDecision* createDecision() {
+    auto why = stdx::make_unique<PlanRankingDecision>();
+    CommonStats common("COLLSCAN");
+    auto stats = stdx::make_unique<PlanStageStats>(common, STAGE_COLLSCAN);
+    stats->specific.reset(new CollectionScanStats());
+    why->stats.push_back(std::move(stats));
+    why->scores.push_back(0U);
+    why->candidateOrder.push_back(0U);
+    return why.release();
+}
+
+/**
+ * A plan cache holding one entry for each of 'state.range(0)' query shapes, which all benchmark
+ * threads look up concurrently.
+ */
+class PlanCacheLookupTest : public benchmark::Fixture {
+public:
+    void populate(size_t numShapes) {
+        QueryTestServiceContext serviceContext;
+        auto opCtx = serviceContext.makeOperationContext();
+
+        QuerySolution soln;
+        soln.cacheData.reset(new SolutionCacheData());
+        soln.cacheData->tree.reset(new PlanCacheIndexTree());
+        std::vector<QuerySolution*> solns{&soln};
+
+        planCache = stdx::make_unique<PlanCache>(nss.ns());
+        for (size_t i = 0; i < numShapes; ++i) {
+            queries.push_back(canonicalize(opCtx.get(), BSON(("a" + std::to_string(i)) << 1)));
+            uassertStatusOK(planCache->add(*queries.back(), solns, createDecision(), Date_t()));
+        }
+    }
+
+protected:
+    std::unique_ptr<PlanCache> planCache;
+    std::vector<CanonicalQuery::UPtr> queries;
+};
+
+BENCHMARK_DEFINE_F(PlanCacheLookupTest, BM_PlanCacheGet)(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        populate(state.range(0));
+    }
+
+    // Threads start at different shapes so that they do not walk the cache in lockstep.
+    size_t next = state.thread_index * 7;
+    for (auto keepRunning : state) {
+        const CanonicalQuery& cq = *queries[next++ % queries.size()];
+        CachedSolution* rawCachedSolution;
+        invariant(planCache->get(cq, &rawCachedSolution).isOK());
+        std::unique_ptr<CachedSolution> cachedSolution(rawCachedSolution);
+        benchmark::DoNotOptimize(cachedSolution);
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index == 0) {
+        queries.clear();
+        planCache.reset();
+    }
+}
+
+// A single hot query shape, and many shapes spread over all shards of the cache.
+BENCHMARK_REGISTER_F(PlanCacheLookupTest, BM_PlanCacheGet)
+    ->Arg(1)
+    ->Arg(1024)
+    ->ArgName("shapes")
+    ->ThreadRange(1, kMaxPerfThreads);
+
+}  // namespace
+}  // namespace mongo
@@ -446,6 +446,90 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+TEST(PlanCacheTest, ManyShapesSpreadAcrossShards) {
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    const size_t numShapes = 10 * PlanCache::kNumShards;
+    std::vector<unique_ptr<CanonicalQuery>> queries;
+    for (size_t i = 0; i < numShapes; ++i) {
+        queries.push_back(canonicalize(BSON(("a" + std::to_string(i)) << 1)));
+        ASSERT_OK(planCache.add(*queries.back(), solns, createDecision(1U), Date_t{}));
+    }
+    ASSERT_EQUALS(planCache.size(), numShapes);
+
+    for (const auto& cq : queries) {
+        CachedSolution* rawCachedSolution;
+        ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+        delete rawCachedSolution;
+    }
+
+    // Every shard contributes its entries to the list of query shapes.
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ASSERT_EQUALS(entries.size(), numShapes);
+    for (auto entry : entries) {
+        delete entry;
+    }
+
+    // Removing one shape leaves the others, clearing empties all shards.
+    ASSERT_OK(planCache.remove(*queries.front()));
+    ASSERT_FALSE(planCache.contains(*queries.front()));
+    ASSERT_TRUE(planCache.contains(*queries.back()));
+    ASSERT_EQUALS(planCache.size(), numShapes - 1);
+
+    planCache.clear();
+    ASSERT_EQUALS(planCache.size(), 0U);
+    ASSERT_TRUE(planCache.getAllEntries().empty());
+}
+
+/**
+ * Adds 'numShapes' distinct query shapes to a plan cache built with internalQueryCacheSize set to
+ * 'cacheSize', and checks that the cache never holds more entries than that.
+ */
+void assertCacheSizeIsBounded(int cacheSize, size_t numShapes) {
+    const int oldCacheSize = internalQueryCacheSize.load();
+    ON_BLOCK_EXIT([oldCacheSize] { internalQueryCacheSize.store(oldCacheSize); });
+    internalQueryCacheSize.store(cacheSize);
+
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    QueryTestServiceContext serviceContext;
+    for (size_t i = 0; i < numShapes; ++i) {
+        unique_ptr<CanonicalQuery> cq(canonicalize(BSON(("a" + std::to_string(i)) << 1)));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U), Date_t{}));
+        ASSERT_LTE(planCache.size(), static_cast<size_t>(cacheSize));
+        // The shape just added is cached unless caching is disabled.
+        ASSERT_EQUALS(planCache.contains(*cq), cacheSize > 0);
+    }
+}
+
+TEST(PlanCacheTest, CacheSizeOfZeroDisablesCaching) {
+    assertCacheSizeIsBounded(0, 10);
+}
+
+TEST(PlanCacheTest, CacheSizeOfOneHoldsOneEntry) {
+    assertCacheSizeIsBounded(1, 10);
+}
+
+TEST(PlanCacheTest, CacheSizeBelowShardCountIsNotExceeded) {
+    for (int cacheSize = 2; cacheSize < static_cast<int>(PlanCache::kNumShards); ++cacheSize) {
+        assertCacheSizeIsBounded(cacheSize, 4 * PlanCache::kNumShards);
+    }
+}
+
+TEST(PlanCacheTest, CacheSizeNotMultipleOfShardCountIsNotExceeded) {
+    assertCacheSizeIsBounded(PlanCache::kNumShards + 1, 8 * PlanCache::kNumShards);
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -79,6 +79,13 @@ extern AtomicDouble internalQueryCacheEvictionRatio;
 // How many indexed solutions will QueryPlanner::plan output?
 extern AtomicInt32 internalQueryPlannerMaxIndexedSolutions;
 
+// Candidate plans estimated to examine more than this many times the keys of the cheapest
+// candidate are dropped before the trial run. Zero disables pruning.
+extern AtomicDouble internalQueryPlannerEstimatePruneRatio;
+
+// Candidate plans estimated to examine fewer keys than this are never pruned.
+extern AtomicInt32 internalQueryPlannerEstimatePruneMinKeys;
+
 // How many solutions will the enumerator consider at each OR?
 extern AtomicInt32 internalQueryEnumerationMaxOrSolutions;
 
@@ -110,6 +117,9 @@ extern AtomicInt32 internalQueryExecYieldIterations;
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern AtomicInt32 internalQueryExecYieldPeriodMS;
 
+// Do collection scans evaluate their filter with a compiled evaluator when it supports the filter?
+extern AtomicBool internalQueryExecEnableCompiledFilters;
+
 // Limit the size that we write without yielding to 16MB / 64 (max expected number of indexes)
 const int64_t insertVectorMaxBytes = 256 * 1024;
 
@@ -122,5 +132,13 @@ extern AtomicInt32 internalDocumentSourceCursorBatchSizeBytes;
 
 extern AtomicInt32 internalDocumentSourceLookupCacheSizeBytes;
 
+// A $lookup whose input fills a batch builds a hash table over a foreign collection holding at
+// most this many bytes, unless the foreign field is indexed, instead of querying it per batch.
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMaxBytes;
+
+// The number of input documents whose join keys a $lookup resolves with a single query. Values of
+// 1 or less disable batching and hash joins.
+extern AtomicInt32 internalDocumentSourceLookupBatchSize;
+
 extern AtomicBool internalQueryProhibitBlockingMergeOnMongoS;
 }  // namespace mongo
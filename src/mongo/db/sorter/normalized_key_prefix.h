@@ -0,0 +1,140 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsontypes.h"
+#include "mongo/bson/oid.h"
+#include "mongo/platform/decimal128.h"
+
+namespace mongo {
+namespace sorter {
+
+/**
+ * Helpers to build the normalized key prefix of a sort key (see the Comparator requirements in
+ * sorter.h). A prefix is 8 bytes, compared as an unsigned integer: the canonical BSON type in the
+ * top byte, followed by the leading 7 bytes of an order-preserving encoding of the value.
+ *
+ * Encodings are monotonic but may lose information, so two prefixes are either ordered the same
+ * way as the values they come from, or equal. Equal prefixes are resolved by the comparator.
+ * Strings are encoded bytewise, so prefixes of strings must only be used when strings compare
+ * with the simple (binary) collation.
+ */
+
+inline uint64_t normalizedKeyPrefix(BSONType type, uint64_t payload) {
+    // canonicalizeBSONType() is in [-1, 127].
+    const uint64_t canonicalType = static_cast<uint64_t>(canonicalizeBSONType(type) + 1);
+    return (canonicalType << 56) | (payload >> 8);
+}
+
+/**
+ * Maps doubles onto unsigned integers of the same order. NaN sorts before all other numbers and
+ * -0.0 equals 0.0, as in BSON comparisons.
+ */
+inline uint64_t normalizedNumberPayload(double number) {
+    if (std::isnan(number)) {
+        return 0;
+    }
+    if (number == 0) {
+        number = 0;  // Folds -0.0 into 0.0.
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    return (bits & (1ULL << 63)) ? ~bits : bits | (1ULL << 63);
+}
+
+inline uint64_t normalizedSignedPayload(long long value) {
+    return static_cast<uint64_t>(value) ^ (1ULL << 63);
+}
+
+/**
+ * The leading bytes of 'data', big-endian and zero-padded. A string that is a prefix of another
+ * gets a payload less than or equal to it, as required.
+ */
+inline uint64_t normalizedBytesPayload(StringData data) {
+    uint64_t payload = 0;
+    const size_t n = std::min<size_t>(data.size(), sizeof(payload));
+    for (size_t i = 0; i < n; ++i) {
+        payload |= static_cast<uint64_t>(static_cast<unsigned char>(data[i])) << (56 - 8 * i);
+    }
+    return payload;
+}
+
+/**
+ * Normalized key prefix of a BSON element under the simple collation, consistent with
+ * BSONElement::woCompare() ignoring field names.
+ */
+inline uint64_t normalizedKeyPrefix(const BSONElement& elem) {
+    const BSONType type = elem.type();
+    switch (type) {
+        case NumberInt:
+        case NumberLong:
+        case NumberDouble:
+            return normalizedKeyPrefix(type, normalizedNumberPayload(elem.numberDouble()));
+        case NumberDecimal: {
+            const Decimal128 decimal = elem.numberDecimal();
+            return normalizedKeyPrefix(
+                type,
+                decimal.isNaN() ? 0 : normalizedNumberPayload(decimal.toDouble()));
+        }
+        case String:
+        case Symbol:
+            return normalizedKeyPrefix(
+                type, normalizedBytesPayload(StringData(elem.valuestr(), elem.valuestrsize() - 1)));
+        case jstOID:
+            return normalizedKeyPrefix(
+                type,
+                normalizedBytesPayload(StringData(elem.__oid().view().view(), OID::kOIDSize)));
+        case Bool:
+            return normalizedKeyPrefix(type, elem.boolean() ? 1ULL << 63 : 0);
+        case Date:
+            return normalizedKeyPrefix(
+                type, normalizedSignedPayload(elem.date().toMillisSinceEpoch()));
+        default:
+            // Ordered by type only; equal prefixes fall back to the comparator.
+            return normalizedKeyPrefix(type, 0);
+    }
+}
+
+/**
+ * Applies the direction of a sort key component: descending components invert the prefix, which
+ * reverses the order and keeps equal prefixes equal.
+ */
+inline uint64_t directedKeyPrefix(uint64_t prefix, bool ascending) {
+    return ascending ? prefix : ~prefix;
+}
+
+}  // namespace sorter
+}  // namespace mongo
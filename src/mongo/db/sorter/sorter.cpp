@@ -47,14 +47,18 @@
 
 #include "mongo/db/sorter/sorter.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
-#include <snappy.h>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/sorter/spill_compression.h"
+#include "mongo/db/sorter/spill_scheduler.h"
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
@@ -102,6 +106,108 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+/**
+ * Whether Comparator provides normalized key prefixes for Data (see sorter.h).
+ */
+template <typename Comparator, typename Data, typename = void>
+struct HasNormalizedKeyPrefix : std::false_type {};
+
+template <typename Comparator, typename Data>
+struct HasNormalizedKeyPrefix<
+    Comparator,
+    Data,
+    std::void_t<decltype(std::declval<const Comparator&>().hasNormalizedKeyPrefix()),
+                decltype(std::declval<const Comparator&>().normalizedKeyPrefix(
+                    std::declval<const Data&>()))>> : std::true_type {};
+
+// Below this many pairs, building prefixes costs more than the comparisons it saves.
+const size_t kMinNormalizedKeySortSize = 256;
+
+struct PrefixedIndex {
+    uint64_t prefix;
+    uint32_t index;
+};
+
+/**
+ * Stable LSD radix sort of 'entries' by prefix, one byte per pass. Bytes that are the same in
+ * all prefixes (e.g. the type byte when all keys have the same type) are skipped.
+ */
+inline void radixSortByPrefix(std::vector<PrefixedIndex>* entries) {
+    uint64_t anySet = 0;
+    uint64_t allSet = ~0ULL;
+    for (const auto& entry : *entries) {
+        anySet |= entry.prefix;
+        allSet &= entry.prefix;
+    }
+    const uint64_t varying = anySet ^ allSet;
+
+    std::vector<PrefixedIndex> buffer(entries->size());
+    for (int shift = 0; shift < 64; shift += 8) {
+        if (((varying >> shift) & 0xFF) == 0)
+            continue;
+
+        size_t offsets[256] = {};
+        for (const auto& entry : *entries) {
+            ++offsets[(entry.prefix >> shift) & 0xFF];
+        }
+        size_t offset = 0;
+        for (auto& count : offsets) {
+            const size_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+        for (const auto& entry : *entries) {
+            buffer[offsets[(entry.prefix >> shift) & 0xFF]++] = entry;
+        }
+        entries->swap(buffer);
+    }
+}
+
+/**
+ * Stable sort of 'data' that orders pairs by their normalized key prefix and only uses 'less' to
+ * order pairs with equal prefixes.
+ */
+template <typename Data, typename Comparator, typename Less>
+void sortByNormalizedKeyPrefix(std::deque<Data>* data, const Comparator& comp, const Less& less) {
+    invariant(data->size() <= std::numeric_limits<uint32_t>::max());
+
+    std::vector<PrefixedIndex> entries;
+    entries.reserve(data->size());
+    for (size_t i = 0; i < data->size(); ++i) {
+        entries.push_back({comp.normalizedKeyPrefix((*data)[i]), static_cast<uint32_t>(i)});
+    }
+    radixSortByPrefix(&entries);
+
+    const auto lessByIndex = [&](const PrefixedIndex& lhs, const PrefixedIndex& rhs) {
+        return less((*data)[lhs.index], (*data)[rhs.index]);
+    };
+    for (auto tieBegin = entries.begin(); tieBegin != entries.end();) {
+        const uint64_t prefix = tieBegin->prefix;
+        auto tieEnd = std::find_if(tieBegin + 1, entries.end(), [&](const PrefixedIndex& entry) {
+            return entry.prefix != prefix;
+        });
+        if (tieEnd - tieBegin > 1) {
+            std::stable_sort(tieBegin, tieEnd, lessByIndex);
+        }
+        tieBegin = tieEnd;
+    }
+
+#if defined(MONGO_CONFIG_DEBUG_BUILD)
+    // Prefixes must never contradict the comparator.
+    for (size_t i = 1; i < entries.size(); ++i) {
+        if (entries[i - 1].prefix != entries[i].prefix) {
+            invariant(comp((*data)[entries[i - 1].index], (*data)[entries[i].index]) < 0);
+        }
+    }
+#endif
+
+    std::deque<Data> sorted;
+    for (const auto& entry : entries) {
+        sorted.push_back(std::move((*data)[entry.index]));
+    }
+    data->swap(sorted);
+}
+
 /** Ensures a named file is deleted when this object goes out of scope */
 class FileDeleter {
 public:
@@ -195,18 +301,26 @@ private:
     }
 
     void fill() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
+        char headerBuffer[SpillBlockHeader::kSize];
+        read(headerBuffer, sizeof(headerBuffer));
         if (_done)
             return;
 
-        // negative size means compressed
-        const bool compressed = rawSize < 0;
-        int32_t blockSize = std::abs(rawSize);
+        auto swHeader = SpillBlockHeader::parse(headerBuffer);
+        massert(51090,
+                str::stream() << "corrupt block header in file \"" << _fileName << "\": "
+                              << swHeader.getStatus().reason(),
+                swHeader.isOK());
+        const SpillBlockHeader& header = swHeader.getValue();
+        int32_t blockSize = header.storedSize;
 
         _buffer.reset(new char[blockSize]);
         read(_buffer.get(), blockSize);
         massert(16816, "file too short?", !_done);
+        massert(51091,
+                str::stream() << "checksum mismatch in file \"" << _fileName << "\"",
+                spillBlockChecksum(header, ConstDataRange(_buffer.get(), blockSize)) ==
+                    header.checksum);
 
         auto encryptionHooks = EncryptionHooks::get(getGlobalServiceContext());
         if (encryptionHooks->enabled()) {
@@ -225,26 +339,26 @@ private:
             _buffer.swap(out);
         }
 
-        if (!compressed) {
+        if (header.compressor == SpillCompressor::Id::kNone) {
+            massert(51092,
+                    "uncompressed block has the wrong size",
+                    size_t(blockSize) == header.uncompressedSize);
             _reader.reset(new BufReader(_buffer.get(), blockSize));
             return;
         }
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
-
-        size_t uncompressedSize;
-        massert(17061,
-                "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
-
-        std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
+        std::unique_ptr<char[]> decompressionBuffer(new char[header.uncompressedSize]);
+        Status status = getSpillCompressor(header.compressor)
+                            ->decompress(ConstDataRange(_buffer.get(), blockSize),
+                                         DataRange(decompressionBuffer.get(),
+                                                   header.uncompressedSize));
         massert(17062,
-                "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+                str::stream() << "decompression failed: " << status.reason(),
+                status.isOK());
 
         // hold on to decompressed data and throw out compressed data at block exit
         _buffer.swap(decompressionBuffer);
-        _reader.reset(new BufReader(_buffer.get(), uncompressedSize));
+        _reader.reset(new BufReader(_buffer.get(), header.uncompressedSize));
     }
 
     // sets _done to true on EOF - asserts on any other error
@@ -418,7 +532,7 @@ public:
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        if (_memUsed > spillThreshold())
             spill();
     }
 
@@ -429,6 +543,7 @@ public:
         }
 
         spill();
+        _spiller.waitForSpills();
         return Iterator::merge(_iters, _opts, _comp);
     }
 
@@ -440,6 +555,10 @@ public:
         return _memUsed;
     }
 
+    SorterSpillStats spillStats() const {
+        return _spiller.stats();
+    }
+
 private:
     class STLComparator {
     public:
@@ -453,9 +572,25 @@ private:
         const Comparator& _comp;
     };
 
+    // Without external sorting the whole limit is available to a single buffer.
+    size_t spillThreshold() const {
+        return _opts.extSortAllowed ? _spiller.spillThreshold(_opts.maxMemoryUsageBytes)
+                                    : _opts.maxMemoryUsageBytes;
+    }
+
     void sort() {
-        STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        sortData(&_data, _comp);
+    }
+
+    static void sortData(std::deque<Data>* data, const Comparator& comp) {
+        STLComparator less(comp);
+        if constexpr (HasNormalizedKeyPrefix<Comparator, Data>::value) {
+            if (data->size() >= kMinNormalizedKeySortSize && comp.hasNormalizedKeyPrefix()) {
+                sortByNormalizedKeyPrefix(data, comp, less);
+                return;
+            }
+        }
+        std::stable_sort(data->begin(), data->end(), less);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
@@ -479,16 +614,24 @@ private:
                           << " Pass allowDiskUse:true to opt in.");
         }
 
-        sort();
-
-        SortedFileWriter<Key, Value> writer(_opts, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
-        }
-
-        _iters.push_back(std::shared_ptr<Iterator>(writer.done()));
-
+        // The run is sorted and written by the spill job, which may run on another thread while
+        // this sorter fills a new buffer. The writer is created here so that the order of _iters
+        // matches the order of the runs.
+        auto data = std::make_shared<std::deque<Data>>();
+        data->swap(_data);
+        auto writer = std::make_shared<SortedFileWriter<Key, Value>>(_opts, _settings);
+        auto iter = std::make_shared<DeferredIterator<Key, Value>>();
+        _iters.push_back(iter);
         _memUsed = 0;
+
+        _spiller.spill([ data, writer, iter, comp = _comp ] {
+            sortData(data.get(), comp);
+            for (; !data->empty(); data->pop_front()) {
+                writer->addAlreadySorted(data->front().first, data->front().second);
+            }
+            iter->reset(writer->done());
+            return writer->bytesWritten();
+        });
     }
 
     const Comparator _comp;
@@ -497,6 +640,9 @@ private:
     size_t _memUsed;
     std::deque<Data> _data;                         // the "current" data
     std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+
+    // Declared last, so that spills in flight are waited for before the members they write.
+    SpillScheduler _spiller;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -856,14 +1002,21 @@ void SortedFileWriter<Key, Value>::spill() {
     if (size == 0)
         return;
 
-    std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
-    verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+    sorter::SpillBlockHeader header;
+    header.uncompressedSize = size;
 
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
-    if (shouldCompress) {
-        size = compressed.size();
-        outBuffer = const_cast<char*>(compressed.data());
+    std::string compressed;
+    const auto& compressor = sorter::getConfiguredSpillCompressor();
+    if (compressor.id() != sorter::SpillCompressor::Id::kNone) {
+        compressor.compress(ConstDataRange(outBuffer, size), &compressed);
+        verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+
+        // Store the block uncompressed unless that saves at least 10%.
+        if (compressed.size() < size_t(_buffer.len() / 10 * 9)) {
+            header.compressor = compressor.id();
+            size = compressed.size();
+            outBuffer = const_cast<char*>(compressed.data());
+        }
     }
 
     std::unique_ptr<char[]> out;
@@ -884,11 +1037,14 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
-    // negative size means compressed
-    size = shouldCompress ? -size : size;
+    header.storedSize = size;
+    header.checksum = sorter::spillBlockChecksum(header, ConstDataRange(outBuffer, size));
+    char headerBuffer[sorter::SpillBlockHeader::kSize];
+    header.writeTo(headerBuffer);
     try {
-        _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-        _file.write(outBuffer, std::abs(size));
+        _file.write(headerBuffer, sizeof(headerBuffer));
+        _file.write(outBuffer, size);
+        _bytesWritten += sizeof(headerBuffer) + size;
 
     } catch (const std::exception&) {
         msgasserted(16821,
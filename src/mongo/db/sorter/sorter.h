@@ -37,6 +37,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/sorter/spill_scheduler.h"
 
 /**
  * This is the public API for the Sorter (both in-memory and external)
@@ -81,6 +82,16 @@
  *     }
  *     Ordering _ord;
  * };
+ *
+ * Comparators may optionally provide a normalized key prefix, which lets the in-memory sort
+ * order most pairs by an 8-byte radix sort and only call the comparator to break prefix ties:
+ *
+ * // Whether normalizedKeyPrefix() may be used, e.g. false under a non-simple collation.
+ * bool hasNormalizedKeyPrefix() const;
+ *
+ * // Must be order-preserving: if prefix(lhs) < prefix(rhs) then comp(lhs, rhs) < 0. Pairs
+ * // with equal prefixes may compare in any way. See sorter/normalized_key_prefix.h.
+ * uint64_t normalizedKeyPrefix(const std::pair<Key, Value>& data) const;
  */
 
 namespace mongo {
@@ -176,6 +187,10 @@ public:
     virtual int numFiles() const = 0;
     virtual size_t memUsed() const = 0;
 
+    virtual SorterSpillStats spillStats() const {
+        return {};
+    }
+
 protected:
     Sorter() {}  // can only be constructed as a base
 };
@@ -196,6 +211,11 @@ public:
     void addAlreadySorted(const Key&, const Value&);
     Iterator* done();  /// Can't add more data after calling done()
 
+    /// Bytes written to the file so far, after compression.
+    long long bytesWritten() const {
+        return _bytesWritten;
+    }
+
 private:
     void spill();
 
@@ -204,7 +224,34 @@ private:
     std::shared_ptr<sorter::FileDeleter> _fileDeleter;  // Must outlive _file
     std::ofstream _file;
     BufBuilder _buffer;
+    long long _bytesWritten = 0;
+};
+
+namespace sorter {
+/**
+ * Stands in for the iterator over a spilled run that may still be written in the background.
+ * Only used after SpillScheduler::waitForSpills().
+ */
+template <typename Key, typename Value>
+class DeferredIterator : public SortIteratorInterface<Key, Value> {
+public:
+    typedef std::pair<Key, Value> Data;
+    typedef SortIteratorInterface<Key, Value> Iterator;
+
+    void reset(Iterator* source) {
+        _source.reset(source);
+    }
+    bool more() {
+        return _source->more();
+    }
+    Data next() {
+        return _source->next();
+    }
+
+private:
+    std::unique_ptr<Iterator> _source;
 };
+}  // namespace sorter
 }
 
 /**
@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/sorter/normalized_key_prefix.h"
+#include "mongo/db/sorter/sorter.h"
+#include "mongo/platform/random.h"
+
+#include "mongo/db/sorter/sorter.cpp"
+
+namespace mongo {
+namespace {
+
+using KeySorter = Sorter<BSONObj, RecordId>;
+
+/**
+ * Compares index-style keys like the index build comparator does. The normalized key prefix of
+ * the first key component is only offered when 'usePrefix' is set, so both sort paths can be
+ * measured on the same input.
+ */
+class BenchmarkComparison {
+public:
+    BenchmarkComparison(const BSONObj& keyPattern, bool usePrefix)
+        : _ordering(Ordering::make(keyPattern)), _usePrefix(usePrefix) {}
+
+    typedef std::pair<BSONObj, RecordId> Data;
+
+    int operator()(const Data& l, const Data& r) const {
+        int x = l.first.woCompare(r.first, _ordering, /*considerfieldname*/ false);
+        if (x) {
+            return x;
+        }
+        return l.second.compare(r.second);
+    }
+
+    bool hasNormalizedKeyPrefix() const {
+        return _usePrefix;
+    }
+
+    uint64_t normalizedKeyPrefix(const Data& data) const {
+        return sorter::directedKeyPrefix(sorter::normalizedKeyPrefix(data.first.firstElement()),
+                                         _ordering.get(0) == 1);
+    }
+
+private:
+    const Ordering _ordering;
+    const bool _usePrefix;
+};
+
+enum class KeyShape {
+    kIntThenString,       // {a: 1, b: 1} with a distinct-ish int and a string.
+    kStringThenInt,       // {a: 1, b: 1} with strings sharing a long common prefix.
+    kDoubleDescThenInt,   // {a: -1, b: 1} with a double, descending.
+    kLowCardinalityBool,  // {a: 1, b: 1} with a bool, leaving most work to the comparator.
+};
+
+BSONObj makeKeyPattern(KeyShape shape) {
+    return shape == KeyShape::kDoubleDescThenInt ? BSON("a" << -1 << "b" << 1)
+                                                 : BSON("a" << 1 << "b" << 1);
+}
+
+std::vector<BSONObj> makeKeys(KeyShape shape, size_t n) {
+    PseudoRandom random(42);
+    std::vector<BSONObj> keys;
+    keys.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const int value = random.nextInt32(1000 * 1000);
+        switch (shape) {
+            case KeyShape::kIntThenString:
+                keys.push_back(BSON("" << value << ""
+                                       << "user" + std::to_string(random.nextInt32(1000))));
+                break;
+            case KeyShape::kStringThenInt:
+                keys.push_back(BSON(""
+                                    << "customer:" + std::to_string(value)
+                                    << ""
+                                    << random.nextInt32(1000)));
+                break;
+            case KeyShape::kDoubleDescThenInt:
+                keys.push_back(BSON("" << random.nextCanonicalDouble() * value << ""
+                                       << random.nextInt32(1000)));
+                break;
+            case KeyShape::kLowCardinalityBool:
+                keys.push_back(BSON("" << (value % 2 == 0) << "" << value));
+                break;
+        }
+    }
+    return keys;
+}
+
+/**
+ * Sorts state.range(1) keys of shape state.range(0) in memory, with (state.range(2) == 1) or
+ * without the normalized key prefix.
+ */
+void BM_SortKeys(benchmark::State& state) {
+    const auto shape = static_cast<KeyShape>(state.range(0));
+    const auto keys = makeKeys(shape, state.range(1));
+    const BenchmarkComparison comp(makeKeyPattern(shape), state.range(2) == 1);
+    const SortOptions opts = SortOptions().MaxMemoryUsageBytes(std::numeric_limits<size_t>::max());
+
+    for (auto keepRunning : state) {
+        std::unique_ptr<KeySorter> sorter(KeySorter::make(opts, comp));
+        for (size_t i = 0; i < keys.size(); ++i) {
+            sorter->add(keys[i], RecordId(static_cast<int64_t>(i + 1)));
+        }
+        std::unique_ptr<KeySorter::Iterator> it(sorter->done());
+        benchmark::DoNotOptimize(it->next());
+    }
+    state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+void sortKeysArgs(benchmark::internal::Benchmark* bm) {
+    for (int shape = 0; shape <= static_cast<int>(KeyShape::kLowCardinalityBool); ++shape) {
+        for (int keys : {1 << 10, 1 << 16, 1 << 20}) {
+            for (int prefix : {0, 1}) {
+                bm->Args({shape, keys, prefix});
+            }
+        }
+    }
+}
+
+BENCHMARK(BM_SortKeys)
+    ->ArgNames({"shape", "keys", "prefix"})
+    ->Apply(sortKeysArgs)
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
+}  // namespace mongo
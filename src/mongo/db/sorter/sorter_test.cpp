@@ -36,11 +36,17 @@
 #include "mongo/base/init.h"
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/sorter/normalized_key_prefix.h"
+#include "mongo/db/sorter/spill_compression.h"
 #include "mongo/db/service_context_test_fixture.h"
+#include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 // Need access to internal classes
 #include "mongo/db/sorter/sorter.cpp"
@@ -267,6 +273,48 @@ public:
     }
 };
 
+class SortedFileWriterDetectsCorruption : public ScopedGlobalServiceContextForTest {
+public:
+    void run() {
+        ServerParameter* compressorParam =
+            ServerParameterSet::getGlobal()->getMap().find("sorterSpillCompressor")->second;
+        ON_BLOCK_EXIT([&] { compressorParam->setFromString("snappy").ignore(); });
+
+        for (auto compressor : {"none", "snappy", "zlib"}) {
+            ASSERT_OK(compressorParam->setFromString(compressor));
+
+            unittest::TempDir tempDir("sortedFileWriterTests");
+            const SortOptions opts = SortOptions().TempDir(tempDir.path());
+            SortedFileWriter<IntWrapper, IntWrapper> writer(opts);
+            for (int i = 0; i < 100 * 1000; i++)
+                writer.addAlreadySorted(i, -i);
+            std::shared_ptr<IWIterator> iter(writer.done());
+
+            // Flip a byte in the middle of the first block.
+            boost::filesystem::directory_iterator file(tempDir.path());
+            ASSERT(file != boost::filesystem::directory_iterator());
+            {
+                std::fstream stream(file->path().string(),
+                                    std::ios::in | std::ios::out | std::ios::binary);
+                const std::streamoff offset = SpillBlockHeader::kSize + 100;
+                stream.seekg(offset);
+                char byte = static_cast<char>(stream.get());
+                stream.seekp(offset);
+                stream.put(static_cast<char>(~byte));
+                ASSERT(stream.good());
+            }
+
+            ASSERT_THROWS_CODE(
+                [&] {
+                    while (iter->more())
+                        iter->next();
+                }(),
+                AssertionException,
+                51091);
+        }
+    }
+};
+
 
 class MergeIteratorTests {
 public:
@@ -324,7 +372,125 @@ public:
     }
 };
 
+class NormalizedKeyPrefixTests {
+public:
+    void run() {
+        const std::vector<BSONObj> values = {
+            BSON("" << MINKEY),
+            BSON("" << BSONNULL),
+            BSON("" << std::numeric_limits<double>::quiet_NaN()),
+            BSON("" << -std::numeric_limits<double>::infinity()),
+            BSON("" << std::numeric_limits<long long>::min()),
+            BSON("" << -1.5),
+            BSON("" << -1),
+            BSON("" << -0.0),
+            BSON("" << 0),
+            BSON("" << Decimal128("0.1")),
+            BSON("" << 0.1),
+            BSON("" << 1),
+            BSON("" << (1LL << 60)),
+            BSON("" << (1LL << 60) + 1),
+            BSON("" << std::numeric_limits<double>::infinity()),
+            BSON("" << ""),
+            BSON("" << "a"),
+            BSON("" << "aaaaaaa"),
+            BSON("" << "aaaaaaab"),
+            BSON("" << "aaaaaaac"),
+            BSON("" << "b"),
+            BSON("" << BSON("a" << 1)),
+            BSON("" << OID("000000000000000000000000")),
+            BSON("" << OID("ffffffffffffffffffffffff")),
+            BSON("" << false),
+            BSON("" << true),
+            BSON("" << Date_t::fromMillisSinceEpoch(-1)),
+            BSON("" << Date_t::fromMillisSinceEpoch(1)),
+            BSON("" << Timestamp(1, 1)),
+            BSON("" << MAXKEY),
+        };
+
+        // Prefixes must never order two values differently from woCompare(), in either direction.
+        for (auto&& lhsObj : values) {
+            for (auto&& rhsObj : values) {
+                const BSONElement lhs = lhsObj.firstElement();
+                const BSONElement rhs = rhsObj.firstElement();
+                const int cmp = lhs.woCompare(rhs, /*considerFieldName*/ false);
+                for (bool ascending : {true, false}) {
+                    const uint64_t lhsPrefix =
+                        directedKeyPrefix(normalizedKeyPrefix(lhs), ascending);
+                    const uint64_t rhsPrefix =
+                        directedKeyPrefix(normalizedKeyPrefix(rhs), ascending);
+                    if (lhsPrefix < rhsPrefix) {
+                        ASSERT_LT(ascending ? cmp : -cmp, 0);
+                    } else if (lhsPrefix > rhsPrefix) {
+                        ASSERT_GT(ascending ? cmp : -cmp, 0);
+                    }
+                }
+            }
+        }
+
+        ASSERT_EQ(normalizedKeyPrefix(BSON("" << -0.0).firstElement()),
+                  normalizedKeyPrefix(BSON("" << 0).firstElement()));
+    }
+};
+
 namespace SorterTests {
+/**
+ * Orders by key and then by value, with a deliberately coarse normalized key prefix so that most
+ * pairs tie on the prefix and are ordered by the comparator.
+ */
+class PrefixIWComparator {
+public:
+    PrefixIWComparator(Direction dir) : _dir(dir) {}
+    int operator()(const IWPair& lhs, const IWPair& rhs) const {
+        if (lhs.first != rhs.first)
+            return (lhs.first < rhs.first ? -1 : 1) * _dir;
+        if (lhs.second != rhs.second)
+            return lhs.second < rhs.second ? -1 : 1;
+        return 0;
+    }
+
+    bool hasNormalizedKeyPrefix() const {
+        return true;
+    }
+    uint64_t normalizedKeyPrefix(const IWPair& data) const {
+        const uint64_t biased = static_cast<uint32_t>(static_cast<int>(data.first)) ^ (1u << 31);
+        return directedKeyPrefix(biased >> 4, _dir == ASC);
+    }
+
+private:
+    Direction _dir;
+};
+
+class NormalizedKeyPrefixSort : public ScopedGlobalServiceContextForTest {
+public:
+    void run() {
+        unittest::TempDir tempDir("sorterTests");
+        const SortOptions opts = SortOptions().TempDir(tempDir.path());
+
+        PseudoRandom random(1);
+        std::vector<IWPair> input;
+        for (int i = 0; i < 10 * 1000; i++) {
+            input.emplace_back(random.nextInt32(2000) - 1000, random.nextInt32(10));
+        }
+
+        for (Direction dir : {ASC, DESC}) {
+            const PrefixIWComparator comp(dir);
+            std::unique_ptr<IWSorter> sorter(IWSorter::make(opts, comp));
+            for (auto&& pair : input) {
+                sorter->add(pair.first, pair.second);
+            }
+
+            std::vector<IWPair> expected = input;
+            std::stable_sort(expected.begin(), expected.end(), [&](auto&& lhs, auto&& rhs) {
+                return comp(lhs, rhs) < 0;
+            });
+            using ExpectedIterator = InMemIterator<IntWrapper, IntWrapper>;
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                        std::make_shared<ExpectedIterator>(expected));
+        }
+    }
+};
+
 class Basic : public ScopedGlobalServiceContextForTest {
 public:
     virtual ~Basic() {}
@@ -509,6 +675,28 @@ public:
 };
 
 
+class SpillStats : public ScopedGlobalServiceContextForTest {
+public:
+    void run() {
+        unittest::TempDir tempDir("sorterTests");
+        const SortOptions opts =
+            SortOptions().TempDir(tempDir.path()).MaxMemoryUsageBytes(16 * 1024).ExtSortAllowed();
+
+        std::unique_ptr<IWSorter> sorter(IWSorter::make(opts, IWComparator(ASC)));
+        for (int i = 100 * 1000; i > 0; i--) {
+            sorter->add(i, -i);
+        }
+        ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                    make_shared<IntIterator>(1, 100 * 1000 + 1));
+
+        // Each spill writes one file.
+        const SorterSpillStats stats = sorter->spillStats();
+        ASSERT_EQ(stats.spills, sorter->numFiles());
+        ASSERT_GT(stats.spills, 1);
+        ASSERT_GT(stats.spilledBytes, 0);
+    }
+};
+
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     typedef LotsOfDataLittleMemory<Random> Parent;
@@ -541,12 +729,16 @@ public:
     void setupTests() {
         add<InMemIterTests>();
         add<SortedFileWriterAndFileIteratorTests>();
+        add<SortedFileWriterDetectsCorruption>();
         add<MergeIteratorTests>();
+        add<NormalizedKeyPrefixTests>();
+        add<SorterTests::NormalizedKeyPrefixSort>();
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::SpillStats>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -0,0 +1,324 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/spill_compression.h"
+
+#include <cstring>
+#include <limits>
+#include <snappy.h>
+#include <zlib.h>
+
+#include "mongo/config.h"
+
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+class NoopSpillCompressor final : public SpillCompressor {
+public:
+    Id id() const override {
+        return Id::kNone;
+    }
+
+    StringData name() const override {
+        return "none"_sd;
+    }
+
+    void compress(ConstDataRange input, std::string* output) const override {
+        output->assign(input.data(), input.length());
+    }
+
+    Status decompress(ConstDataRange input, DataRange output) const override {
+        if (input.length() != output.length()) {
+            return {ErrorCodes::BadValue, "uncompressed spill block has the wrong length"};
+        }
+        std::memcpy(const_cast<char*>(output.data()), input.data(), input.length());
+        return Status::OK();
+    }
+};
+
+class SnappySpillCompressor final : public SpillCompressor {
+public:
+    Id id() const override {
+        return Id::kSnappy;
+    }
+
+    StringData name() const override {
+        return "snappy"_sd;
+    }
+
+    void compress(ConstDataRange input, std::string* output) const override {
+        snappy::Compress(input.data(), input.length(), output);
+    }
+
+    Status decompress(ConstDataRange input, DataRange output) const override {
+        size_t uncompressedSize;
+        if (!snappy::GetUncompressedLength(input.data(), input.length(), &uncompressedSize) ||
+            uncompressedSize != output.length()) {
+            return {ErrorCodes::BadValue, "couldn't get uncompressed length"};
+        }
+        if (!snappy::RawUncompress(
+                input.data(), input.length(), const_cast<char*>(output.data()))) {
+            return {ErrorCodes::BadValue, "snappy decompression failed"};
+        }
+        return Status::OK();
+    }
+};
+
+class ZlibSpillCompressor final : public SpillCompressor {
+public:
+    Id id() const override {
+        return Id::kZlib;
+    }
+
+    StringData name() const override {
+        return "zlib"_sd;
+    }
+
+    void compress(ConstDataRange input, std::string* output) const override {
+        uLongf length = ::compressBound(input.length());
+        output->resize(length);
+        int ret = ::compress2(reinterpret_cast<Bytef*>(&(*output)[0]),
+                              &length,
+                              reinterpret_cast<const Bytef*>(input.data()),
+                              input.length(),
+                              Z_BEST_SPEED);
+        // compressBound() guarantees room for the output, so this can only fail on bad memory.
+        invariant(ret == Z_OK);
+        output->resize(length);
+    }
+
+    Status decompress(ConstDataRange input, DataRange output) const override {
+        uLongf length = output.length();
+        int ret = ::uncompress(reinterpret_cast<Bytef*>(const_cast<char*>(output.data())),
+                               &length,
+                               reinterpret_cast<const Bytef*>(input.data()),
+                               input.length());
+        if (ret != Z_OK || length != output.length()) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "zlib decompression failed with code " << ret};
+        }
+        return Status::OK();
+    }
+};
+
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+class ZstdSpillCompressor final : public SpillCompressor {
+public:
+    Id id() const override {
+        return Id::kZstd;
+    }
+
+    StringData name() const override {
+        return "zstd"_sd;
+    }
+
+    void compress(ConstDataRange input, std::string* output) const override {
+        output->resize(ZSTD_compressBound(input.length()));
+        const size_t length = ZSTD_compress(
+            &(*output)[0], output->size(), input.data(), input.length(), kCompressionLevel);
+        // ZSTD_compressBound() guarantees room for the output, so this can only fail on bad
+        // memory.
+        invariant(!ZSTD_isError(length));
+        output->resize(length);
+    }
+
+    Status decompress(ConstDataRange input, DataRange output) const override {
+        const size_t length = ZSTD_decompress(const_cast<char*>(output.data()),
+                                              output.length(),
+                                              input.data(),
+                                              input.length());
+        if (ZSTD_isError(length)) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << "zstd decompression failed: " << ZSTD_getErrorName(length)};
+        }
+        if (length != output.length()) {
+            return {ErrorCodes::BadValue, "zstd spill block has the wrong length"};
+        }
+        return Status::OK();
+    }
+
+private:
+    // Spilling is on the sort's critical path, so favour speed as Z_BEST_SPEED does for zlib.
+    static constexpr int kCompressionLevel = 1;
+};
+#endif
+
+const NoopSpillCompressor noopSpillCompressor;
+const SnappySpillCompressor snappySpillCompressor;
+const ZlibSpillCompressor zlibSpillCompressor;
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+const ZstdSpillCompressor zstdSpillCompressor;
+#endif
+
+const SpillCompressor* const kSpillCompressors[] = {
+    &noopSpillCompressor,
+    &snappySpillCompressor,
+    &zlibSpillCompressor,
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+    &zstdSpillCompressor,
+#endif
+};
+
+/**
+ * Codec for new spill blocks. Blocks already on disk keep the codec they were written with, so
+ * this may change at any time.
+ */
+class SorterSpillCompressor final : public ServerParameter {
+public:
+    SorterSpillCompressor()
+        : ServerParameter(ServerParameterSet::getGlobal(), "sorterSpillCompressor") {}
+
+    void append(OperationContext* opCtx, BSONObjBuilder& b, const std::string& name) override {
+        b.append(name, get().name());
+    }
+
+    Status set(const BSONElement& newValueElement) override {
+        if (newValueElement.type() != String) {
+            return {ErrorCodes::BadValue, "sorterSpillCompressor must be a string"};
+        }
+        return setFromString(newValueElement.str());
+    }
+
+    Status setFromString(const std::string& name) override {
+        auto compressor = getSpillCompressor(name);
+        if (!compressor.isOK()) {
+            return compressor.getStatus();
+        }
+        log() << "sorter spill files are now compressed with " << name;
+        _id.store(static_cast<int>(compressor.getValue()->id()));
+        return Status::OK();
+    }
+
+    const SpillCompressor& get() const {
+        return *getSpillCompressor(static_cast<SpillCompressor::Id>(_id.load()));
+    }
+
+private:
+    AtomicWord<int> _id{static_cast<int>(SpillCompressor::Id::kSnappy)};
+} sorterSpillCompressor;
+
+}  // namespace
+
+const SpillCompressor* getSpillCompressor(SpillCompressor::Id id) {
+    for (auto compressor : kSpillCompressors) {
+        if (compressor->id() == id) {
+            return compressor;
+        }
+    }
+    return nullptr;
+}
+
+StatusWith<const SpillCompressor*> getSpillCompressor(StringData name) {
+    for (auto compressor : kSpillCompressors) {
+        if (compressor->name() == name) {
+            return compressor;
+        }
+    }
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+    constexpr auto kExpected = "none, snappy, zlib or zstd"_sd;
+#else
+    constexpr auto kExpected = "none, snappy or zlib"_sd;
+#endif
+    return {ErrorCodes::BadValue,
+            str::stream() << "unknown sorter spill compressor '" << name
+                          << "', expected one of " << kExpected};
+}
+
+const SpillCompressor& getConfiguredSpillCompressor() {
+    return sorterSpillCompressor.get();
+}
+
+uint32_t spillBlockChecksum(const SpillBlockHeader& header, ConstDataRange stored) {
+    char fields[SpillBlockHeader::kSize];
+    SpillBlockHeader unchecked = header;
+    unchecked.checksum = 0;
+    unchecked.writeTo(fields);
+
+    uLong crc = ::crc32(0, nullptr, 0);
+    crc = ::crc32(crc, reinterpret_cast<const Bytef*>(fields), sizeof(fields));
+    crc = ::crc32(crc, reinterpret_cast<const Bytef*>(stored.data()), stored.length());
+    return static_cast<uint32_t>(crc);
+}
+
+void SpillBlockHeader::writeTo(char* out) const {
+    DataView view(out);
+    size_t offset = 0;
+    view.write<LittleEndian<int32_t>>(storedSize, offset);
+    offset += sizeof(int32_t);
+    view.write<LittleEndian<uint8_t>>(static_cast<uint8_t>(compressor), offset);
+    offset += sizeof(uint8_t);
+    view.write<LittleEndian<uint32_t>>(uncompressedSize, offset);
+    offset += sizeof(uint32_t);
+    view.write<LittleEndian<uint32_t>>(checksum, offset);
+}
+
+StatusWith<SpillBlockHeader> SpillBlockHeader::parse(const char* in) {
+    ConstDataView view(in);
+    SpillBlockHeader header;
+    size_t offset = 0;
+    header.storedSize = view.read<LittleEndian<int32_t>>(offset);
+    offset += sizeof(int32_t);
+    const uint8_t compressor = view.read<LittleEndian<uint8_t>>(offset);
+    offset += sizeof(uint8_t);
+    header.uncompressedSize = view.read<LittleEndian<uint32_t>>(offset);
+    offset += sizeof(uint32_t);
+    header.checksum = view.read<LittleEndian<uint32_t>>(offset);
+
+    if (header.storedSize < 0 ||
+        header.uncompressedSize > uint32_t(std::numeric_limits<int32_t>::max())) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "invalid spill block sizes " << header.storedSize << " and "
+                              << header.uncompressedSize};
+    }
+    header.compressor = static_cast<SpillCompressor::Id>(compressor);
+    if (!getSpillCompressor(header.compressor)) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "unknown spill block compressor " << int(compressor)};
+    }
+    return header;
+}
+
+}  // namespace sorter
+}  // namespace mongo
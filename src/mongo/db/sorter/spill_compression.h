@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "mongo/base/data_range.h"
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+namespace sorter {
+
+/**
+ * A codec for the blocks of a sorter spill file. Spill files are written and read by the same
+ * process, so a block records the id of the codec that wrote it and the reader looks it up with
+ * getSpillCompressor(id), whatever codec is configured by then.
+ */
+class SpillCompressor {
+public:
+    /** Persisted in block headers; only append new ids. */
+    enum class Id : uint8_t {
+        kNone = 0,
+        kSnappy = 1,
+        kZlib = 2,
+        // Only available in builds with MONGO_CONFIG_HAVE_ZSTD.
+        kZstd = 3,
+    };
+
+    virtual ~SpillCompressor() = default;
+
+    virtual Id id() const = 0;
+    virtual StringData name() const = 0;
+
+    /**
+     * Compresses 'input', replacing the contents of 'output'.
+     */
+    virtual void compress(ConstDataRange input, std::string* output) const = 0;
+
+    /**
+     * Decompresses 'input' into 'output', which must be exactly as long as the uncompressed data.
+     * Returns an error if 'input' is not a valid block of that length.
+     */
+    virtual Status decompress(ConstDataRange input, DataRange output) const = 0;
+};
+
+/**
+ * The codec with the given id, or nullptr if there is none.
+ */
+const SpillCompressor* getSpillCompressor(SpillCompressor::Id id);
+
+/**
+ * The codec with the given name, one of "none", "snappy", "zlib" or, in builds with zstd, "zstd".
+ */
+StatusWith<const SpillCompressor*> getSpillCompressor(StringData name);
+
+/**
+ * The codec new spill blocks are written with, selected by the sorterSpillCompressor server
+ * parameter.
+ */
+const SpillCompressor& getConfiguredSpillCompressor();
+
+/**
+ * The fixed-size header in front of each block of a spill file.
+ */
+struct SpillBlockHeader {
+    static constexpr size_t kSize = sizeof(int32_t) + sizeof(uint8_t) + 2 * sizeof(uint32_t);
+
+    int32_t storedSize = 0;
+    SpillCompressor::Id compressor = SpillCompressor::Id::kNone;
+    uint32_t uncompressedSize = 0;
+    uint32_t checksum = 0;
+
+    /**
+     * Writes the header to 'out', which has room for kSize bytes.
+     */
+    void writeTo(char* out) const;
+
+    /**
+     * Reads a header written by writeTo(), rejecting unknown codecs and negative sizes.
+     */
+    static StatusWith<SpillBlockHeader> parse(const char* in);
+};
+
+/**
+ * Checksum of a block: the header fields other than the checksum itself, and the bytes as stored
+ * in the file, i.e. after compression and encryption.
+ */
+uint32_t spillBlockChecksum(const SpillBlockHeader& header, ConstDataRange stored);
+
+}  // namespace sorter
+}  // namespace mongo
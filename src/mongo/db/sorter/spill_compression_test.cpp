@@ -0,0 +1,231 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/spill_compression.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/config.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+const SpillCompressor::Id kAllCompressors[] = {
+    SpillCompressor::Id::kNone,
+    SpillCompressor::Id::kSnappy,
+    SpillCompressor::Id::kZlib,
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+    SpillCompressor::Id::kZstd,
+#endif
+};
+
+// The codecs that actually compress.
+const SpillCompressor::Id kCompressingCompressors[] = {
+    SpillCompressor::Id::kSnappy,
+    SpillCompressor::Id::kZlib,
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+    SpillCompressor::Id::kZstd,
+#endif
+};
+
+std::vector<std::string> makeInputs() {
+    PseudoRandom random(42);
+    std::string repetitive;
+    for (int i = 0; i < 64 * 1024; ++i) {
+        repetitive.push_back("abcdefgh"[i % 8]);
+    }
+    std::string noise;
+    for (int i = 0; i < 64 * 1024; ++i) {
+        noise.push_back(static_cast<char>(random.nextInt32()));
+    }
+    return {"", "x", repetitive, noise};
+}
+
+/**
+ * Encodes 'input' the way SortedFileWriter does, without encryption.
+ */
+std::string encodeBlock(const SpillCompressor& compressor,
+                        const std::string& input,
+                        SpillBlockHeader* header) {
+    std::string stored;
+    compressor.compress(ConstDataRange(input.data(), input.size()), &stored);
+    header->storedSize = stored.size();
+    header->compressor = compressor.id();
+    header->uncompressedSize = input.size();
+    header->checksum = spillBlockChecksum(*header, ConstDataRange(stored.data(), stored.size()));
+    return stored;
+}
+
+TEST(SpillCompressionTest, LookupByIdAndName) {
+    for (auto id : kAllCompressors) {
+        const SpillCompressor* compressor = getSpillCompressor(id);
+        ASSERT(compressor);
+        ASSERT(compressor->id() == id);
+
+        auto byName = getSpillCompressor(compressor->name());
+        ASSERT_OK(byName.getStatus());
+        ASSERT_EQ(byName.getValue(), compressor);
+    }
+
+    ASSERT_FALSE(getSpillCompressor(static_cast<SpillCompressor::Id>(200)));
+    ASSERT_EQ(getSpillCompressor("lz77").getStatus(), ErrorCodes::BadValue);
+#ifndef MONGO_CONFIG_HAVE_ZSTD
+    ASSERT_FALSE(getSpillCompressor(SpillCompressor::Id::kZstd));
+    ASSERT_EQ(getSpillCompressor("zstd").getStatus(), ErrorCodes::BadValue);
+#endif
+    ASSERT(getConfiguredSpillCompressor().id() == SpillCompressor::Id::kSnappy);
+}
+
+TEST(SpillCompressionTest, RoundTrip) {
+    for (auto id : kAllCompressors) {
+        const SpillCompressor& compressor = *getSpillCompressor(id);
+        for (const auto& input : makeInputs()) {
+            SpillBlockHeader header;
+            std::string stored = encodeBlock(compressor, input, &header);
+
+            std::string output(input.size(), '\0');
+            ASSERT_OK(compressor.decompress(ConstDataRange(stored.data(), stored.size()),
+                                            DataRange(&output[0], output.size())));
+            ASSERT(output == input);
+        }
+    }
+}
+
+TEST(SpillCompressionTest, CompressesRepetitiveInput) {
+    const std::string input = makeInputs()[2];
+    for (auto id : kCompressingCompressors) {
+        std::string stored;
+        getSpillCompressor(id)->compress(ConstDataRange(input.data(), input.size()), &stored);
+        ASSERT_LT(stored.size(), input.size() / 10);
+    }
+}
+
+TEST(SpillCompressionTest, ChecksumDetectsCorruptBytes) {
+    for (auto id : kAllCompressors) {
+        const SpillCompressor& compressor = *getSpillCompressor(id);
+        for (const auto& input : makeInputs()) {
+            SpillBlockHeader header;
+            std::string stored = encodeBlock(compressor, input, &header);
+            for (size_t i = 0; i < stored.size(); i += std::max<size_t>(1, stored.size() / 64)) {
+                std::string corrupt = stored;
+                corrupt[i] ^= 0x10;
+                const ConstDataRange range(corrupt.data(), corrupt.size());
+                ASSERT_NE(spillBlockChecksum(header, range), header.checksum);
+            }
+        }
+    }
+}
+
+TEST(SpillCompressionTest, ChecksumCoversHeader) {
+    const std::string input = makeInputs()[2];
+    SpillBlockHeader header;
+    std::string stored =
+        encodeBlock(*getSpillCompressor(SpillCompressor::Id::kZlib), input, &header);
+    const ConstDataRange range(stored.data(), stored.size());
+
+    SpillBlockHeader otherCompressor = header;
+    otherCompressor.compressor = SpillCompressor::Id::kSnappy;
+    ASSERT_NE(spillBlockChecksum(otherCompressor, range), header.checksum);
+
+    SpillBlockHeader otherSize = header;
+    otherSize.uncompressedSize += 1;
+    ASSERT_NE(spillBlockChecksum(otherSize, range), header.checksum);
+}
+
+TEST(SpillCompressionTest, DecompressRejectsTruncatedInput) {
+    const std::string input = makeInputs()[3];
+    for (auto id : kCompressingCompressors) {
+        const SpillCompressor& compressor = *getSpillCompressor(id);
+        SpillBlockHeader header;
+        std::string stored = encodeBlock(compressor, input, &header);
+
+        std::string output(input.size(), '\0');
+        ASSERT_NOT_OK(compressor.decompress(ConstDataRange(stored.data(), stored.size() / 2),
+                                            DataRange(&output[0], output.size())));
+    }
+}
+
+TEST(SpillCompressionTest, DecompressRejectsWrongLength) {
+    const std::string input = makeInputs()[2];
+    for (auto id : kAllCompressors) {
+        const SpillCompressor& compressor = *getSpillCompressor(id);
+        SpillBlockHeader header;
+        std::string stored = encodeBlock(compressor, input, &header);
+
+        std::string output(input.size() + 1, '\0');
+        ASSERT_NOT_OK(compressor.decompress(ConstDataRange(stored.data(), stored.size()),
+                                            DataRange(&output[0], output.size())));
+    }
+}
+
+TEST(SpillCompressionTest, HeaderRoundTrip) {
+    SpillBlockHeader header;
+    header.storedSize = 12345;
+    header.compressor = SpillCompressor::Id::kZlib;
+    header.uncompressedSize = 65536;
+    header.checksum = 0xdeadbeef;
+
+    char buffer[SpillBlockHeader::kSize];
+    header.writeTo(buffer);
+    auto parsed = SpillBlockHeader::parse(buffer);
+    ASSERT_OK(parsed.getStatus());
+    ASSERT_EQ(parsed.getValue().storedSize, header.storedSize);
+    ASSERT(parsed.getValue().compressor == header.compressor);
+    ASSERT_EQ(parsed.getValue().uncompressedSize, header.uncompressedSize);
+    ASSERT_EQ(parsed.getValue().checksum, header.checksum);
+}
+
+TEST(SpillCompressionTest, HeaderRejectsUnknownCompressor) {
+    SpillBlockHeader header;
+    header.storedSize = 10;
+    header.uncompressedSize = 10;
+
+    char buffer[SpillBlockHeader::kSize];
+    header.writeTo(buffer);
+    buffer[sizeof(int32_t)] = 100;
+    ASSERT_EQ(SpillBlockHeader::parse(buffer).getStatus(), ErrorCodes::BadValue);
+}
+
+TEST(SpillCompressionTest, HeaderRejectsNegativeSize) {
+    SpillBlockHeader header;
+    header.storedSize = -10;
+
+    char buffer[SpillBlockHeader::kSize];
+    header.writeTo(buffer);
+    ASSERT_EQ(SpillBlockHeader::parse(buffer).getStatus(), ErrorCodes::BadValue);
+}
+
+}  // namespace
+}  // namespace sorter
+}  // namespace mongo
@@ -0,0 +1,167 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/spill_scheduler.h"
+
+#include <algorithm>
+#include <mutex>
+
+#include "mongo/base/counter.h"
+#include "mongo/base/status.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/coro_sync.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/destructor_guard.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+MONGO_EXPORT_SERVER_PARAMETER(sorterBackgroundSpill, bool, true);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(sorterSpillMaxThreads, int, 4);
+
+namespace {
+
+Counter64 spillCounter;
+Counter64 backgroundSpillCounter;
+Counter64 spilledBytesCounter;
+Counter64 spillStallMicrosCounter;
+
+ServerStatusMetricField<Counter64> displaySpills("sorter.spills", &spillCounter);
+ServerStatusMetricField<Counter64> displayBackgroundSpills("sorter.backgroundSpills",
+                                                           &backgroundSpillCounter);
+ServerStatusMetricField<Counter64> displaySpilledBytes("sorter.spilledBytes",
+                                                       &spilledBytesCounter);
+ServerStatusMetricField<Counter64> displaySpillStallMicros("sorter.spillStallMicros",
+                                                           &spillStallMicrosCounter);
+
+ThreadPool* spillPool() {
+    static ThreadPool* pool = [] {
+        ThreadPool::Options options;
+        options.poolName = "SorterSpill";
+        options.threadNamePrefix = "SorterSpill-";
+        options.minThreads = 0;
+        options.maxThreads = static_cast<size_t>(std::max(1, sorterSpillMaxThreads));
+        // Leaked on purpose: spills may still be running during static destruction.
+        auto pool = new ThreadPool(options);
+        pool->startup();
+        return pool;
+    }();
+    return pool;
+}
+
+}  // namespace
+
+void SorterSpillStats::appendTo(BSONObjBuilder* builder) const {
+    builder->appendNumber("spills", spills);
+    builder->appendNumber("spilledBytes", spilledBytes);
+    builder->appendNumber("spillStallMicros", durationCount<Microseconds>(spillStall));
+}
+
+struct SpillScheduler::InFlight {
+    coro::Mutex mutex;
+    coro::ConditionVariable cv;
+    bool done = false;
+    Status status = Status::OK();
+    long long bytes = 0;
+};
+
+SpillScheduler::SpillScheduler() : _background(sorterBackgroundSpill.load()) {}
+
+SpillScheduler::~SpillScheduler() {
+    DESTRUCTOR_GUARD(waitForSpills();)
+}
+
+void SpillScheduler::spill(SpillJob job) {
+    if (_background) {
+        waitForSpills();
+
+        auto inFlight = std::make_shared<InFlight>();
+        auto sharedJob = std::make_shared<SpillJob>(std::move(job));
+        Status scheduled = spillPool()->schedule([inFlight, sharedJob] {
+            Status status = Status::OK();
+            long long bytes = 0;
+            try {
+                bytes = (*sharedJob)();
+            } catch (...) {
+                status = exceptionToStatus();
+            }
+
+            std::lock_guard<coro::Mutex> lk(inFlight->mutex);
+            inFlight->status = std::move(status);
+            inFlight->bytes = bytes;
+            inFlight->done = true;
+            inFlight->cv.notify_all();
+        });
+        if (scheduled.isOK()) {
+            _inFlight = std::move(inFlight);
+            backgroundSpillCounter.increment();
+            return;
+        }
+
+        // The pool is shutting down, write the run ourselves.
+        job = std::move(*sharedJob);
+    }
+
+    Timer timer;
+    const long long bytes = job();
+    _stats.spillStall += timer.elapsed();
+    spillStallMicrosCounter.increment(timer.micros());
+    _finished(bytes);
+}
+
+void SpillScheduler::waitForSpills() {
+    if (!_inFlight) {
+        return;
+    }
+    auto inFlight = std::move(_inFlight);
+    _inFlight.reset();
+
+    Timer timer;
+    {
+        std::unique_lock<coro::Mutex> lk(inFlight->mutex);
+        inFlight->cv.wait(lk, [&] { return inFlight->done; });
+    }
+    _stats.spillStall += timer.elapsed();
+    spillStallMicrosCounter.increment(timer.micros());
+
+    uassertStatusOK(inFlight->status);
+    _finished(inFlight->bytes);
+}
+
+void SpillScheduler::_finished(long long bytes) {
+    ++_stats.spills;
+    _stats.spilledBytes += bytes;
+    spillCounter.increment();
+    spilledBytesCounter.increment(bytes);
+}
+
+}  // namespace mongo
@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Spill activity of a single Sorter or $group stage.
+ */
+struct SorterSpillStats {
+    long long spills = 0;
+    long long spilledBytes = 0;  // Bytes written to spill files, after compression.
+    Microseconds spillStall{0};  // Time the owner spent waiting for spills to be written.
+
+    void appendTo(BSONObjBuilder* builder) const;
+};
+
+/**
+ * Writes the spill runs of a single Sorter or $group stage.
+ *
+ * When the sorterBackgroundSpill server parameter is set at construction, runs are sorted and
+ * written on a process-wide pool of at most sorterSpillMaxThreads threads, so that the owner can
+ * keep consuming input into a second buffer while the previous run is flushed. At most one run
+ * per owner is in flight: starting another one, or collecting the results, waits for it. Waiting
+ * yields the coroutine rather than blocking the thread group it runs on.
+ *
+ * Owners that spill in the background must keep each buffer to half of their memory limit, see
+ * spillThreshold().
+ */
+class SpillScheduler {
+    MONGO_DISALLOW_COPYING(SpillScheduler);
+
+public:
+    /**
+     * Sorts and writes one run, returning the number of bytes written. Runs on another thread
+     * when spilling in the background, so it must own everything it touches.
+     */
+    using SpillJob = std::function<long long()>;
+
+    SpillScheduler();
+
+    /**
+     * Waits for the run in flight, if any. Its errors are logged and otherwise ignored.
+     */
+    ~SpillScheduler();
+
+    bool inBackground() const {
+        return _background;
+    }
+
+    /**
+     * The memory usage at which an owner with the given limit should spill.
+     */
+    size_t spillThreshold(size_t maxMemoryUsageBytes) const {
+        return _background ? maxMemoryUsageBytes / 2 : maxMemoryUsageBytes;
+    }
+
+    /**
+     * Runs 'job' inline or, when spilling in the background, hands it to the spill pool once the
+     * previous run is written. Throws if the previous run failed.
+     */
+    void spill(SpillJob job);
+
+    /**
+     * Waits for the run in flight, if any, and throws if it failed. Must be called before reading
+     * back spilled runs.
+     */
+    void waitForSpills();
+
+    const SorterSpillStats& stats() const {
+        return _stats;
+    }
+
+private:
+    struct InFlight;
+
+    void _finished(long long bytes);
+
+    const bool _background;
+    std::shared_ptr<InFlight> _inFlight;
+    SorterSpillStats _stats;
+};
+
+}  // namespace mongo
@@ -191,12 +191,27 @@ void NetworkCounter::hitLogicalOut(long long bytes) {
     }
 }
 
+void NetworkCounter::hitReplyWrite(long long replies) {
+    _replyWrites.writes.fetchAndAdd(1);
+    _replyWrites.replies.fetchAndAdd(replies);
+}
+
+void NetworkCounter::hitBufferedRequestCheck() {
+    _replyWrites.bufferedRequestChecks.fetchAndAdd(1);
+}
+
 void NetworkCounter::append(BSONObjBuilder& b) {
     b.append("bytesIn", static_cast<long long>(_together.logicalBytesIn.loadRelaxed()));
     b.append("bytesOut", static_cast<long long>(_logicalBytesOut.loadRelaxed()));
     b.append("physicalBytesIn", static_cast<long long>(_physicalBytesIn.loadRelaxed()));
     b.append("physicalBytesOut", static_cast<long long>(_physicalBytesOut.loadRelaxed()));
     b.append("numRequests", static_cast<long long>(_together.requests.loadRelaxed()));
+
+    BSONObjBuilder coalesced(b.subobjStart("coalescedReplies"));
+    coalesced.append("writes", static_cast<long long>(_replyWrites.writes.loadRelaxed()));
+    coalesced.append("replies", static_cast<long long>(_replyWrites.replies.loadRelaxed()));
+    coalesced.append("bufferedRequestChecks",
+                     static_cast<long long>(_replyWrites.bufferedRequestChecks.loadRelaxed()));
 }
 
 
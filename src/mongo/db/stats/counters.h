@@ -103,6 +103,12 @@ public:
     void hitLogicalIn(long long bytes);
     void hitLogicalOut(long long bytes);
 
+    // Increment the counters for one write syscall that carried 'replies' coalesced replies
+    void hitReplyWrite(long long replies);
+
+    // Increment the counter for one check whether a session's next request is already buffered
+    void hitBufferedRequestCheck();
+
     void append(BSONObjBuilder& b);
 
 private:
@@ -120,6 +126,13 @@ private:
                   "cache line spill");
 
     CacheAligned<AtomicInt64> _logicalBytesOut{0};
+
+    struct ReplyWrites {
+        AtomicInt64 writes{0};
+        AtomicInt64 replies{0};
+        AtomicInt64 bufferedRequestChecks{0};
+    };
+    CacheAligned<ReplyWrites> _replyWrites{};
 };
 
 extern NetworkCounter networkCounter;
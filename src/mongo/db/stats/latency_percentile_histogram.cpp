@@ -0,0 +1,157 @@
+/**
+ *    Copyright (C) 2025 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/latency_percentile_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+// Precision of the per-namespace latency percentiles. Each extra bit halves the error and doubles
+// the counters a histogram may allocate: 272 counters at the default of 3, up to 3840 at 7.
+// Every namespace holds four histograms (reads, writes, commands, transactions) in each of the
+// reservedThreadNum + 1 shards of Top's usage map, so one namespace may use up to about
+// 8.7KB x (reservedThreadNum + 1) at the default and about 123KB x (reservedThreadNum + 1) at 7.
+int latencyHistogramSubBucketBits = 3;
+MONGO_COMPILER_VARIABLE_UNUSED auto _exportedLatencyHistogramSubBucketBits =
+    (new ExportedServerParameter<int, ServerParameterType::kStartupOnly>(
+        ServerParameterSet::getGlobal(),
+        "latencyHistogramSubBucketBits",
+        &latencyHistogramSubBucketBits))
+        -> withValidator([](const int& potentialNewValue) {
+            if (potentialNewValue < LatencyPercentileHistogram::kMinSubBucketBits ||
+                potentialNewValue > LatencyPercentileHistogram::kMaxSubBucketBits) {
+                return Status(ErrorCodes::BadValue,
+                              "latencyHistogramSubBucketBits must be between 1 and 7, inclusive");
+            }
+            return Status::OK();
+        });
+
+}  // namespace
+
+LatencyPercentileHistogram::LatencyPercentileHistogram()
+    : LatencyPercentileHistogram(latencyHistogramSubBucketBits) {}
+
+LatencyPercentileHistogram::LatencyPercentileHistogram(int subBucketBits)
+    : _subBucketBits(subBucketBits) {
+    invariant(subBucketBits >= kMinSubBucketBits && subBucketBits <= kMaxSubBucketBits);
+}
+
+size_t LatencyPercentileHistogram::bucketCount(int subBucketBits) {
+    return static_cast<size_t>(kMaxExponent - subBucketBits + 1) << subBucketBits;
+}
+
+// Values below 2^bits have a bucket each. A value in [2^e, 2^(e+1)) lands in one of the 2^bits
+// sub-buckets of width 2^(e-bits) that follow the buckets of all smaller powers of two.
+size_t LatencyPercentileHistogram::_getBucket(uint64_t latency) const {
+    const uint64_t subBuckets = 1ULL << _subBucketBits;
+    latency = std::min<uint64_t>(latency, (1ULL << kMaxExponent) - 1);
+    if (latency < subBuckets) {
+        return latency;
+    }
+
+    const int log2 = 63 - countLeadingZeros64(latency);
+    const int shift = log2 - _subBucketBits;
+    return ((shift + 1) << _subBucketBits) + ((latency >> shift) - subBuckets);
+}
+
+uint64_t LatencyPercentileHistogram::_getBucketUpperBound(size_t bucket) const {
+    const uint64_t subBuckets = 1ULL << _subBucketBits;
+    if (bucket < subBuckets) {
+        return bucket;
+    }
+
+    const int shift = static_cast<int>(bucket >> _subBucketBits) - 1;
+    const uint64_t lowerBound = (subBuckets + (bucket & (subBuckets - 1))) << shift;
+    return lowerBound + (1ULL << shift) - 1;
+}
+
+void LatencyPercentileHistogram::increment(uint64_t latency) {
+    const size_t bucket = _getBucket(latency);
+    if (bucket >= _buckets.size()) {
+        _buckets.resize(bucket + 1);
+    }
+    _buckets[bucket]++;
+    _count++;
+    _max = std::max(_max, latency);
+}
+
+uint64_t LatencyPercentileHistogram::percentile(double quantile) const {
+    if (_count == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = std::min(
+        _count, std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * _count))));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < _buckets.size(); ++bucket) {
+        seen += _buckets[bucket];
+        if (seen >= rank) {
+            return std::min(_getBucketUpperBound(bucket), _max);
+        }
+    }
+    return _max;
+}
+
+void LatencyPercentileHistogram::append(BSONObjBuilder* builder) const {
+    builder->append("p50", static_cast<long long>(percentile(0.5)));
+    builder->append("p90", static_cast<long long>(percentile(0.9)));
+    builder->append("p99", static_cast<long long>(percentile(0.99)));
+    builder->append("p999", static_cast<long long>(percentile(0.999)));
+    builder->append("max", static_cast<long long>(_max));
+}
+
+void LatencyPercentileHistogram::reset() {
+    _count = 0;
+    _max = 0;
+    std::vector<uint64_t>().swap(_buckets);
+}
+
+void LatencyPercentileHistogram::operator+=(const LatencyPercentileHistogram& other) {
+    invariant(_subBucketBits == other._subBucketBits);
+    if (other._buckets.size() > _buckets.size()) {
+        _buckets.resize(other._buckets.size());
+    }
+    for (size_t i = 0; i < other._buckets.size(); ++i) {
+        _buckets[i] += other._buckets[i];
+    }
+    _count += other._count;
+    _max = std::max(_max, other._max);
+}
+
+}  // namespace mongo
@@ -0,0 +1,113 @@
+/**
+ *    Copyright (C) 2025 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * A log-linear latency histogram in the style of HdrHistogram, from which percentiles can be read
+ * with a bounded relative error.
+ *
+ * Latencies below 2^subBucketBits microseconds are counted exactly. Every larger power-of-two range
+ * is split into 2^subBucketBits equal sub-buckets, so a reported percentile exceeds the true one by
+ * at most 1/2^subBucketBits of it. Latencies of 2^kMaxExponent microseconds or more share the last
+ * bucket.
+ *
+ * Counters are allocated up to the bucket of the largest latency recorded, so memory follows the
+ * spread of latencies seen and never exceeds bucketCount(subBucketBits) counters.
+ *
+ * Note: This class is not thread-safe.
+ */
+class LatencyPercentileHistogram {
+public:
+    // About 19 hours.
+    static constexpr int kMaxExponent = 36;
+    static constexpr int kMinSubBucketBits = 1;
+    static constexpr int kMaxSubBucketBits = 7;
+
+    /**
+     * Uses the precision set by the latencyHistogramSubBucketBits server parameter.
+     */
+    LatencyPercentileHistogram();
+    explicit LatencyPercentileHistogram(int subBucketBits);
+
+    /**
+     * The most counters a histogram of the given precision allocates.
+     */
+    static size_t bucketCount(int subBucketBits);
+
+    void increment(uint64_t latency);
+
+    /**
+     * Returns the upper bound of the bucket holding the entry at 'quantile', in [0, 1], capped at
+     * the largest latency recorded. Returns 0 if the histogram is empty.
+     */
+    uint64_t percentile(double quantile) const;
+
+    uint64_t count() const {
+        return _count;
+    }
+
+    uint64_t max() const {
+        return _max;
+    }
+
+    /**
+     * Appends the p50, p90, p99 and p999 latencies and the maximum latency.
+     */
+    void append(BSONObjBuilder* builder) const;
+
+    /**
+     * Forgets all entries and releases the counters.
+     */
+    void reset();
+
+    /**
+     * Adds the entries of 'other', which must have the same precision.
+     */
+    void operator+=(const LatencyPercentileHistogram& other);
+
+private:
+    size_t _getBucket(uint64_t latency) const;
+
+    uint64_t _getBucketUpperBound(size_t bucket) const;
+
+    int _subBucketBits;
+    uint64_t _count = 0;
+    uint64_t _max = 0;
+    std::vector<uint64_t> _buckets;
+};
+
+}  // namespace mongo
@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2025 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/latency_percentile_histogram.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(LatencyPercentileHistogram, EmptyHistogramReportsZero) {
+    LatencyPercentileHistogram hist(3);
+    ASSERT_EQUALS(hist.count(), 0U);
+    ASSERT_EQUALS(hist.percentile(0.99), 0U);
+}
+
+TEST(LatencyPercentileHistogram, SmallLatenciesAreExact) {
+    LatencyPercentileHistogram hist(3);
+    for (uint64_t latency = 0; latency < 8; latency++) {
+        hist.increment(latency);
+    }
+    for (uint64_t latency = 0; latency < 8; latency++) {
+        ASSERT_EQUALS(hist.percentile((latency + 1) / 8.0), latency);
+    }
+}
+
+TEST(LatencyPercentileHistogram, RelativeErrorIsBoundedByPrecision) {
+    const uint64_t kOutlier = 1ULL << 40;
+    for (int bits = LatencyPercentileHistogram::kMinSubBucketBits;
+         bits <= LatencyPercentileHistogram::kMaxSubBucketBits;
+         bits++) {
+        for (uint64_t latency = 1; latency < (1ULL << 30); latency = latency * 3 + 1) {
+            LatencyPercentileHistogram hist(bits);
+            hist.increment(latency);
+            hist.increment(kOutlier);
+            // The outlier keeps the reported value from being capped at the maximum.
+            const uint64_t reported = hist.percentile(0.5);
+            ASSERT_GREATER_THAN_OR_EQUALS(reported, latency);
+            ASSERT_LESS_THAN_OR_EQUALS(reported, latency + (latency >> bits));
+        }
+    }
+}
+
+TEST(LatencyPercentileHistogram, PercentilesOfUniformLatencies) {
+    LatencyPercentileHistogram hist(7);
+    for (uint64_t latency = 1; latency <= 10000; latency++) {
+        hist.increment(latency);
+    }
+    ASSERT_EQUALS(hist.count(), 10000U);
+    ASSERT_EQUALS(hist.max(), 10000U);
+    ASSERT_GREATER_THAN_OR_EQUALS(hist.percentile(0.5), 5000U);
+    ASSERT_LESS_THAN_OR_EQUALS(hist.percentile(0.5), 5000U + 5000U / 128);
+    ASSERT_GREATER_THAN_OR_EQUALS(hist.percentile(0.99), 9900U);
+    ASSERT_LESS_THAN_OR_EQUALS(hist.percentile(0.99), 9900U + 9900U / 128);
+    ASSERT_EQUALS(hist.percentile(1.0), 10000U);
+}
+
+TEST(LatencyPercentileHistogram, HugeLatenciesShareTheLastBucket) {
+    LatencyPercentileHistogram hist(3);
+    hist.increment(1ULL << 50);
+    hist.increment(1ULL << 60);
+    ASSERT_EQUALS(hist.count(), 2U);
+    ASSERT_EQUALS(hist.max(), 1ULL << 60);
+    ASSERT_EQUALS(hist.percentile(0.5), (1ULL << LatencyPercentileHistogram::kMaxExponent) - 1);
+    ASSERT_EQUALS(LatencyPercentileHistogram::bucketCount(3), 272U);
+}
+
+TEST(LatencyPercentileHistogram, MergeAndReset) {
+    LatencyPercentileHistogram first(3), second(3);
+    first.increment(10);
+    second.increment(20);
+    second.increment(100000);
+    first += second;
+    ASSERT_EQUALS(first.count(), 3U);
+    ASSERT_EQUALS(first.max(), 100000U);
+    ASSERT_EQUALS(first.percentile(0.5), 21U);
+
+    BSONObjBuilder builder;
+    first.append(&builder);
+    BSONObj out = builder.obj();
+    ASSERT_EQUALS(out["p50"].Long(), 21);
+    ASSERT_EQUALS(out["max"].Long(), 100000);
+
+    first.reset();
+    ASSERT_EQUALS(first.count(), 0U);
+    ASSERT_EQUALS(first.max(), 0U);
+    ASSERT_EQUALS(first.percentile(0.5), 0U);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -94,6 +94,7 @@ const std::array<uint64_t, OperationLatencyHistogram::kMaxBuckets>
 void OperationLatencyHistogram::_append(const HistogramData& data,
                                         const char* key,
                                         bool includeHistograms,
+                                        bool includePercentiles,
                                         BSONObjBuilder* builder) const {
 
     BSONObjBuilder histogramBuilder(builder->subobjStart(key));
@@ -111,14 +112,21 @@ void OperationLatencyHistogram::_append(const HistogramData& data,
     }
     histogramBuilder.append("latency", static_cast<long long>(data.sum));
     histogramBuilder.append("ops", static_cast<long long>(data.entryCount));
+    if (includePercentiles && data.percentiles.count() > 0) {
+        BSONObjBuilder percentilesBuilder(histogramBuilder.subobjStart("percentiles"));
+        data.percentiles.append(&percentilesBuilder);
+        percentilesBuilder.doneFast();
+    }
     histogramBuilder.doneFast();
 }
 
-void OperationLatencyHistogram::append(bool includeHistograms, BSONObjBuilder* builder) const {
-    _append(_reads, "reads", includeHistograms, builder);
-    _append(_writes, "writes", includeHistograms, builder);
-    _append(_commands, "commands", includeHistograms, builder);
-    _append(_transactions, "transactions", includeHistograms, builder);
+void OperationLatencyHistogram::append(bool includeHistograms,
+                                       bool includePercentiles,
+                                       BSONObjBuilder* builder) const {
+    _append(_reads, "reads", includeHistograms, includePercentiles, builder);
+    _append(_writes, "writes", includeHistograms, includePercentiles, builder);
+    _append(_commands, "commands", includeHistograms, includePercentiles, builder);
+    _append(_transactions, "transactions", includeHistograms, includePercentiles, builder);
 }
 
 // Computes the log base 2 of value, and checks for cases of split buckets.
@@ -152,6 +160,7 @@ void OperationLatencyHistogram::_incrementData(uint64_t latency, int bucket, His
     data->buckets[bucket]++;
     data->entryCount++;
     data->sum += latency;
+    data->percentiles.increment(latency);
 }
 
 void OperationLatencyHistogram::increment(uint64_t latency, Command::ReadWriteType type) {
@@ -30,6 +30,7 @@
 #include <array>
 
 #include "mongo/db/commands.h"
+#include "mongo/db/stats/latency_percentile_histogram.h"
 
 namespace mongo {
 
@@ -54,9 +55,21 @@ public:
     void increment(uint64_t latency, Command::ReadWriteType type);
 
     /**
-     * Appends the four histograms with latency totals and operation counts.
+     * Appends the four histograms with latency totals and operation counts, and with
+     * 'includePercentiles' the latency percentiles of each type that has any.
      */
-    void append(bool includeHistograms, BSONObjBuilder* builder) const;
+    void append(bool includeHistograms, bool includePercentiles, BSONObjBuilder* builder) const;
+
+    /**
+     * Clears the percentiles only. The totals and buckets are cumulative, and their consumers
+     * compute rates from differences between samples.
+     */
+    void resetPercentiles() {
+        _reads.percentiles.reset();
+        _writes.percentiles.reset();
+        _commands.percentiles.reset();
+        _transactions.percentiles.reset();
+    }
 
     void operator+=(const OperationLatencyHistogram& other) {
         _reads += other._reads;
@@ -70,13 +83,15 @@ private:
         std::array<uint64_t, kMaxBuckets> buckets{};
         uint64_t entryCount = 0;
         uint64_t sum = 0;
+        LatencyPercentileHistogram percentiles;
 
         void operator+=(const HistogramData& other) {
             for (size_t i = 0; i < buckets.size(); ++i) {
                 buckets[i] += other.buckets[i];
             }
             entryCount += other.entryCount;
-            sum += other.entryCount;
+            sum += other.sum;
+            percentiles += other.percentiles;
         }
     };
 
@@ -87,6 +102,7 @@ private:
     void _append(const HistogramData& data,
                  const char* key,
                  bool includeHistograms,
+                 bool includePercentiles,
                  BSONObjBuilder* builder) const;
 
     void _incrementData(uint64_t latency, int bucket, HistogramData* data);
@@ -55,7 +55,7 @@ TEST(OperationLatencyHistogram, EnsureIncrementsStored) {
         hist.increment(i, Command::ReadWriteType::kTransaction);
     }
     BSONObjBuilder outBuilder;
-    hist.append(false, &outBuilder);
+    hist.append(false, false, &outBuilder);
     BSONObj out = outBuilder.done();
     ASSERT_EQUALS(out["reads"]["ops"].Long(), kMaxBuckets);
     ASSERT_EQUALS(out["writes"]["ops"].Long(), kMaxBuckets);
@@ -77,7 +77,7 @@ TEST(OperationLatencyHistogram, CheckBucketCountsAndTotalLatency) {
     // The additional +1 because of the first boundary.
     uint64_t expectedSum = 3 * std::accumulate(kLowerBounds.begin(), kLowerBounds.end(), 0ULL) + 1;
     BSONObjBuilder outBuilder;
-    hist.append(true, &outBuilder);
+    hist.append(true, false, &outBuilder);
     BSONObj out = outBuilder.done();
     ASSERT_EQUALS(static_cast<uint64_t>(out["reads"]["latency"].Long()), expectedSum);
 
@@ -91,4 +91,45 @@ TEST(OperationLatencyHistogram, CheckBucketCountsAndTotalLatency) {
         ASSERT_EQUALS(bucket["count"].Long(), (i < kMaxBuckets - 1) ? 3 : 2);
     }
 }
+
+TEST(OperationLatencyHistogram, PercentilesOnlyForTypesWithOps) {
+    OperationLatencyHistogram hist;
+    for (uint64_t latency = 1; latency <= 1000; latency++) {
+        hist.increment(latency, Command::ReadWriteType::kRead);
+    }
+    BSONObjBuilder outBuilder;
+    hist.append(false, true, &outBuilder);
+    BSONObj out = outBuilder.done();
+    ASSERT_EQUALS(out["reads"]["percentiles"]["max"].Long(), 1000);
+    ASSERT_GREATER_THAN_OR_EQUALS(out["reads"]["percentiles"]["p50"].Long(), 500);
+    ASSERT_LESS_THAN_OR_EQUALS(out["reads"]["percentiles"]["p50"].Long(), 1000);
+    ASSERT(out["writes"]["percentiles"].eoo());
+}
+
+TEST(OperationLatencyHistogram, MergeAddsTotalsAndPercentiles) {
+    OperationLatencyHistogram first, second;
+    first.increment(10, Command::ReadWriteType::kWrite);
+    second.increment(5000, Command::ReadWriteType::kWrite);
+    first += second;
+
+    BSONObjBuilder outBuilder;
+    first.append(false, true, &outBuilder);
+    BSONObj out = outBuilder.done();
+    ASSERT_EQUALS(out["writes"]["ops"].Long(), 2);
+    ASSERT_EQUALS(out["writes"]["latency"].Long(), 5010);
+    ASSERT_EQUALS(out["writes"]["percentiles"]["p50"].Long(), 10);
+    ASSERT_EQUALS(out["writes"]["percentiles"]["max"].Long(), 5000);
+}
+
+TEST(OperationLatencyHistogram, ResetPercentilesKeepsTotals) {
+    OperationLatencyHistogram hist;
+    hist.increment(100, Command::ReadWriteType::kCommand);
+    hist.resetPercentiles();
+
+    BSONObjBuilder outBuilder;
+    hist.append(false, true, &outBuilder);
+    BSONObj out = outBuilder.done();
+    ASSERT_EQUALS(out["commands"]["ops"].Long(), 1);
+    ASSERT(out["commands"]["percentiles"].eoo());
+}
 }  // namespace mongo
@@ -214,12 +214,23 @@ void Top::_appendStatsEntry(BSONObjBuilder& b, const char* statsName, const Usag
     bb.done();
 }
 
-void Top::appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuilder* builder) {
+void Top::appendLatencyStats(StringData ns,
+                             bool includeHistograms,
+                             bool includePercentiles,
+                             BSONObjBuilder* builder) {
     auto hashedNs = UsageMap::HashedKey(ns);
-    // stdx::lock_guard<SimpleMutex> lk(_lock);
+    // Merge only the histograms of 'ns' rather than every namespace of every shard.
+    OperationLatencyHistogram nsHistogram;
+    for (size_t i = 0; i < _usageVector.size(); ++i) {
+        std::scoped_lock<std::mutex> lock(_usageMutexVector[i]);
+        auto it = _usageVector[i].find(hashedNs);
+        if (it != _usageVector[i].end()) {
+            nsHistogram += it->second.opLatencyHistogram;
+        }
+    }
+
     BSONObjBuilder latencyStatsBuilder;
-    UsageMap all = _mergeUsageVector();
-    all[hashedNs].opLatencyHistogram.append(includeHistograms, &latencyStatsBuilder);
+    nsHistogram.append(includeHistograms, includePercentiles, &latencyStatsBuilder);
     builder->append("ns", ns);
     builder->append("latencyStats", latencyStatsBuilder.obj());
 }
@@ -234,7 +245,9 @@ void Top::incrementGlobalLatencyStats(OperationContext* opCtx,
     _incrementHistogram(opCtx, latency, &_histogramVector[id], readWriteType);
 }
 
-void Top::appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder) {
+void Top::appendGlobalLatencyStats(bool includeHistograms,
+                                   bool includePercentiles,
+                                   BSONObjBuilder* builder) {
     OperationLatencyHistogram globalHistogramStats;
 
     for (size_t i = 0; i < _histogramVector.size(); ++i) {
@@ -242,7 +255,30 @@ void Top::appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* build
         globalHistogramStats += _histogramVector[i];
     }
 
-    globalHistogramStats.append(includeHistograms, builder);
+    globalHistogramStats.append(includeHistograms, includePercentiles, builder);
+}
+
+void Top::resetLatencyPercentiles(StringData ns) {
+    for (size_t i = 0; i < _usageVector.size(); ++i) {
+        std::scoped_lock<std::mutex> lock(_usageMutexVector[i]);
+        if (ns.empty()) {
+            for (auto& entry : _usageVector[i]) {
+                entry.second.opLatencyHistogram.resetPercentiles();
+            }
+        } else {
+            auto it = _usageVector[i].find(ns);
+            if (it != _usageVector[i].end()) {
+                it->second.opLatencyHistogram.resetPercentiles();
+            }
+        }
+    }
+
+    if (ns.empty()) {
+        for (size_t i = 0; i < _histogramVector.size(); ++i) {
+            std::scoped_lock<std::mutex> lock(_histogramMutexVector[i]);
+            _histogramVector[i].resetPercentiles();
+        }
+    }
 }
 
 void Top::incrementGlobalTransactionLatencyStats(uint64_t latency) {
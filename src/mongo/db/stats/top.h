@@ -132,7 +132,10 @@ public:
     /**
      * Appends the collection-level latency statistics
      */
-    void appendLatencyStats(StringData ns, bool includeHistograms, BSONObjBuilder* builder);
+    void appendLatencyStats(StringData ns,
+                            bool includeHistograms,
+                            bool includePercentiles,
+                            BSONObjBuilder* builder);
 
     /**
      * Increments the global histogram only if the operation came from a user.
@@ -149,7 +152,15 @@ public:
     /**
      * Appends the global latency statistics.
      */
-    void appendGlobalLatencyStats(bool includeHistograms, BSONObjBuilder* builder);
+    void appendGlobalLatencyStats(bool includeHistograms,
+                                  bool includePercentiles,
+                                  BSONObjBuilder* builder);
+
+    /**
+     * Clears the latency percentiles of namespace 'ns', or of every namespace and the global ones
+     * if 'ns' is empty.
+     */
+    void resetLatencyPercentiles(StringData ns);
 
 private:
     void _appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const;
@@ -28,6 +28,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/jsobj.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/unittest/unittest.h"
 
@@ -39,4 +40,21 @@ TEST(TopTest, CollectionDropped) {
     Top().collectionDropped("coll");
 }
 
+TEST(TopTest, ResetLatencyPercentilesKeepsTotals) {
+    Top top;
+    top.incrementGlobalTransactionLatencyStats(100);
+
+    BSONObjBuilder beforeBuilder;
+    top.appendGlobalLatencyStats(false, true, &beforeBuilder);
+    BSONObj before = beforeBuilder.obj();
+    ASSERT_EQUALS(before["transactions"]["percentiles"]["max"].Long(), 100);
+
+    top.resetLatencyPercentiles("");
+    BSONObjBuilder afterBuilder;
+    top.appendGlobalLatencyStats(false, true, &afterBuilder);
+    BSONObj after = afterBuilder.obj();
+    ASSERT_EQUALS(after["transactions"]["ops"].Long(), 1);
+    ASSERT(after["transactions"]["percentiles"].eoo());
+}
+
 }  // namespace
@@ -28,7 +28,7 @@
 
 #include "mongo/db/update/update_driver.h"
 
-
+#include <cstring>
 #include <map>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -39,9 +39,11 @@
 #include "mongo/bson/mutable/mutable_bson_test_utils.h"
 #include "mongo/db/field_ref.h"
 #include "mongo/db/json.h"
+#include "mongo/db/logical_clock.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
 #include "mongo/db/query/query_test_service_context.h"
+#include "mongo/db/service_context_test_fixture.h"
 #include "mongo/db/update_index_data.h"
 #include "mongo/unittest/unittest.h"
 
@@ -524,5 +526,149 @@ TEST_F(CreateFromQuery, NotFullShardKeyRepl) {
         driverRepl().populateDocumentWithQueryFields(opCtx(), query, immutablePaths, doc()));
 }
 
+//
+// Tests that updates which only overwrite fixed-width values are applied in place, and that
+// patching the original document with the resulting damages produces exactly the same bytes as
+// serializing the whole updated document.
+//
+
+class InPlaceUpdateTest : public ServiceContextTest {
+protected:
+    void setUp() override {
+        // Set up the logical clock needed by $currentDate with a timestamp type.
+        auto service = getGlobalServiceContext();
+        LogicalClock::set(service, stdx::make_unique<LogicalClock>(service));
+    }
+
+    /**
+     * Applies 'updateSpec' to 'original' with in-place updates enabled. Returns the original
+     * document patched with the damages, or boost::none if the update could not be applied in
+     * place. In either case, asserts that the result matches the document rebuilt by the update.
+     */
+    boost::optional<BSONObj> applyInPlace(const BSONObj& original,
+                                          const BSONObj& updateSpec,
+                                          const UpdateIndexData* indexData = nullptr) {
+        boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+        UpdateDriver driver(expCtx);
+        std::map<StringData, std::unique_ptr<ExpressionWithPlaceholder>> arrayFilters;
+        ASSERT_OK(driver.parse(updateSpec, arrayFilters));
+        driver.refreshIndexKeys(indexData);
+
+        mutablebson::Document doc(original, mutablebson::Document::kInPlaceEnabled);
+        bool modified = false;
+        ASSERT_OK(driver.update(StringData(), &doc, true, FieldRefSet(), nullptr, &modified));
+        ASSERT_TRUE(modified);
+
+        mutablebson::DamageVector damages;
+        const char* source = nullptr;
+        if (!doc.getInPlaceUpdates(&damages, &source)) {
+            return boost::none;
+        }
+        ASSERT_FALSE(damages.empty());
+
+        SharedBuffer patched = SharedBuffer::allocate(original.objsize());
+        std::memcpy(patched.get(), original.objdata(), original.objsize());
+        for (const auto& damage : damages) {
+            ASSERT_LTE(damage.targetOffset + damage.size, static_cast<size_t>(original.objsize()));
+            std::memcpy(
+                patched.get() + damage.targetOffset, source + damage.sourceOffset, damage.size);
+        }
+        BSONObj result(std::move(patched));
+        ASSERT_TRUE(doc.getObject().binaryEqual(result)) << doc.getObject() << " vs " << result;
+        return result;
+    }
+
+    /**
+     * Applies 'updateSpec' to 'original' with in-place updates disabled, so that the updated
+     * document is always serialized from scratch.
+     */
+    BSONObj applyByRebuilding(const BSONObj& original, const BSONObj& updateSpec) {
+        boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+        UpdateDriver driver(expCtx);
+        std::map<StringData, std::unique_ptr<ExpressionWithPlaceholder>> arrayFilters;
+        ASSERT_OK(driver.parse(updateSpec, arrayFilters));
+
+        mutablebson::Document doc(original, mutablebson::Document::kInPlaceDisabled);
+        bool modified = false;
+        ASSERT_OK(driver.update(StringData(), &doc, true, FieldRefSet(), nullptr, &modified));
+        return doc.getObject();
+    }
+};
+
+TEST_F(InPlaceUpdateTest, MatchesFullRebuild) {
+    struct {
+        const char* original;
+        const char* update;
+        bool inPlace;
+    } cases[] = {
+        // Arithmetic on numbers that keep their width.
+        {"{_id: 1, a: 1, b: 'x'}", "{$inc: {a: 5}}", true},
+        {"{_id: 1, a: NumberLong(1)}", "{$inc: {a: NumberLong(-7)}}", true},
+        {"{_id: 1, a: 1.5}", "{$inc: {a: 2.25}}", true},
+        {"{_id: 1, a: NumberDecimal('1.5')}", "{$inc: {a: NumberDecimal('2')}}", true},
+        {"{_id: 1, a: 3}", "{$mul: {a: 4}}", true},
+        {"{_id: 1, a: 6}", "{$bit: {a: {and: 3}}}", true},
+        {"{_id: 1, a: 3}", "{$max: {a: 9}}", true},
+        {"{_id: 1, a: {b: {c: 1}}, d: 2}", "{$inc: {'a.b.c': 1}}", true},
+        {"{_id: 1, a: [1, 2, 3]}", "{$inc: {'a.1': 10}}", true},
+        {"{_id: 1, a: 1, b: 2.0, c: 'abc'}", "{$inc: {a: 1, b: 1}, $set: {c: 'xyz'}}", true},
+
+        // $set of a value with the same serialized width, including type changes.
+        {"{_id: 1, a: 1.5}", "{$set: {a: NumberLong(3)}}", true},
+        {"{_id: 1, a: 'abc'}", "{$set: {a: 'xyz'}}", true},
+        {"{_id: 1, a: true}", "{$set: {a: false}}", true},
+        {"{_id: 1, a: Date(0)}", "{$set: {a: Date(1000)}}", true},
+
+        // Updates that change the size or layout of the document.
+        {"{_id: 1, a: 2147483647}", "{$inc: {a: 1}}", false},
+        {"{_id: 1, a: 1}", "{$inc: {a: 0.5}}", false},
+        {"{_id: 1, a: 'abc'}", "{$set: {a: 'abcd'}}", false},
+        {"{_id: 1, a: 1}", "{$set: {b: 1}}", false},
+        {"{_id: 1, a: 1, b: 1}", "{$unset: {b: 1}}", false},
+        {"{_id: 1, a: [1, 2]}", "{$push: {a: 3}}", false},
+    };
+
+    for (const auto& testCase : cases) {
+        const BSONObj original = fromjson(testCase.original);
+        const BSONObj update = fromjson(testCase.update);
+        const BSONObj rebuilt = applyByRebuilding(original, update);
+
+        auto inPlace = applyInPlace(original, update);
+        ASSERT_EQ(testCase.inPlace, static_cast<bool>(inPlace)) << testCase.update << " on "
+                                                                << testCase.original;
+        if (inPlace) {
+            ASSERT_TRUE(rebuilt.binaryEqual(*inPlace)) << rebuilt << " vs " << *inPlace;
+        }
+    }
+}
+
+TEST_F(InPlaceUpdateTest, CurrentDateIsAppliedInPlace) {
+    auto date = applyInPlace(fromjson("{_id: 1, a: Date(0), b: 1}"),
+                             fromjson("{$currentDate: {a: true}}"));
+    ASSERT(date);
+    ASSERT_EQ(BSONType::Date, (*date)["a"].type());
+    ASSERT_GT((*date)["a"].date(), Date_t());
+
+    auto timestamp = applyInPlace(fromjson("{_id: 1, a: Timestamp(1, 1), b: 1}"),
+                                  fromjson("{$currentDate: {a: {$type: 'timestamp'}}}"));
+    ASSERT(timestamp);
+    ASSERT_EQ(BSONType::bsonTimestamp, (*timestamp)["a"].type());
+
+    // A date replacing a number of the same width is still in place, with a new type byte.
+    ASSERT(applyInPlace(fromjson("{_id: 1, a: 1.5}"), fromjson("{$currentDate: {a: true}}")));
+
+    // A date replacing a narrower value is not.
+    ASSERT_FALSE(applyInPlace(fromjson("{_id: 1, a: 1}"), fromjson("{$currentDate: {a: true}}")));
+}
+
+TEST_F(InPlaceUpdateTest, IndexedFieldsAreNotUpdatedInPlace) {
+    UpdateIndexData indexData;
+    indexData.addPath("a");
+
+    const BSONObj original = fromjson("{_id: 1, a: 1, b: 1}");
+    ASSERT_FALSE(applyInPlace(original, fromjson("{$inc: {a: 1}}"), &indexData));
+    ASSERT(applyInPlace(original, fromjson("{$inc: {b: 1}}"), &indexData));
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,324 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_appender.h"
+
+#include "mongo/base/string_data.h"
+#include "mongo/logger/log_severity.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace logger {
+
+constexpr size_t AsyncLogQueue::kDefaultCapacity;
+constexpr Milliseconds AsyncLogQueue::kFatalFlushTimeout;
+
+namespace {
+
+// A slot that carried an unusually long message gives the memory back rather than keeping it.
+constexpr size_t kMaxRetainedMessageBytes = 4 * 1024;
+
+AsyncLogQueue* globalQueue = nullptr;
+
+// The writer thread must never wait on its own queue, e.g. if an appender logs.
+thread_local bool isWriterThread = false;
+
+uint64_t roundUpToPowerOfTwo(size_t n) {
+    uint64_t capacity = 2;
+    while (capacity < n) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+}  // namespace
+
+AsyncLogQueue::AsyncLogQueue(size_t capacity, OverflowPolicy policy)
+    : _policy(policy), _mask(roundUpToPowerOfTwo(capacity) - 1), _slots(new Slot[_mask + 1]) {
+    for (uint64_t i = 0; i <= _mask; ++i) {
+        _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _writer = stdx::thread([this] { _writerLoop(); });
+}
+
+AsyncLogQueue::~AsyncLogQueue() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shutdown = true;
+        _writerWakeup.notify_one();
+    }
+    _writer.join();
+}
+
+AsyncLogQueue* AsyncLogQueue::getGlobal() {
+    return globalQueue;
+}
+
+void AsyncLogQueue::setGlobal(std::unique_ptr<AsyncLogQueue> queue) {
+    invariant(!globalQueue);
+    globalQueue = queue.release();
+}
+
+bool AsyncLogQueue::push(EventAppender* target, const MessageEventEphemeral& event) {
+    if (!_tryPush(target, event)) {
+        if (_policy == OverflowPolicy::kDrop || isWriterThread) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _blockedProducers.fetch_add(1);
+        // Pairs with the fence in _tryPop(): either the writer sees this producer waiting after
+        // it frees a slot, or the retry below sees the free slot.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!_tryPush(target, event)) {
+            _spaceAvailable.wait(lk);
+        }
+        _blockedProducers.fetch_sub(1);
+    }
+
+    _wakeWriter();
+    return true;
+}
+
+void AsyncLogQueue::flush() {
+    const auto target = static_cast<long long>(_enqueuePos.load());
+    if (isWriterThread || _written.load() >= target) {
+        return;
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _flushWaiters.fetch_add(1);
+    _flushed.wait(lk, [&] { return _written.load() >= target; });
+    _flushWaiters.fetch_sub(1);
+}
+
+void AsyncLogQueue::flushForFatal() {
+    // The writer thread is in the middle of writing an event itself and cannot wait for the rest.
+    if (isWriterThread) {
+        return;
+    }
+
+    const auto target = static_cast<long long>(_enqueuePos.load());
+    if (_written.load() >= target) {
+        return;
+    }
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _flushWaiters.fetch_add(1);
+        _flushed.wait_for(lk, kFatalFlushTimeout.toSystemDuration(), [&] {
+            return _written.load() >= target;
+        });
+        _flushWaiters.fetch_sub(1);
+    }
+
+    // The writer fell behind or is stuck, possibly on the thread that is taking the process down.
+    // Write whatever is left from this thread.
+    Entry entry;
+    while (_tryPop(&entry)) {
+        _write(entry);
+    }
+}
+
+bool AsyncLogQueue::_tryPush(EventAppender* target, const MessageEventEphemeral& event) {
+    uint64_t pos = _enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &_slots[pos & _mask];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(sequence - pos);
+        if (diff == 0) {
+            if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The slot still holds the event queued one lap ago: the queue is full.
+            return false;
+        } else {
+            pos = _enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    Entry& entry = slot->entry;
+    entry.target = target;
+    entry.date = event.getDate();
+    entry.severity = event.getSeverity().toInt();
+    entry.component = event.getComponent();
+    entry.isTruncatable = event.isTruncatable();
+    const auto contextName = event.getContextName();
+    entry.contextName.assign(contextName.rawData(), contextName.size());
+    const auto message = event.getMessage();
+    entry.message.assign(message.rawData(), message.size());
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool AsyncLogQueue::_tryPop(Entry* out) {
+    uint64_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &_slots[pos & _mask];
+        const auto sequence = slot->sequence.load(std::memory_order_acquire);
+        const auto diff = static_cast<int64_t>(sequence - (pos + 1));
+        if (diff == 0) {
+            if (_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Empty, or the next event has been claimed by a producer that is still copying it.
+            return false;
+        } else {
+            pos = _dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    Entry& entry = slot->entry;
+    out->target = entry.target;
+    out->date = entry.date;
+    out->severity = entry.severity;
+    out->component = entry.component;
+    out->isTruncatable = entry.isTruncatable;
+    out->contextName.swap(entry.contextName);
+    out->message.swap(entry.message);
+    slot->sequence.store(pos + _mask + 1, std::memory_order_release);
+
+    // Pairs with the fence in push().
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_blockedProducers.load(std::memory_order_relaxed) > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _spaceAvailable.notify_all();
+    }
+    return true;
+}
+
+bool AsyncLogQueue::_isEmpty() const {
+    const uint64_t pos = _dequeuePos.load(std::memory_order_relaxed);
+    return _slots[pos & _mask].sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+void AsyncLogQueue::_write(Entry& entry) {
+    // Note the loss where it happened, ahead of the first event that made it through. The writer
+    // and a thread running flushForFatal() may get here at once, so each loss is claimed by CAS.
+    const auto dropped = _dropped.load(std::memory_order_relaxed);
+    auto reported = _droppedReported.load(std::memory_order_relaxed);
+    while (reported < dropped && !_droppedReported.compare_exchange_weak(reported, dropped)) {
+    }
+    if (reported < dropped) {
+        const std::string note = str::stream()
+            << "Dropped " << dropped - reported
+            << " log messages because the asynchronous log queue was full";
+        entry.target
+            ->append(MessageEventEphemeral(entry.date,
+                                           LogSeverity::Warning(),
+                                           LogComponent::kControl,
+                                           entry.contextName,
+                                           note))
+            .transitional_ignore();
+    }
+
+    entry.target
+        ->append(MessageEventEphemeral(entry.date,
+                                       LogSeverity::cast(entry.severity),
+                                       entry.component,
+                                       entry.contextName,
+                                       entry.message)
+                     .setIsTruncatable(entry.isTruncatable))
+        .transitional_ignore();
+
+    _written.fetch_add(1);
+    if (_flushWaiters.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _flushed.notify_all();
+    }
+
+    if (entry.message.capacity() > kMaxRetainedMessageBytes) {
+        std::string().swap(entry.message);
+    }
+}
+
+void AsyncLogQueue::_wakeWriter() {
+    // Pairs with the fence in _writerLoop(): either the writer sees the event just published
+    // before it goes to sleep, or this thread sees that the writer is idle.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_writerIdle.load(std::memory_order_relaxed) && _writerIdle.exchange(false)) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _writerWakeup.notify_one();
+    }
+}
+
+void AsyncLogQueue::_writerLoop() {
+    setThreadName("AsyncLogWriter");
+    isWriterThread = true;
+
+    Entry entry;
+    for (;;) {
+        if (_tryPop(&entry)) {
+            _write(entry);
+            continue;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _writerIdle.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!_isEmpty()) {
+            _writerIdle.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        if (_shutdown) {
+            return;
+        }
+        _writerWakeup.wait(lk, [&] { return !_writerIdle.load() || _shutdown; });
+        _writerIdle.store(false, std::memory_order_relaxed);
+    }
+}
+
+AsyncAppender::AsyncAppender(AsyncLogQueue* queue,
+                             std::unique_ptr<Appender<MessageEventEphemeral>> target)
+    : _queue(queue), _target(std::move(target)) {}
+
+AsyncAppender::~AsyncAppender() {
+    _queue->flush();
+}
+
+Status AsyncAppender::append(const MessageEventEphemeral& event) {
+    if (event.getSeverity() >= LogSeverity::Severe()) {
+        _queue->flushForFatal();
+        return _target->append(event);
+    }
+
+    _queue->push(_target.get(), event);
+    return Status::OK();
+}
+
+}  // namespace logger
+}  // namespace mongo
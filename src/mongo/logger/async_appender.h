@@ -0,0 +1,228 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/logger/appender.h"
+#include "mongo/logger/log_component.h"
+#include "mongo/logger/message_event.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/new.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace logger {
+
+/**
+ * Bounded, lock-free, multi-producer queue of log events drained by a dedicated writer thread,
+ * which hands each event to the appender it was queued for. Threads that log copy the event into
+ * a preallocated slot and return, without waiting on encoding, on the appenders' locks or on the
+ * log's I/O.
+ *
+ * Events are written in the order they were queued. When the queue is full, OverflowPolicy::kDrop
+ * discards the event and counts it, and the writer notes how many events were lost in the log at
+ * the point they went missing; OverflowPolicy::kBlock makes the logging thread wait for room.
+ *
+ * The queue is built on Dmitry Vyukov's bounded MPMC array queue: every slot carries a sequence
+ * number that tells producers and consumers whose turn it is, so claiming a slot is a single CAS.
+ * More than one thread may consume, which lets flushForFatal() drain the queue itself.
+ */
+class AsyncLogQueue {
+    MONGO_DISALLOW_COPYING(AsyncLogQueue);
+
+public:
+    using EventAppender = Appender<MessageEventEphemeral>;
+
+    enum class OverflowPolicy { kDrop, kBlock };
+
+    static constexpr size_t kDefaultCapacity = 16 * 1024;
+
+    /**
+     * How long flushForFatal() waits for the writer thread before writing the remaining events on
+     * the calling thread.
+     */
+    static constexpr Milliseconds kFatalFlushTimeout{1000};
+
+    /**
+     * Starts the writer thread. 'capacity' is rounded up to a power of two.
+     */
+    AsyncLogQueue(size_t capacity, OverflowPolicy policy);
+
+    /**
+     * Writes out every queued event, then stops the writer thread.
+     */
+    ~AsyncLogQueue();
+
+    /**
+     * Queues 'event' to be appended to 'target' on the writer thread. 'target' must stay valid
+     * until the event has been written; see flush(). Returns false if the event was dropped.
+     */
+    bool push(EventAppender* target, const MessageEventEphemeral& event);
+
+    /**
+     * Waits until every event queued before this call has been handed to its appender.
+     */
+    void flush();
+
+    /**
+     * Like flush(), for a thread that is about to terminate the process. It may be called from the
+     * writer thread or from a signal handler. If the writer does not catch up within
+     * kFatalFlushTimeout, the calling thread writes the remaining events itself.
+     */
+    void flushForFatal();
+
+    size_t capacity() const {
+        return _mask + 1;
+    }
+
+    OverflowPolicy overflowPolicy() const {
+        return _policy;
+    }
+
+    /**
+     * Number of events discarded because the queue was full.
+     */
+    long long droppedCount() const {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Number of events handed to their appenders so far.
+     */
+    long long writtenCount() const {
+        return _written.load(std::memory_order_acquire);
+    }
+
+    /**
+     * The queue shared by the asynchronous appenders of this process, or nullptr when the server
+     * logs synchronously. The global queue is never destroyed, so it can be flushed on exit.
+     */
+    static AsyncLogQueue* getGlobal();
+    static void setGlobal(std::unique_ptr<AsyncLogQueue> queue);
+
+private:
+    /**
+     * An owned copy of a MessageEventEphemeral. Slots keep their strings' capacity, so once the
+     * queue has warmed up, queueing a message of a familiar size does not allocate.
+     */
+    struct Entry {
+        EventAppender* target = nullptr;
+        Date_t date;
+        int severity = 0;
+        LogComponent::Value component = LogComponent::kDefault;
+        bool isTruncatable = true;
+        std::string contextName;
+        std::string message;
+    };
+
+    struct alignas(stdx::hardware_destructive_interference_size) Slot {
+        std::atomic<uint64_t> sequence;  // NOLINT
+        Entry entry;
+    };
+
+    bool _tryPush(EventAppender* target, const MessageEventEphemeral& event);
+
+    /**
+     * Moves the oldest queued event into 'out', leaving the slot with out's old buffers.
+     */
+    bool _tryPop(Entry* out);
+
+    bool _isEmpty() const;
+
+    void _write(Entry& entry);
+    void _wakeWriter();
+    void _writerLoop();
+
+    const OverflowPolicy _policy;
+    const uint64_t _mask;
+    const std::unique_ptr<Slot[]> _slots;
+
+    // Producers and consumers claim positions on separate cache lines.
+    alignas(stdx::hardware_destructive_interference_size)
+        std::atomic<uint64_t> _enqueuePos{0};  // NOLINT
+    alignas(stdx::hardware_destructive_interference_size)
+        std::atomic<uint64_t> _dequeuePos{0};  // NOLINT
+
+    std::atomic<long long> _dropped{0};          // NOLINT
+    std::atomic<long long> _droppedReported{0};  // NOLINT
+    std::atomic<long long> _written{0};          // NOLINT
+    std::atomic<bool> _writerIdle{false};        // NOLINT
+    std::atomic<int> _blockedProducers{0};       // NOLINT
+    std::atomic<int> _flushWaiters{0};           // NOLINT
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _writerWakeup;
+    stdx::condition_variable _spaceAvailable;
+    stdx::condition_variable _flushed;
+    bool _shutdown = false;
+
+    stdx::thread _writer;
+};
+
+/**
+ * Appender that queues events on an AsyncLogQueue instead of appending them to its target on the
+ * logging thread. Severe events, which precede fatal assertions and crashes, are written
+ * synchronously after everything queued before them, so a dying process leaves a complete log.
+ */
+class AsyncAppender : public Appender<MessageEventEphemeral> {
+    MONGO_DISALLOW_COPYING(AsyncAppender);
+
+public:
+    /**
+     * Takes ownership of 'target' but not of 'queue', which must outlive this appender.
+     */
+    AsyncAppender(AsyncLogQueue* queue, std::unique_ptr<Appender<MessageEventEphemeral>> target);
+
+    /**
+     * Flushes the queue, so that no queued event refers to the target once it is destroyed.
+     */
+    ~AsyncAppender();
+
+    /**
+     * Always returns Status::OK() for queued events: failures of the target happen later, on the
+     * writer thread, and are not reported back.
+     */
+    Status append(const MessageEventEphemeral& event) override;
+
+private:
+    AsyncLogQueue* const _queue;
+    const std::unique_ptr<Appender<MessageEventEphemeral>> _target;
+};
+
+}  // namespace logger
+}  // namespace mongo
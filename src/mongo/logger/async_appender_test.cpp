@@ -0,0 +1,290 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_appender.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/logger/appender.h"
+#include "mongo/logger/message_event.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace logger {
+namespace {
+
+/**
+ * Records the messages it is given. After hold(), the next append blocks until release(), while
+ * appends from other threads go through; this stalls the writer thread behind a slow "disk".
+ */
+class CaptureAppender : public Appender<MessageEventEphemeral> {
+public:
+    Status append(const MessageEventEphemeral& event) override {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (_holding && !_held) {
+            _held = true;
+            _cv.notify_all();
+            _cv.wait(lk, [&] { return !_holding; });
+        }
+        _messages.push_back(event.getMessage().toString());
+        _severities.push_back(event.getSeverity());
+        return Status::OK();
+    }
+
+    void hold() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _holding = true;
+        _held = false;
+    }
+
+    void waitUntilHeld() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return _held; });
+    }
+
+    void release() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _holding = false;
+        _cv.notify_all();
+    }
+
+    std::vector<std::string> messages() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _messages;
+    }
+
+    std::vector<LogSeverity> severities() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _severities;
+    }
+
+private:
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    bool _holding = false;
+    bool _held = false;
+    std::vector<std::string> _messages;
+    std::vector<LogSeverity> _severities;
+};
+
+MessageEventEphemeral makeEvent(StringData message,
+                                LogSeverity severity = LogSeverity::Log()) {
+    return MessageEventEphemeral(Date_t::now(), severity, "test", message);
+}
+
+std::string makeMessage(int thread, int seq) {
+    return str::stream() << thread << ":" << seq;
+}
+
+/**
+ * Checks that each producer's messages were all written, in the order that producer queued them,
+ * and returns how many there were.
+ */
+size_t checkPerProducerOrder(const std::vector<std::string>& messages,
+                             int numThreads,
+                             bool allowGaps) {
+    std::vector<int> lastSeq(numThreads, -1);
+    size_t count = 0;
+    for (auto&& message : messages) {
+        const auto colon = message.find(':');
+        if (colon == std::string::npos) {
+            continue;  // A note about dropped messages.
+        }
+        const int thread = std::stoi(message.substr(0, colon));
+        const int seq = std::stoi(message.substr(colon + 1));
+        ASSERT_GREATER_THAN(seq, lastSeq[thread]);
+        if (!allowGaps) {
+            ASSERT_EQ(seq, lastSeq[thread] + 1);
+        }
+        lastSeq[thread] = seq;
+        ++count;
+    }
+    return count;
+}
+
+long long sumOfDropNotes(const std::vector<std::string>& messages) {
+    const StringData kPrefix = "Dropped "_sd;
+    long long total = 0;
+    for (auto&& message : messages) {
+        if (StringData(message).startsWith(kPrefix)) {
+            total += std::stoll(message.substr(kPrefix.size()));
+        }
+    }
+    return total;
+}
+
+TEST(AsyncLogQueueTest, CapacityIsRoundedUpToAPowerOfTwo) {
+    ASSERT_EQ(AsyncLogQueue(1000, AsyncLogQueue::OverflowPolicy::kDrop).capacity(), 1024U);
+    ASSERT_EQ(AsyncLogQueue(1024, AsyncLogQueue::OverflowPolicy::kDrop).capacity(), 1024U);
+}
+
+TEST(AsyncLogQueueTest, WritesEventsInOrder) {
+    CaptureAppender target;
+    AsyncLogQueue queue(64, AsyncLogQueue::OverflowPolicy::kBlock);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT(queue.push(&target, makeEvent(makeMessage(0, i))));
+    }
+    queue.flush();
+
+    ASSERT_EQ(checkPerProducerOrder(target.messages(), 1, /*allowGaps*/ false), 1000U);
+    ASSERT_EQ(queue.writtenCount(), 1000);
+    ASSERT_EQ(queue.droppedCount(), 0);
+}
+
+TEST(AsyncLogQueueTest, ManyProducersWithBlockingLoseNothing) {
+    const int kThreads = 8;
+    const int kPerThread = 20000;
+    CaptureAppender target;
+    // A small queue, so that producers regularly find it full and have to wait.
+    AsyncLogQueue queue(16, AsyncLogQueue::OverflowPolicy::kBlock);
+
+    std::vector<stdx::thread> producers;
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                queue.push(&target, makeEvent(makeMessage(t, i)));
+            }
+        });
+    }
+    for (auto&& producer : producers) {
+        producer.join();
+    }
+    queue.flush();
+
+    ASSERT_EQ(checkPerProducerOrder(target.messages(), kThreads, /*allowGaps*/ false),
+              static_cast<size_t>(kThreads * kPerThread));
+    ASSERT_EQ(queue.droppedCount(), 0);
+}
+
+TEST(AsyncLogQueueTest, DroppingAccountsForEveryEvent) {
+    const int kThreads = 4;
+    const int kPerThread = 5000;
+    CaptureAppender target;
+    AsyncLogQueue queue(16, AsyncLogQueue::OverflowPolicy::kDrop);
+
+    // Stall the writer on its first event so that the queue fills up.
+    target.hold();
+    queue.push(&target, makeEvent("first"));
+    target.waitUntilHeld();
+
+    std::vector<stdx::thread> producers;
+    AtomicWord<long long> accepted(0);
+    for (int t = 0; t < kThreads; ++t) {
+        producers.emplace_back([&, t] {
+            for (int i = 0; i < kPerThread; ++i) {
+                if (queue.push(&target, makeEvent(makeMessage(t, i)))) {
+                    accepted.fetchAndAdd(1);
+                }
+            }
+        });
+    }
+    for (auto&& producer : producers) {
+        producer.join();
+    }
+    target.release();
+    queue.flush();
+
+    // One more event makes the writer account for any loss after the last accepted event.
+    ASSERT(queue.push(&target, makeEvent("last")));
+    queue.flush();
+
+    const auto messages = target.messages();
+    const auto written = checkPerProducerOrder(messages, kThreads, /*allowGaps*/ true);
+    ASSERT_EQ(static_cast<long long>(written), accepted.load());
+    ASSERT_EQ(accepted.load() + queue.droppedCount(), kThreads * kPerThread);
+    ASSERT_GREATER_THAN(queue.droppedCount(), 0);
+    ASSERT_EQ(sumOfDropNotes(messages), queue.droppedCount());
+    ASSERT_EQ(messages.front(), "first");
+    ASSERT_EQ(messages.back(), "last");
+}
+
+TEST(AsyncLogQueueTest, FlushForFatalWritesAroundAStuckWriter) {
+    CaptureAppender target;
+    AsyncLogQueue queue(64, AsyncLogQueue::OverflowPolicy::kDrop);
+
+    target.hold();
+    queue.push(&target, makeEvent("stuck"));
+    target.waitUntilHeld();
+    for (int i = 0; i < 10; ++i) {
+        queue.push(&target, makeEvent(makeMessage(0, i)));
+    }
+
+    // The writer cannot make progress, so once the timeout passes this thread writes the queued
+    // events itself.
+    queue.flushForFatal();
+    ASSERT_EQ(checkPerProducerOrder(target.messages(), 1, /*allowGaps*/ false), 10U);
+    ASSERT_EQ(queue.writtenCount(), 10);
+
+    target.release();
+    queue.flush();
+    ASSERT_EQ(target.messages().size(), 11U);
+    ASSERT_EQ(target.messages().back(), "stuck");
+}
+
+TEST(AsyncAppenderTest, SevereEventIsWrittenAfterEverythingQueuedBeforeIt) {
+    AsyncLogQueue queue(1024, AsyncLogQueue::OverflowPolicy::kBlock);
+    auto ownedTarget = stdx::make_unique<CaptureAppender>();
+    auto target = ownedTarget.get();
+    AsyncAppender appender(&queue, std::move(ownedTarget));
+
+    for (int i = 0; i < 500; ++i) {
+        ASSERT_OK(appender.append(makeEvent(makeMessage(0, i))));
+    }
+    ASSERT_OK(appender.append(makeEvent("fatal", LogSeverity::Severe())));
+
+    // No flush: the severe event itself must have waited for the queue.
+    const auto messages = target->messages();
+    ASSERT_EQ(messages.size(), 501U);
+    ASSERT_EQ(messages.back(), "fatal");
+    ASSERT_EQ(target->severities().back(), LogSeverity::Severe());
+    ASSERT_EQ(checkPerProducerOrder(messages, 1, /*allowGaps*/ false), 500U);
+}
+
+TEST(AsyncAppenderTest, DestructionFlushesTheQueue) {
+    AsyncLogQueue queue(1024, AsyncLogQueue::OverflowPolicy::kBlock);
+    {
+        AsyncAppender appender(&queue, stdx::make_unique<CaptureAppender>());
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_OK(appender.append(makeEvent(makeMessage(0, i))));
+        }
+    }
+    ASSERT_EQ(queue.writtenCount(), 100);
+}
+
+}  // namespace
+}  // namespace logger
+}  // namespace mongo
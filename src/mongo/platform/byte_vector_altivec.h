@@ -38,13 +38,12 @@
 #include "mongo/platform/bits.h"
 
 namespace mongo {
-namespace unicode {
 
 /**
  * A sequence of bytes that can be manipulated using vectorized instructions.
  *
- * This is specific to the use case in mongo::unicode::String and not intended as a general purpose
- * vector class.
+ * This is specific to the use cases in mongo::unicode::String and BSON validation and not
+ * intended as a general purpose vector class.
  *
  * This specialization offers acceleration for ppc64le
  */
@@ -157,5 +156,4 @@ private:
     Native _data;
 };
 
-}  // namespace unicode
 }  // namespace mongo
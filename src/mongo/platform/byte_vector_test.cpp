@@ -30,12 +30,11 @@
 #include <iterator>
 #include <numeric>
 
-#include "mongo/db/fts/unicode/byte_vector.h"
+#include "mongo/platform/byte_vector.h"
 #include "mongo/unittest/unittest.h"
 
 #ifdef MONGO_HAVE_FAST_BYTE_VECTOR
 namespace mongo {
-namespace unicode {
 
 TEST(ByteVector, LoadStoreUnaligned) {
     uint8_t inputBuf[ByteVector::size * 2];
@@ -174,7 +173,6 @@ TEST(ByteVector, BitAndAssign) {
     }
 }
 
-}  // namespace unicode
 }  // namespace mongo
 #else
 // Our unittest framework gets angry if there are no tests. If we don't have ByteVector, give it a
@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/ops/write_ops.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/rpc/op_msg.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+const StringData kCursorNs = "test.coll"_sd;
+
+BSONObj makeDoc(int i) {
+    return BSON("_id" << i << "x" << i * 3 << "payload" << std::string(100, 'a' + i % 26));
+}
+
+/**
+ * Bytes of 'docs' whose storage lies outside of 'message', i.e. documents that were copied out of
+ * the request instead of being viewed in place.
+ */
+long long bytesCopiedOutOf(const Message& message, const std::vector<BSONObj>& docs) {
+    const char* const begin = message.buf();
+    const char* const end = begin + message.size();
+    long long copied = 0;
+    for (auto&& doc : docs) {
+        if (doc.objdata() < begin || doc.objdata() + doc.objsize() > end) {
+            copied += doc.objsize();
+        }
+    }
+    return copied;
+}
+
+/**
+ * Parses an insert of 'state.range(0)' documents, sent as an OP_MSG document sequence when
+ * 'state.range(1)' is set and as an array in the command body otherwise, down to the
+ * write_ops::Insert that performInserts() consumes.
+ */
+void BM_ParseInsert(benchmark::State& state) {
+    const int numDocs = state.range(0);
+    const bool useDocSequence = state.range(1);
+
+    OpMsgBuilder builder;
+    if (useDocSequence) {
+        auto docSeq = builder.beginDocSequence("documents");
+        for (int i = 0; i < numDocs; ++i) {
+            docSeq.append(makeDoc(i));
+        }
+    }
+    {
+        auto body = builder.beginBody();
+        body.append("insert", "coll");
+        if (!useDocSequence) {
+            BSONArrayBuilder docs(body.subarrayStart("documents"));
+            for (int i = 0; i < numDocs; ++i) {
+                docs.append(makeDoc(i));
+            }
+        }
+        body.append("$db", "test");
+    }
+    const Message message = builder.finish();
+
+    long long bytesCopied = 0;
+    for (auto keepRunning : state) {
+        const auto insert = InsertOp::parse(OpMsgRequest::parse(message));
+        invariant(insert.getDocuments().size() == static_cast<size_t>(numDocs));
+        bytesCopied += bytesCopiedOutOf(message, insert.getDocuments());
+    }
+    state.SetBytesProcessed(state.iterations() * message.size());
+    state.counters["bytesCopiedPerOp"] = static_cast<double>(bytesCopied) / state.iterations();
+}
+
+/**
+ * Builds a find reply carrying 'state.range(0)' documents. With 'state.range(1)' set the batch is
+ * appended straight into the reply through CursorResponseBuilder, otherwise it is gathered in a
+ * BSONArrayBuilder first and then copied in by appendCursorResponseObject(). Counts the document
+ * bytes written anywhere other than the outgoing message.
+ */
+void BM_BuildCursorReply(benchmark::State& state) {
+    const int numDocs = state.range(0);
+    const bool inPlace = state.range(1);
+
+    std::vector<BSONObj> docs;
+    for (int i = 0; i < numDocs; ++i) {
+        docs.push_back(makeDoc(i));
+    }
+
+    long long bytesCopied = 0;
+    for (auto keepRunning : state) {
+        OpMsgBuilder reply;
+        {
+            auto body = reply.beginBody();
+            if (inPlace) {
+                CursorResponseBuilder firstBatch(/*isInitialResponse*/ true, &body);
+                for (auto&& doc : docs) {
+                    firstBatch.append(doc);
+                }
+                firstBatch.done(0LL, kCursorNs);
+            } else {
+                BSONArrayBuilder firstBatch;
+                for (auto&& doc : docs) {
+                    firstBatch.append(doc);
+                }
+                bytesCopied += firstBatch.len();
+                appendCursorResponseObject(0LL, kCursorNs, firstBatch.arr(), &body);
+            }
+            body.append("ok", 1.0);
+        }
+        const Message message = reply.finish();
+        benchmark::DoNotOptimize(message.buf());
+    }
+    state.SetItemsProcessed(state.iterations() * numDocs);
+    state.counters["bytesCopiedPerOp"] = static_cast<double>(bytesCopied) / state.iterations();
+}
+
+// A single document, a default 101-document first batch, and a full 1000-document write batch.
+void parseInsertArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"docs", "docSequence"});
+    for (int docs : {1, 101, 1000}) {
+        b->Args({docs, 0});
+        b->Args({docs, 1});
+    }
+}
+
+void buildCursorReplyArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"docs", "inPlace"});
+    for (int docs : {1, 101, 1000}) {
+        b->Args({docs, 0});
+        b->Args({docs, 1});
+    }
+}
+
+BENCHMARK(BM_ParseInsert)->Apply(parseInsertArgs);
+BENCHMARK(BM_BuildCursorReply)->Apply(buildCursorReplyArgs);
+
+}  // namespace
+}  // namespace mongo
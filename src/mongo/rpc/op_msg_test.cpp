@@ -306,6 +306,33 @@ TEST_F(OpMsgParser, SucceedsWithBodyThenSequenceThenSequence) {
     ASSERT_EQ(msg.sequences[1].objs.size(), 0u);
 }
 
+TEST_F(OpMsgParser, SequenceDocumentsAreViewsIntoMessage) {
+    const auto message = OpMsgBytes{
+        kNoFlags,  //
+        kBodySection,
+        fromjson("{insert: 'coll'}"),
+
+        kDocSequenceSection,
+        Sized{
+            "documents",  //
+            fromjson("{a: 1}"),
+            fromjson("{a: 2}"),
+        },
+    }.done();
+    const auto msg = OpMsg::parseOwned(message);
+
+    // The documents must keep pointing into the message they arrived in, sharing its buffer.
+    const char* const begin = message.buf();
+    const char* const end = begin + message.size();
+    ASSERT_EQ(msg.sequences.size(), 1u);
+    ASSERT_EQ(msg.sequences[0].objs.size(), 2u);
+    for (auto&& obj : msg.sequences[0].objs) {
+        ASSERT(obj.isOwned());
+        ASSERT(obj.objdata() >= begin);
+        ASSERT(obj.objdata() + obj.objsize() <= end);
+    }
+}
+
 TEST_F(OpMsgParser, FailsIfNoBody) {
     auto msg = OpMsgBytes{
         kNoFlags,  //
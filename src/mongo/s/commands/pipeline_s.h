@@ -83,6 +83,7 @@ public:
         void appendLatencyStats(OperationContext* opCtx,
                                 const NamespaceString& nss,
                                 bool includeHistograms,
+                                bool includePercentiles,
                                 BSONObjBuilder* builder) const final {
             MONGO_UNREACHABLE;
         }
@@ -100,6 +101,17 @@ public:
             MONGO_UNREACHABLE;
         }
 
+        boost::optional<CollectionSizeEstimate> estimateCollectionSize(
+            OperationContext* opCtx, const NamespaceString& nss) const final {
+            return boost::none;
+        }
+
+        bool hasIndexWithLeadingField(OperationContext* opCtx,
+                                      const NamespaceString& nss,
+                                      StringData fieldPath) const final {
+            return false;
+        }
+
         BSONObj getCollectionOptions(const NamespaceString& nss) final {
             MONGO_UNREACHABLE;
         }
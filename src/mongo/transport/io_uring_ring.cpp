@@ -0,0 +1,294 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/io_uring_ring.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+int ioUringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(
+        ::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned nrArgs) {
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+Status errnoStatus(StringData what, int err) {
+    return {ErrorCodes::OperationFailed,
+            str::stream() << what << " failed: " << errnoWithDescription(err)};
+}
+
+// Multishot receive, the newest operation the transport depends on, first shipped in Linux 6.0.
+bool kernelHasMultishotReceive() {
+    struct utsname name;
+    if (::uname(&name) != 0) {
+        return false;
+    }
+    int major = 0;
+    if (std::sscanf(name.release, "%d.", &major) != 1) {
+        return false;
+    }
+    return major >= 6;
+}
+
+}  // namespace
+
+Status IOURing::checkSupported() {
+    auto swRing = make(8);
+    if (!swRing.isOK()) {
+        return swRing.getStatus();
+    }
+    auto& ring = swRing.getValue();
+
+    constexpr unsigned kProbeOps = 256;
+    std::vector<char> probeStorage(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op));
+    auto probe = reinterpret_cast<io_uring_probe*>(probeStorage.data());
+    if (ioUringRegister(ring->_fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0) {
+        return errnoStatus("io_uring probe", errno);
+    }
+    for (auto op : {IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_READ,
+                    IORING_OP_ASYNC_CANCEL}) {
+        if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+            return {ErrorCodes::OperationFailed,
+                    str::stream() << "io_uring does not support opcode " << int(op)};
+        }
+    }
+
+    auto status = ring->registerBufferRing(0, 8, 4096);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    if (!kernelHasMultishotReceive()) {
+        return {ErrorCodes::OperationFailed, "io_uring multishot receive needs Linux 6.0"};
+    }
+    return Status::OK();
+}
+
+StatusWith<std::unique_ptr<IOURing>> IOURing::make(unsigned entries) {
+    std::unique_ptr<IOURing> ring(new IOURing());
+    auto status = ring->_init(entries);
+    if (!status.isOK()) {
+        return status;
+    }
+    return {std::move(ring)};
+}
+
+Status IOURing::_init(unsigned entries) {
+    _params.flags = IORING_SETUP_CLAMP;
+    _fd = ioUringSetup(entries, &_params);
+    if (_fd < 0) {
+        return errnoStatus("io_uring_setup", errno);
+    }
+
+    _sqRingSize = _params.sq_off.array + _params.sq_entries * sizeof(unsigned);
+    _cqRingSize = _params.cq_off.cqes + _params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = _params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        _sqRingSize = _cqRingSize = std::max(_sqRingSize, _cqRingSize);
+    }
+
+    _sqRing = ::mmap(nullptr,
+                     _sqRingSize,
+                     PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE,
+                     _fd,
+                     IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED) {
+        _sqRing = nullptr;
+        return errnoStatus("mmap of io_uring submission queue", errno);
+    }
+
+    if (singleMmap) {
+        _cqRing = _sqRing;
+    } else {
+        _cqRing = ::mmap(nullptr,
+                         _cqRingSize,
+                         PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE,
+                         _fd,
+                         IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED) {
+            _cqRing = nullptr;
+            return errnoStatus("mmap of io_uring completion queue", errno);
+        }
+    }
+
+    auto sqes = ::mmap(nullptr,
+                       _params.sq_entries * sizeof(io_uring_sqe),
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE,
+                       _fd,
+                       IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        return errnoStatus("mmap of io_uring submission entries", errno);
+    }
+    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto sq = static_cast<char*>(_sqRing);
+    _sq.head = reinterpret_cast<unsigned*>(sq + _params.sq_off.head);
+    _sq.tail = reinterpret_cast<unsigned*>(sq + _params.sq_off.tail);
+    _sq.ringMask = reinterpret_cast<unsigned*>(sq + _params.sq_off.ring_mask);
+    _sq.ringEntries = reinterpret_cast<unsigned*>(sq + _params.sq_off.ring_entries);
+    _sq.array = reinterpret_cast<unsigned*>(sq + _params.sq_off.array);
+
+    auto cq = static_cast<char*>(_cqRing);
+    _cq.head = reinterpret_cast<unsigned*>(cq + _params.cq_off.head);
+    _cq.tail = reinterpret_cast<unsigned*>(cq + _params.cq_off.tail);
+    _cq.ringMask = reinterpret_cast<unsigned*>(cq + _params.cq_off.ring_mask);
+    _cq.cqes = reinterpret_cast<io_uring_cqe*>(cq + _params.cq_off.cqes);
+
+    // Submission entries are always used in ring order, so the indirection array is fixed.
+    for (unsigned i = 0; i < *_sq.ringEntries; ++i) {
+        _sq.array[i] = i;
+    }
+    _sqeTail = _sqeSubmitted = *_sq.tail;
+
+    return Status::OK();
+}
+
+IOURing::~IOURing() {
+    // Closing the ring also drops the kernel's registration of the buffer ring.
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+    if (_bufferRing) {
+        ::munmap(_bufferRing, _bufferRingSize);
+    }
+    if (_sqes) {
+        ::munmap(_sqes, _params.sq_entries * sizeof(io_uring_sqe));
+    }
+    if (_cqRing && _cqRing != _sqRing) {
+        ::munmap(_cqRing, _cqRingSize);
+    }
+    if (_sqRing) {
+        ::munmap(_sqRing, _sqRingSize);
+    }
+}
+
+io_uring_sqe* IOURing::getSqe() {
+    const unsigned head = __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE);
+    if (_sqeTail - head >= *_sq.ringEntries) {
+        uassertStatusOK(submit());
+        invariant(_sqeTail - __atomic_load_n(_sq.head, __ATOMIC_ACQUIRE) < *_sq.ringEntries);
+    }
+
+    auto sqe = &_sqes[_sqeTail & *_sq.ringMask];
+    ++_sqeTail;
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+Status IOURing::submit(bool waitForCompletion) {
+    __atomic_store_n(_sq.tail, _sqeTail, __ATOMIC_RELEASE);
+
+    const unsigned toSubmit = _sqeTail - _sqeSubmitted;
+    if (toSubmit == 0 && !waitForCompletion) {
+        return Status::OK();
+    }
+
+    const unsigned flags = waitForCompletion ? IORING_ENTER_GETEVENTS : 0;
+    const int ret = ioUringEnter(_fd, toSubmit, waitForCompletion ? 1 : 0, flags);
+    if (ret < 0) {
+        const int err = errno;
+        // A signal may interrupt the wait, in which case the caller just goes around again.
+        return err == EINTR ? Status::OK() : errnoStatus("io_uring_enter", err);
+    }
+    _sqeSubmitted += ret;
+    return Status::OK();
+}
+
+Status IOURing::registerBufferRing(uint16_t groupId, uint16_t count, uint32_t size) {
+    invariant(!_bufferRing);
+    invariant(count && (count & (count - 1)) == 0);
+
+    _bufferRingSize = count * sizeof(io_uring_buf);
+    auto ringMem = ::mmap(
+        nullptr, _bufferRingSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ringMem == MAP_FAILED) {
+        return errnoStatus("mmap of io_uring buffer ring", errno);
+    }
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(ringMem);
+    reg.ring_entries = count;
+    reg.bgid = groupId;
+    if (ioUringRegister(_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        const int err = errno;
+        ::munmap(ringMem, _bufferRingSize);
+        return errnoStatus("io_uring buffer ring registration", err);
+    }
+
+    _bufferRing = static_cast<io_uring_buf*>(ringMem);
+    _bufferRingTail = reinterpret_cast<uint16_t*>(static_cast<char*>(ringMem) +
+                                                  offsetof(io_uring_buf_ring, tail));
+    _bufferCount = count;
+    _bufferSize = size;
+    _buffers.reset(new char[size_t(count) * size]);
+    for (uint16_t i = 0; i < count; ++i) {
+        recycleBuffer(i);
+    }
+    return Status::OK();
+}
+
+void IOURing::recycleBuffer(uint16_t bufferId) {
+    // The ring's tail shares storage with the first entry's reserved field, so entries are filled
+    // in field by field rather than assigned whole.
+    const uint16_t tail = *_bufferRingTail;
+    auto& buf = _bufferRing[tail & (_bufferCount - 1)];
+    buf.addr = reinterpret_cast<uint64_t>(providedBuffer(bufferId));
+    buf.len = _bufferSize;
+    buf.bid = bufferId;
+    __atomic_store_n(_bufferRingTail, uint16_t(tail + 1), __ATOMIC_RELEASE);
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <linux/io_uring.h>
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+
+namespace mongo {
+namespace transport {
+
+/**
+ * A single io_uring instance, driven directly through the kernel ABI so that no extra library is
+ * needed. IOURing is not thread safe: one thread prepares submissions, submits them and reaps
+ * completions.
+ *
+ * Besides the submission and completion queues it can own one ring of provided buffers, which
+ * the kernel picks from for receives marked with IOSQE_BUFFER_SELECT. The buffers are registered
+ * with the kernel once, so a multishot receive never has to name a buffer up front.
+ */
+class IOURing {
+    MONGO_DISALLOW_COPYING(IOURing);
+
+public:
+    /**
+     * Returns OK if the running kernel allows io_uring and supports every operation the io_uring
+     * transport layer relies on (multishot accept and receive from provided buffer rings).
+     */
+    static Status checkSupported();
+
+    static StatusWith<std::unique_ptr<IOURing>> make(unsigned entries);
+
+    ~IOURing();
+
+    /**
+     * Returns a zeroed submission queue entry, flushing queued entries to the kernel first if the
+     * submission queue is full.
+     */
+    io_uring_sqe* getSqe();
+
+    /**
+     * Hands all prepared entries to the kernel and, if 'waitForCompletion' is true, blocks until
+     * at least one completion is available.
+     */
+    Status submit(bool waitForCompletion = false);
+
+    /**
+     * Calls 'cb' with each available completion queue entry and returns how many there were.
+     */
+    template <typename Callback>
+    unsigned forEachCompletion(Callback&& cb) {
+        unsigned head = *_cq.head;
+        const unsigned tail = __atomic_load_n(_cq.tail, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        for (; head != tail; ++head, ++count) {
+            cb(_cq.cqes[head & *_cq.ringMask]);
+        }
+        __atomic_store_n(_cq.head, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    /**
+     * Registers 'count' buffers of 'size' bytes each as provided buffer group 'groupId'. 'count'
+     * must be a power of two.
+     */
+    Status registerBufferRing(uint16_t groupId, uint16_t count, uint32_t size);
+
+    const char* providedBuffer(uint16_t bufferId) const {
+        return _buffers.get() + size_t(bufferId) * _bufferSize;
+    }
+
+    /**
+     * Returns a provided buffer to the kernel once its contents have been consumed.
+     */
+    void recycleBuffer(uint16_t bufferId);
+
+private:
+    IOURing() = default;
+
+    Status _init(unsigned entries);
+
+    int _fd = -1;
+    io_uring_params _params{};
+
+    void* _sqRing = nullptr;
+    size_t _sqRingSize = 0;
+    void* _cqRing = nullptr;
+    size_t _cqRingSize = 0;
+    io_uring_sqe* _sqes = nullptr;
+
+    struct {
+        unsigned* head;
+        unsigned* tail;
+        unsigned* ringMask;
+        unsigned* ringEntries;
+        unsigned* array;
+    } _sq{};
+
+    struct {
+        unsigned* head;
+        unsigned* tail;
+        unsigned* ringMask;
+        io_uring_cqe* cqes;
+    } _cq{};
+
+    // Entries handed out by getSqe(), and how many of them the kernel has been told about.
+    unsigned _sqeTail = 0;
+    unsigned _sqeSubmitted = 0;
+
+    // The buffer ring is addressed as a plain array: in C++ the empty member in front of
+    // io_uring_buf_ring::bufs takes a byte and shifts the array away from the kernel's layout.
+    io_uring_buf* _bufferRing = nullptr;
+    uint16_t* _bufferRingTail = nullptr;
+    size_t _bufferRingSize = 0;
+    uint16_t _bufferCount = 0;
+    uint32_t _bufferSize = 0;
+    std::unique_ptr<char[]> _buffers;
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/config.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/message_compressor_snappy.h"
+#include "mongo/transport/message_compressor_zlib.h"
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+#include "mongo/transport/message_compressor_zstd.h"
+#endif
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+
+enum Compressor { kSnappy, kZlib, kZstdLevel1, kZstdLevel3, kZstdLevel9 };
+
+std::unique_ptr<MessageCompressorBase> makeCompressor(int which) {
+    switch (which) {
+        case kSnappy:
+            return stdx::make_unique<SnappyMessageCompressor>();
+        case kZlib:
+            return stdx::make_unique<ZlibMessageCompressor>();
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+        case kZstdLevel1:
+            return stdx::make_unique<ZstdMessageCompressor>(1);
+        case kZstdLevel3:
+            return stdx::make_unique<ZstdMessageCompressor>(3);
+        case kZstdLevel9:
+            return stdx::make_unique<ZstdMessageCompressor>(9);
+#endif
+    }
+    MONGO_UNREACHABLE;
+}
+
+/**
+ * A find reply batch of 'numDocs' order-like documents: repeated field names, a few
+ * low-cardinality strings, and numbers and dates that differ in every document.
+ */
+BSONObj makeReplyBatch(int numDocs) {
+    static const char* const kStatuses[] = {"pending", "shipped", "delivered", "returned"};
+    static const char* const kCities[] = {"Amsterdam", "Berlin", "Lisbon", "Oslo", "Prague"};
+
+    BSONArrayBuilder batch;
+    for (int i = 0; i < numDocs; ++i) {
+        BSONObjBuilder doc(batch.subobjStart());
+        doc.append("_id", OID::gen());
+        doc.append("customerId", (i * 7919) % 100000);
+        doc.append("status", kStatuses[i % 4]);
+        doc.appendDate("createdAt", Date_t::fromMillisSinceEpoch(1500000000000LL + i * 977LL));
+        {
+            BSONObjBuilder address(doc.subobjStart("shipTo"));
+            address.append("city", kCities[i % 5]);
+            address.append("zip", std::to_string(10000 + (i * 31) % 90000));
+        }
+        {
+            BSONArrayBuilder items(doc.subarrayStart("items"));
+            for (int j = 0; j < 1 + i % 4; ++j) {
+                items.append(BSON("sku"
+                                  << ("SKU-" + std::to_string((i + j) % 500))
+                                  << "qty"
+                                  << 1 + j
+                                  << "price"
+                                  << 9.99 * (1 + (i + j) % 20)));
+            }
+        }
+        doc.done();
+    }
+    return BSON("cursor" << BSON("firstBatch" << batch.arr() << "id" << 0LL << "ns"
+                                              << "shop.orders")
+                         << "ok"
+                         << 1.0);
+}
+
+void BM_Compress(benchmark::State& state) {
+    auto compressor = makeCompressor(state.range(0));
+    const auto reply = makeReplyBatch(state.range(1));
+    ConstDataRange input(reply.objdata(), reply.objsize());
+
+    std::vector<char> output(compressor->getMaxCompressedSize(input.length()));
+    size_t compressedSize = 0;
+    for (auto keepRunning : state) {
+        auto sws = compressor->compressData(input, DataRange(output.data(), output.size()));
+        invariant(sws.isOK());
+        compressedSize = sws.getValue();
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(state.iterations() * input.length());
+    state.counters["ratio"] = static_cast<double>(input.length()) / compressedSize;
+}
+
+void BM_Decompress(benchmark::State& state) {
+    auto compressor = makeCompressor(state.range(0));
+    const auto reply = makeReplyBatch(state.range(1));
+    ConstDataRange input(reply.objdata(), reply.objsize());
+
+    std::vector<char> compressed(compressor->getMaxCompressedSize(input.length()));
+    auto sws = compressor->compressData(input, DataRange(compressed.data(), compressed.size()));
+    invariant(sws.isOK());
+    ConstDataRange compressedRange(compressed.data(), sws.getValue());
+
+    std::vector<char> output(input.length());
+    for (auto keepRunning : state) {
+        auto swDecompressed =
+            compressor->decompressData(compressedRange, DataRange(output.data(), output.size()));
+        invariant(swDecompressed.isOK());
+        benchmark::DoNotOptimize(output.data());
+    }
+    state.SetBytesProcessed(state.iterations() * input.length());
+}
+
+// Small replies, full 101-document first batches, and large getMore batches.
+void compressorArgs(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"compressor", "docs"});
+    std::vector<int> compressors{kSnappy, kZlib};
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+    compressors.insert(compressors.end(), {kZstdLevel1, kZstdLevel3, kZstdLevel9});
+#endif
+    for (int compressor : compressors) {
+        for (int docs : {4, 101, 1000}) {
+            b->Args({compressor, docs});
+        }
+    }
+}
+
+BENCHMARK(BM_Compress)->Apply(compressorArgs);
+BENCHMARK(BM_Decompress)->Apply(compressorArgs);
+
+}  // namespace
+}  // namespace mongo
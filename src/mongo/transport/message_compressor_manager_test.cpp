@@ -31,6 +31,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/config.h"
 #include "mongo/rpc/message.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/message_compressor_manager.h"
@@ -38,6 +39,9 @@
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+#include "mongo/transport/message_compressor_zstd.h"
+#endif
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
 
@@ -241,6 +245,53 @@ TEST(ZlibMessageCompressor, Overflow) {
     checkOverflow(stdx::make_unique<ZlibMessageCompressor>());
 }
 
+#ifdef MONGO_CONFIG_HAVE_ZSTD
+TEST(ZstdMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, stdx::make_unique<ZstdMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, Overflow) {
+    checkOverflow(stdx::make_unique<ZstdMessageCompressor>());
+}
+
+TEST(ZstdMessageCompressor, HigherLevelCompressesBatchBetter) {
+    // A reply batch of similar documents, like a find or getMore returns.
+    BSONArrayBuilder batch;
+    for (int i = 0; i < 500; ++i) {
+        batch.append(BSON("_id" << i << "name"
+                                << ("user" + std::to_string(i % 37))
+                                << "status"
+                                << (i % 3 ? "active" : "inactive")
+                                << "score"
+                                << i * 7 % 101));
+    }
+    const auto reply = BSON("cursor" << BSON("firstBatch" << batch.arr()));
+    ConstDataRange input(reply.objdata(), reply.objsize());
+
+    auto compress = [&](int level) {
+        ZstdMessageCompressor compressor(level);
+        std::vector<char> compressed(compressor.getMaxCompressedSize(input.length()));
+        auto compressedSize = assertOk(
+            compressor.compressData(input, DataRange(compressed.data(), compressed.size())));
+        compressed.resize(compressedSize);
+
+        std::vector<char> decompressed(input.length());
+        ASSERT_EQ(assertOk(compressor.decompressData(
+                      ConstDataRange(compressed.data(), compressed.size()),
+                      DataRange(decompressed.data(), decompressed.size()))),
+                  input.length());
+        ASSERT_EQ(memcmp(decompressed.data(), input.data(), input.length()), 0);
+        return compressed.size();
+    };
+
+    const auto fastSize = compress(1);
+    const auto smallSize = compress(19);
+    ASSERT_LT(fastSize, input.length() / 4);
+    ASSERT_LTE(smallSize, fastSize);
+}
+#endif
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd.h"
+
+#include "mongo/base/init.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/util/mongoutils/str.h"
+
+#include <zstd.h>
+
+namespace mongo {
+
+int zstdCompressionLevel = ZstdMessageCompressor::kDefaultCompressionLevel;
+
+namespace {
+
+MONGO_COMPILER_VARIABLE_UNUSED auto _exportedZstdCompressionLevel =
+    (new ExportedServerParameter<int, ServerParameterType::kStartupOnly>(
+        ServerParameterSet::getGlobal(), "zstdCompressionLevel", &zstdCompressionLevel))
+        -> withValidator([](const int& potentialNewValue) {
+            if (potentialNewValue < 1 || potentialNewValue > ZSTD_maxCLevel()) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "zstdCompressionLevel must be between 1 and "
+                                            << ZSTD_maxCLevel()
+                                            << ", inclusive");
+            }
+            return Status::OK();
+        });
+
+// Creating a zstd context allocates several hundred KB, so each thread keeps one of each for all
+// the messages it compresses or decompresses.
+struct ZstdContexts {
+    ~ZstdContexts() {
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+    }
+
+    ZSTD_CCtx* cctx = nullptr;
+    ZSTD_DCtx* dctx = nullptr;
+};
+
+thread_local ZstdContexts zstdContexts;
+
+}  // namespace
+
+ZstdMessageCompressor::ZstdMessageCompressor(int level)
+    : MessageCompressorBase(MessageCompressor::kZstd), _level(level) {}
+
+std::size_t ZstdMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize);
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::compressData(ConstDataRange input,
+                                                            DataRange output) {
+    auto& cctx = zstdContexts.cctx;
+    if (!cctx && !(cctx = ZSTD_createCCtx())) {
+        return Status{ErrorCodes::ExceededMemoryLimit, "Could not allocate zstd context"};
+    }
+
+    const size_t outLength = ZSTD_compressCCtx(cctx,
+                                               const_cast<char*>(output.data()),
+                                               output.length(),
+                                               input.data(),
+                                               input.length(),
+                                               _level);
+    if (ZSTD_isError(outLength)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: "
+                                    << ZSTD_getErrorName(outLength)};
+    }
+
+    counterHitCompress(input.length(), outLength);
+    return {outLength};
+}
+
+StatusWith<std::size_t> ZstdMessageCompressor::decompressData(ConstDataRange input,
+                                                              DataRange output) {
+    auto& dctx = zstdContexts.dctx;
+    if (!dctx && !(dctx = ZSTD_createDCtx())) {
+        return Status{ErrorCodes::ExceededMemoryLimit, "Could not allocate zstd context"};
+    }
+
+    const size_t length = ZSTD_decompressDCtx(
+        dctx, const_cast<char*>(output.data()), output.length(), input.data(), input.length());
+    if (ZSTD_isError(length) || length != output.length()) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+
+    counterHitDecompress(input.length(), output.length());
+    return {output.length()};
+}
+
+MONGO_INITIALIZER_GENERAL(ZstdMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(
+        stdx::make_unique<ZstdMessageCompressor>(zstdCompressionLevel));
+    return Status::OK();
+}
+}  // namespace mongo
@@ -98,7 +98,7 @@ void ThreadGroup::trySleep() {
         return;
     }
 
-    MONGO_LOG(0) << "sleep";
+    MONGO_LOG(3) << "sleep";
 #ifdef EXT_TX_PROC_ENABLED
     _updateExtProc(-1);
 #endif
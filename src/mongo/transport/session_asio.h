@@ -30,15 +30,20 @@
 
 #include "asio/write.hpp"
 #include <utility>
+#include <vector>
 
+#include "mongo/base/checked_cast.h"
 #include "mongo/base/system_error.h"
 #include "mongo/config.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/transport/asio_utils.h"
 #include "mongo/transport/baton.h"
 #include "mongo/transport/transport_layer_asio.h"
+#include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/net/socket_utils.h"
+#include "mongo/util/time_support.h"
 #ifdef MONGO_CONFIG_SSL
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_types.h"
@@ -54,6 +59,13 @@ namespace transport {
 
 MONGO_FAIL_POINT_DEFINE(transportLayerASIOshortOpportunisticReadWrite);
 
+// An ingress session holds back replies while the client's next request is already buffered on
+// the socket, and writes them together once this many bytes are queued. 0 disables coalescing.
+MONGO_EXPORT_SERVER_PARAMETER(transportCoalescedRepliesMaxBytes, int, 256 * 1024);
+
+// The longest a reply may be held back waiting for later replies to join it.
+MONGO_EXPORT_SERVER_PARAMETER(transportCoalescedRepliesMaxDelayMicros, int, 1000);
+
 template <typename SuccessValue>
 auto futurize(const std::error_code& ec, SuccessValue&& successValue) {
     using Result = Future<std::decay_t<SuccessValue>>;
@@ -99,6 +111,16 @@ public:
     }
 
     ~ASIOSession() {
+        if (hasPendingReplies()) {
+            // The request after these replies ended the session before they were flushed. Send
+            // them with a bounded blocking write, as nothing is left to wait on an asynchronous
+            // one.
+            std::error_code ec;
+            getSocket().non_blocking(false, ec);
+            getSocket().set_option(ASIOSocketTimeoutOption<SO_SNDTIMEO>(kFinalFlushTimeout), ec);
+            _blockingMode = Sync;
+            flushReplies().getNoThrow().ignore();
+        }
         end();
     }
 
@@ -150,6 +172,11 @@ public:
     Future<void> asyncSinkMessage(Message message,
                                   const transport::BatonHandle& baton = nullptr) override {
         ensureAsync();
+
+        if ((!_requestReadBlocked && canCoalesceReplies()) || hasPendingReplies()) {
+            return coalesceReply(std::move(message), baton);
+        }
+
         return write(asio::buffer(message.buf(), message.size()), baton)
             .then([this, message /*keep the buffer alive*/]() {
                 if (_isIngressSession) {
@@ -278,6 +305,9 @@ protected:
         if (_blockingMode == Async)
             return;
 
+        // Replies are only held back between a sink and the next source in the same mode.
+        invariant(_pendingReplies.empty());
+
         // Socket timeouts currently only effect synchronous calls, so make sure the caller isn't
         // expecting a socket timeout when they do an async operation.
         invariant(!_configuredTimeout);
@@ -340,9 +370,236 @@ private:
         return _socket;
     }
 
+    /**
+     * Replies are only coalesced on plain asynchronous ingress connections. The bytes buffered on
+     * a TLS socket say nothing about whether a whole request is waiting behind them, and a
+     * synchronous session has no reactor to run the flush timer while it executes a request.
+     */
+    bool canCoalesceReplies() {
+#ifdef MONGO_CONFIG_SSL
+        if (_sslSocket) {
+            return false;
+        }
+#endif
+        return _isIngressSession && _blockingMode == Async &&
+            transportCoalescedRepliesMaxBytes.load() > 0;
+    }
+
+    bool hasPendingReplies() {
+        stdx::lock_guard<stdx::mutex> lk(_pendingRepliesMutex);
+        return !_pendingReplies.empty();
+    }
+
+    /**
+     * Returns true if a complete request is already buffered in the socket, so the next
+     * sourceMessage() will not block and the replies queued so far can wait for its reply.
+     */
+    bool nextRequestBuffered() {
+        static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
+
+        networkCounter.hitBufferedRequestCheck();
+        std::error_code ec;
+        const auto available = _socket.available(ec);
+        if (ec || available < kHeaderSize) {
+            return false;
+        }
+
+        char header[kHeaderSize];
+        // Peeking cannot block here because at least a header's worth of bytes is buffered.
+        _socket.receive(asio::buffer(header, kHeaderSize), asio::socket_base::message_peek, ec);
+        if (ec) {
+            return false;
+        }
+
+        const auto msgLen = size_t(MSGHEADER::ConstView(header).getMessageLength());
+        return msgLen >= kHeaderSize && msgLen <= MaxMessageSizeBytes && available >= msgLen;
+    }
+
+    /**
+     * Queues 'message' and writes out the queue unless the client has already sent its next
+     * request and the queue is still within the byte and count caps. A reply that is held back
+     * is written by the flush timer once it has waited transportCoalescedRepliesMaxDelayMicros,
+     * even if the request after it is still executing.
+     */
+    Future<void> coalesceReply(Message message, const transport::BatonHandle& baton = nullptr) {
+        stdx::unique_lock<stdx::mutex> lk(_pendingRepliesMutex);
+        if (_pendingReplies.empty()) {
+            _pendingSinceMicros = curTimeMicros64();
+        }
+        _pendingBytes += message.size();
+        _pendingReplies.push_back(std::move(message));
+
+        if (_pendingReplies.size() < kMaxCoalescedReplies &&
+            _pendingBytes < size_t(transportCoalescedRepliesMaxBytes.load()) &&
+            pendingRepliesWaitLeft(lk) > Microseconds(0) && nextRequestBuffered()) {
+            armFlushTimer(lk);
+            return Future<void>::makeReady();
+        }
+
+        lk.unlock();
+        return flushReplies(baton);
+    }
+
+    /**
+     * Returns true if the queued replies must be written before reading the next request: a
+     * request that does not expect a reply (moreToCome) can leave replies queued behind it, and
+     * they may only keep waiting if the read is known not to block.
+     */
+    bool mustFlushBeforeSource() {
+        stdx::lock_guard<stdx::mutex> lk(_pendingRepliesMutex);
+        return !_pendingReplies.empty() &&
+            (pendingRepliesWaitLeft(lk) == Microseconds(0) || !nextRequestBuffered());
+    }
+
+    // How much longer the oldest queued reply may wait for later replies to join it.
+    Microseconds pendingRepliesWaitLeft(WithLock) const {
+        const auto maxDelay = static_cast<unsigned long long>(
+            std::max(transportCoalescedRepliesMaxDelayMicros.load(), 0));
+        const auto waited = curTimeMicros64() - _pendingSinceMicros;
+        return Microseconds(waited >= maxDelay ? 0 : static_cast<long long>(maxDelay - waited));
+    }
+
+    /**
+     * Arms the timer that writes the queued replies once the oldest of them has waited its
+     * longest. Its handler runs on the session's reactor, possibly while the session is executing
+     * the next request.
+     */
+    void armFlushTimer(WithLock lk) {
+        if (_flushTimerArmed) {
+            return;
+        }
+        if (!_flushTimer) {
+            _flushTimer.emplace(_socket.get_io_context());
+        }
+        _flushTimerArmed = true;
+        _flushTimer->expires_after(std::chrono::microseconds(pendingRepliesWaitLeft(lk).count()));
+        _flushTimer->async_wait([weakSession = weak_from_this()](const std::error_code& ec) {
+            if (ec) {
+                // Cancelled by a flush or by the session's destruction.
+                return;
+            }
+            if (auto session = weakSession.lock()) {
+                checked_cast<ASIOSession*>(session.get())->onFlushTimer();
+            }
+        });
+    }
+
+    void cancelFlushTimer(WithLock) {
+        if (_flushTimerArmed) {
+            _flushTimer->cancel();
+            _flushTimerArmed = false;
+        }
+    }
+
+    void onFlushTimer() {
+        stdx::lock_guard<stdx::mutex> lk(_pendingRepliesMutex);
+        _flushTimerArmed = false;
+        if (_pendingReplies.empty()) {
+            return;
+        }
+        if (pendingRepliesWaitLeft(lk) > Microseconds(0)) {
+            // The expiry of a timer armed for replies that have been flushed since.
+            armFlushTimer(lk);
+            return;
+        }
+
+        // The socket is non-blocking, so this writes what it takes right now. A write error is
+        // left for the session's next flush to report.
+        std::error_code ec;
+        writePendingReplies(lk, &ec);
+        if (!_pendingReplies.empty() &&
+            ((ec == asio::error::would_block) || (ec == asio::error::try_again))) {
+            _pendingSinceMicros = curTimeMicros64();
+            armFlushTimer(lk);
+        }
+    }
+
+    std::vector<asio::const_buffer> pendingReplyBuffers(WithLock) const {
+        std::vector<asio::const_buffer> buffers;
+        buffers.reserve(_pendingReplies.size());
+        size_t skip = _pendingHeadOffset;
+        for (const auto& reply : _pendingReplies) {
+            buffers.push_back(asio::buffer(reply.buf() + skip, reply.size() - skip));
+            skip = 0;
+        }
+        return buffers;
+    }
+
+    /**
+     * Writes the queued replies with a single gathered write and drops what it wrote from the
+     * queue. A reply only partly written stays at its head, with _pendingHeadOffset marking the
+     * bytes already sent.
+     */
+    void writePendingReplies(WithLock lk, std::error_code* ec) {
+        size_t written = asio::write(_socket, pendingReplyBuffers(lk), *ec);
+        networkCounter.hitPhysicalOut(written);
+        _pendingBytes -= written;
+
+        size_t completed = 0;
+        written += _pendingHeadOffset;
+        while (completed < _pendingReplies.size() && written >= _pendingReplies[completed].size()) {
+            written -= _pendingReplies[completed].size();
+            ++completed;
+        }
+        _pendingReplies.erase(_pendingReplies.begin(), _pendingReplies.begin() + completed);
+        _pendingHeadOffset = written;
+        if (completed > 0) {
+            networkCounter.hitReplyWrite(completed);
+        }
+    }
+
+    void clearPendingReplies(WithLock) {
+        _pendingReplies.clear();
+        _pendingBytes = 0;
+        _pendingHeadOffset = 0;
+    }
+
+    /**
+     * Writes every queued reply with a single gathered write. If a non-blocking socket only
+     * takes part of it, the rest is copied into one buffer and finished by opportunisticWrite().
+     */
+    Future<void> flushReplies(const transport::BatonHandle& baton = nullptr) {
+        stdx::unique_lock<stdx::mutex> lk(_pendingRepliesMutex);
+        cancelFlushTimer(lk);
+
+        std::error_code ec;
+        writePendingReplies(lk, &ec);
+        if (_pendingReplies.empty() || (_blockingMode != Async) ||
+            ((ec != asio::error::would_block) && (ec != asio::error::try_again))) {
+            clearPendingReplies(lk);
+            return futurize(ec);
+        }
+
+        const auto bytes = _pendingBytes;
+        const auto count = _pendingReplies.size();
+        auto rest = SharedBuffer::allocate(bytes);
+        auto dst = rest.get();
+        for (const auto& buffer : pendingReplyBuffers(lk)) {
+            memcpy(dst, buffer.data(), buffer.size());
+            dst += buffer.size();
+        }
+        // Nothing can queue a reply or arm the timer again until this write completes, since the
+        // session waits on it before sourcing or sinking anything else.
+        clearPendingReplies(lk);
+        lk.unlock();
+
+        auto ptr = rest.get();
+        return opportunisticWrite(_socket, asio::buffer(ptr, bytes), baton)
+            .then([ rest = std::move(rest), bytes, count ] {
+                networkCounter.hitPhysicalOut(bytes);
+                networkCounter.hitReplyWrite(count);
+            });
+    }
+
     Future<Message> sourceMessageImpl(const transport::BatonHandle& baton = nullptr) {
         static constexpr auto kHeaderSize = sizeof(MSGHEADER::Value);
 
+        if (mustFlushBeforeSource()) {
+            return flushReplies(baton).then(
+                [this, baton] { return sourceMessageImpl(baton); });
+        }
+        _requestReadBlocked = false;
+
         auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
         auto ptr = headerBuffer.get();
         return read(asio::buffer(ptr, kHeaderSize), baton)
@@ -466,6 +723,7 @@ private:
             if (size > 0) {
                 asyncBuffers += size;
             }
+            _requestReadBlocked = true;
 
             if (baton) {
                 return baton->addSession(*this, Baton::Type::In)
@@ -709,6 +967,29 @@ private:
 
     TransportLayerASIO* const _tl;
     bool _isIngressSession;
+
+    // Whether reading the current request had to wait for it. The reply to such a request is
+    // written right away without checking for a buffered next request: the client most likely
+    // waited for its previous reply before sending, so the check would only cost syscalls.
+    bool _requestReadBlocked = true;
+
+    // asio gathers at most this many buffers into one writev.
+    static constexpr size_t kMaxCoalescedReplies = 64;
+
+    // How long a session being destroyed may block writing the replies it still holds.
+    static constexpr Milliseconds kFinalFlushTimeout{1000};
+
+    // Guards the reply queue and its timer: the timer's handler writes the queue from the
+    // session's reactor while the session itself may be executing the next request.
+    stdx::mutex _pendingRepliesMutex;
+    // Replies held back by coalesceReply(), oldest first.
+    std::vector<Message> _pendingReplies;
+    // Unwritten bytes in _pendingReplies, and bytes of its head already written.
+    size_t _pendingBytes = 0;
+    size_t _pendingHeadOffset = 0;
+    unsigned long long _pendingSinceMicros = 0;
+    boost::optional<asio::steady_timer> _flushTimer;
+    bool _flushTimerArmed = false;
 };
 
 }  // namespace transport
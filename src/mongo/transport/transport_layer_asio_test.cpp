@@ -32,12 +32,15 @@
 #include "mongo/transport/transport_layer_asio.h"
 
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/counters.h"
 #include "mongo/rpc/op_msg.h"
 #include "mongo/transport/service_entry_point.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/sock.h"
+#include "mongo/util/scopeguard.h"
 
 #include "asio.hpp"
 
@@ -249,15 +252,38 @@ public:
     }
 
     void sendMessage() {
-        OpMsgBuilder builder;
-        builder.setBody(BSON("ping" << 1));
-        Message msg = builder.finish();
-        msg.header().setResponseToMsgId(0);
-        msg.header().setId(0);
+        sendMessages(1);
+    }
+
+    // Sends 'count' pings back to back in a single write.
+    void sendMessages(int count) {
+        std::string pipelined;
+        for (int i = 0; i < count; ++i) {
+            OpMsgBuilder builder;
+            builder.setBody(BSON("ping" << 1));
+            Message msg = builder.finish();
+            msg.header().setResponseToMsgId(0);
+            msg.header().setId(i);
+            pipelined.append(msg.buf(), msg.size());
+        }
+
+        std::error_code ec;
+        asio::write(_sock, asio::buffer(pipelined), ec);
+        ASSERT_FALSE(ec);
+    }
 
+    Message receiveMessage() {
+        auto buffer = SharedBuffer::allocate(sizeof(MSGHEADER::Value));
         std::error_code ec;
-        asio::write(_sock, asio::buffer(msg.buf(), msg.size()), ec);
+        asio::read(_sock, asio::buffer(buffer.get(), sizeof(MSGHEADER::Value)), ec);
+        ASSERT_FALSE(ec);
+
+        const auto msgLen = size_t(MSGHEADER::View(buffer.get()).getMessageLength());
+        buffer.realloc(msgLen);
+        MsgData::View msgView(buffer.get());
+        asio::read(_sock, asio::buffer(msgView.data(), msgView.dataLen()), ec);
         ASSERT_FALSE(ec);
+        return Message(std::move(buffer));
     }
 
 private:
@@ -358,5 +384,198 @@ TEST(TransportLayerASIO, SwitchTimeoutModes) {
     tla->shutdown();
 }
 
+/* runs the ingress reactors, which complete asynchronous session I/O and fire session timers */
+class IngressReactorThreads {
+public:
+    explicit IngressReactorThreads(transport::TransportLayerASIO* tla)
+        : _reactors(tla->getIngressReactors()) {
+        for (auto& reactor : _reactors) {
+            _threads.emplace_back([reactor] { reactor->run(); });
+        }
+    }
+
+    ~IngressReactorThreads() {
+        for (auto& reactor : _reactors) {
+            reactor->stop();
+        }
+        for (auto& thread : _threads) {
+            thread.join();
+        }
+    }
+
+private:
+    std::vector<transport::ReactorHandle> _reactors;
+    std::vector<stdx::thread> _threads;
+};
+
+Message makeReply(const Message& request) {
+    OpMsgBuilder builder;
+    builder.setBody(BSON("ok" << 1));
+    Message reply = builder.finish();
+    reply.header().setResponseToMsgId(request.header().getId());
+    return reply;
+}
+
+/* check that replies to pipelined requests leave the server in fewer writes than replies */
+class PipelinedRepliesSEP : public TimeoutSEP {
+public:
+    explicit PipelinedRepliesSEP(int numRequests) : _numRequests(numRequests) {}
+
+    void startSession(transport::SessionHandle session) override {
+        stdx::thread([ this, session = std::move(session) ]() mutable {
+            for (int i = 0; i < _numRequests; ++i) {
+                auto swRequest = session->asyncSourceMessage().getNoThrow();
+                ASSERT_OK(swRequest.getStatus());
+                ASSERT_OK(session->asyncSinkMessage(makeReply(swRequest.getValue())).getNoThrow());
+            }
+
+            session.reset();
+            notifyComplete();
+        }).detach();
+    }
+
+private:
+    const int _numRequests;
+};
+
+BSONObj coalescedReplyCounters() {
+    BSONObjBuilder bob;
+    networkCounter.append(bob);
+    return bob.obj()["coalescedReplies"].Obj().getOwned();
+}
+
+ServerParameter* coalescedRepliesMaxDelayParam() {
+    return ServerParameterSet::getGlobal()
+        ->getMap()
+        .find("transportCoalescedRepliesMaxDelayMicros")
+        ->second;
+}
+
+TEST(TransportLayerASIO, PipelinedRepliesAreCoalesced) {
+    // Keep a slow test host from flushing early on the latency cap.
+    auto maxDelayParam = coalescedRepliesMaxDelayParam();
+    ASSERT_OK(maxDelayParam->setFromString("10000000"));
+    ON_BLOCK_EXIT([&] { maxDelayParam->setFromString("1000").ignore(); });
+
+    const int kNumRequests = 8;
+    PipelinedRepliesSEP sep(kNumRequests);
+    auto tla = makeAndStartTL(&sep);
+    IngressReactorThreads reactorThreads(tla.get());
+
+    const auto before = coalescedReplyCounters();
+
+    TimeoutConnector connector(tla->listenerPort(), false);
+    connector.sendMessages(kNumRequests);
+    for (int i = 0; i < kNumRequests; ++i) {
+        ASSERT_EQ(connector.receiveMessage().header().getResponseToMsgId(), i);
+    }
+    ASSERT_TRUE(sep.waitForTimeout());
+
+    const auto after = coalescedReplyCounters();
+    const auto writes = after["writes"].numberLong() - before["writes"].numberLong();
+    const auto replies = after["replies"].numberLong() - before["replies"].numberLong();
+    // The first reply is written right away if the session started reading before the requests
+    // arrived.
+    ASSERT_GTE(replies, kNumRequests - 1);
+    ASSERT_GTE(writes, 1);
+    ASSERT_LT(writes, replies);
+
+    tla->shutdown();
+}
+
+TEST(TransportLayerASIO, RequestResponseRepliesSkipBufferedRequestCheck) {
+    const int kNumRequests = 8;
+    PipelinedRepliesSEP sep(kNumRequests);
+    auto tla = makeAndStartTL(&sep);
+    IngressReactorThreads reactorThreads(tla.get());
+
+    const auto before = coalescedReplyCounters();
+
+    TimeoutConnector connector(tla->listenerPort(), false);
+    for (int i = 0; i < kNumRequests; ++i) {
+        connector.sendMessage();
+        ASSERT_EQ(connector.receiveMessage().header().getResponseToMsgId(), 0);
+    }
+    ASSERT_TRUE(sep.waitForTimeout());
+
+    // Only the first request may have arrived before the session started reading. Every later one
+    // is read after the reply before it, so its reply is written without peeking at the socket.
+    const auto after = coalescedReplyCounters();
+    ASSERT_LTE(after["bufferedRequestChecks"].numberLong() -
+                   before["bufferedRequestChecks"].numberLong(),
+               1);
+
+    tla->shutdown();
+}
+
+/*
+ * check that a held reply is not kept waiting while a slow request behind it executes. The reply
+ * to the first request is only held if that request had arrived when the session started reading,
+ * so the reply to the second request, which is always buffered behind it, is the one checked.
+ */
+class SlowThirdRequestSEP : public TimeoutSEP {
+public:
+    void startSession(transport::SessionHandle session) override {
+        stdx::thread([ this, session = std::move(session) ]() mutable {
+            for (int i = 0; i < 2; ++i) {
+                auto swRequest = session->asyncSourceMessage().getNoThrow();
+                ASSERT_OK(swRequest.getStatus());
+                ASSERT_OK(session->asyncSinkMessage(makeReply(swRequest.getValue())).getNoThrow());
+            }
+
+            auto swThird = session->asyncSourceMessage().getNoThrow();
+            ASSERT_OK(swThird.getStatus());
+
+            // Execute the third request until the client has the second reply.
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _heldReplyArrived = _cond.wait_for(
+                    lk, Seconds(30).toSystemDuration(), [this] { return _heldReplySeen; });
+            }
+
+            ASSERT_OK(session->asyncSinkMessage(makeReply(swThird.getValue())).getNoThrow());
+            session.reset();
+            notifyComplete();
+        }).detach();
+    }
+
+    void heldReplySeen() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _heldReplySeen = true;
+        _cond.notify_one();
+    }
+
+    bool heldReplyArrivedDuringThirdRequest() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _heldReplyArrived;
+    }
+
+private:
+    stdx::mutex _mutex;
+    stdx::condition_variable _cond;
+    bool _heldReplySeen = false;
+    bool _heldReplyArrived = false;
+};
+
+TEST(TransportLayerASIO, HeldReplyIsFlushedWhileNextRequestRuns) {
+    auto maxDelayParam = coalescedRepliesMaxDelayParam();
+    ASSERT_OK(maxDelayParam->setFromString("1000"));
+
+    SlowThirdRequestSEP sep;
+    auto tla = makeAndStartTL(&sep);
+    IngressReactorThreads reactorThreads(tla.get());
+
+    TimeoutConnector connector(tla->listenerPort(), false);
+    connector.sendMessages(3);
+    ASSERT_EQ(connector.receiveMessage().header().getResponseToMsgId(), 0);
+    ASSERT_EQ(connector.receiveMessage().header().getResponseToMsgId(), 1);
+    sep.heldReplySeen();
+    ASSERT_EQ(connector.receiveMessage().header().getResponseToMsgId(), 2);
+    ASSERT_TRUE(sep.waitForTimeout());
+    ASSERT_TRUE(sep.heldReplyArrivedDuringThirdRequest());
+
+    tla->shutdown();
+}
+
 }  // namespace
 }  // namespace mongo
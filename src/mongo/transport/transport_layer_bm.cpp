@@ -0,0 +1,344 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mongo/db/server_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/session.h"
+#include "mongo/transport/transport_layer_asio.h"
+#include "mongo/transport/transport_layer_io_uring.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+const int kMaxPerfThreads = 16;
+const size_t kPayloadSize = 128;
+
+enum Backend { kASIO = 0, kIOUring = 1 };
+
+/**
+ * Sends every request back to its sender, chaining asyncSourceMessage() and asyncSinkMessage() the
+ * way the ServiceStateMachine does in asynchronous mode.
+ */
+class EchoSEP : public ServiceEntryPoint {
+public:
+    Status start() override {
+        return Status::OK();
+    }
+
+    void startSession(SessionHandle session) override {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            ++_sessions;
+        }
+        _echo(std::move(session));
+    }
+
+    void endAllSessions(Session::TagMask tags) override {}
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    Stats sessionStats() const override {
+        return {};
+    }
+
+    size_t numOpenSessions() const override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _sessions;
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    ServiceExecutor* getServiceExecutor() override {
+        return nullptr;
+    }
+
+    void waitForSessionsToEnd() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _sessionEnded.wait(lk, [&] { return _sessions == 0; });
+    }
+
+private:
+    void _echo(SessionHandle session) {
+        auto sessionPtr = session.get();
+        sessionPtr->asyncSourceMessage().getAsync(
+            [ this, session = std::move(session) ](StatusWith<Message> swRequest) mutable {
+                if (!swRequest.isOK()) {
+                    return _endSession(std::move(session));
+                }
+
+                auto sessionPtr = session.get();
+                sessionPtr->asyncSinkMessage(std::move(swRequest.getValue()))
+                    .getAsync([ this, session = std::move(session) ](Status status) mutable {
+                        if (!status.isOK()) {
+                            return _endSession(std::move(session));
+                        }
+                        _echo(std::move(session));
+                    });
+            });
+    }
+
+    void _endSession(SessionHandle session) {
+        session.reset();
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (--_sessions == 0) {
+            _sessionEnded.notify_all();
+        }
+    }
+
+    mutable stdx::mutex _mutex;
+    stdx::condition_variable _sessionEnded;
+    size_t _sessions = 0;
+};
+
+/**
+ * A loopback server on one backend, shared by all benchmark threads. Each thread is a blocking
+ * client doing one request at a time on its own connection.
+ */
+class TransportLayerBM : public benchmark::Fixture {
+public:
+    Status startServer(Backend backend) {
+        TransportLayerASIO::Options opts;
+        opts.port = 0;
+        opts.ipList = {"127.0.0.1"};
+        opts.useUnixSockets = false;
+        opts.transportMode = Mode::kAsynchronous;
+
+        if (backend == kIOUring) {
+            auto status = TransportLayerIOUring::checkSupported();
+            if (!status.isOK()) {
+                return status;
+            }
+            auto tl = stdx::make_unique<TransportLayerIOUring>(opts, &_sep);
+            _tl = std::move(tl);
+        } else {
+            auto tl = stdx::make_unique<TransportLayerASIO>(opts, &_sep);
+            // The asio backend runs its sessions on the ingress reactors, which the service
+            // executor would normally drive.
+            for (auto& reactor : tl->getIngressReactors()) {
+                _reactors.push_back(reactor);
+                _reactorThreads.emplace_back([reactor] { reactor->run(); });
+            }
+            _tl = std::move(tl);
+        }
+
+        auto status = _tl->setup();
+        if (status.isOK()) {
+            status = _tl->start();
+        }
+        return status;
+    }
+
+    int listenerPort() const {
+        if (auto asio = dynamic_cast<TransportLayerASIO*>(_tl.get())) {
+            return asio->listenerPort();
+        }
+        return checked_cast<TransportLayerIOUring*>(_tl.get())->listenerPort();
+    }
+
+    void stopServer() {
+        _sep.waitForSessionsToEnd();
+        _tl->shutdown();
+        for (auto& reactor : _reactors) {
+            reactor->stop();
+        }
+        for (auto& thread : _reactorThreads) {
+            thread.join();
+        }
+        _tl.reset();
+        _reactors.clear();
+        _reactorThreads.clear();
+    }
+
+    /**
+     * Called by thread 0 once the server is up, or failed to start. Other threads wait for it.
+     */
+    void publishServer(Status status) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _serverStatus = std::move(status);
+        _serverReady = true;
+        _serverReadyCond.notify_all();
+    }
+
+    Status waitForServer() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _serverReadyCond.wait(lk, [&] { return _serverReady; });
+        return _serverStatus;
+    }
+
+    /**
+     * Called by every thread once it no longer uses the server.
+     */
+    void clientDone() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        ++_clientsDone;
+        _serverReadyCond.notify_all();
+    }
+
+    /**
+     * Called by thread 0 to wait for the other threads before tearing the server down, so that the
+     * next run starts from a clean state.
+     */
+    void waitForClients(int numThreads) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _serverReadyCond.wait(lk, [&] { return _clientsDone == numThreads; });
+        _serverReady = false;
+        _serverStatus = Status::OK();
+        _clientsDone = 0;
+    }
+
+private:
+    EchoSEP _sep;
+    std::unique_ptr<TransportLayer> _tl;
+    std::vector<ReactorHandle> _reactors;
+    std::vector<stdx::thread> _reactorThreads;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _serverReadyCond;
+    bool _serverReady = false;
+    Status _serverStatus = Status::OK();
+    int _clientsDone = 0;
+};
+
+int connectToServer(int port) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    invariant(fd >= 0);
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    invariant(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+void sendAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        auto ret = ::send(fd, data, len, MSG_NOSIGNAL);
+        invariant(ret > 0);
+        data += ret;
+        len -= ret;
+    }
+}
+
+void recvAll(int fd, char* data, size_t len) {
+    while (len > 0) {
+        auto ret = ::recv(fd, data, len, 0);
+        invariant(ret > 0);
+        data += ret;
+        len -= ret;
+    }
+}
+
+long long processCpuMicros() {
+    rusage usage;
+    invariant(::getrusage(RUSAGE_SELF, &usage) == 0);
+    auto micros = [](const timeval& tv) { return tv.tv_sec * 1000 * 1000LL + tv.tv_usec; };
+    return micros(usage.ru_utime) + micros(usage.ru_stime);
+}
+
+BENCHMARK_DEFINE_F(TransportLayerBM, BM_PingPong)(benchmark::State& state) {
+    if (state.thread_index == 0) {
+        publishServer(startServer(static_cast<Backend>(state.range(0))));
+    }
+
+    auto status = waitForServer();
+    if (!status.isOK()) {
+        state.SkipWithError(status.reason().c_str());
+        clientDone();
+        if (state.thread_index == 0) {
+            waitForClients(state.threads);
+        }
+        return;
+    }
+
+    const std::string payload(kPayloadSize, 'x');
+    Message request;
+    request.setData(dbMsg, payload.data(), payload.size());
+    std::vector<char> reply(request.size());
+
+    const int fd = connectToServer(listenerPort());
+    long long cpuStart = 0;
+    for (auto keepRunning : state) {
+        if (cpuStart == 0 && state.thread_index == 0) {
+            cpuStart = processCpuMicros();
+        }
+        sendAll(fd, request.buf(), request.size());
+        recvAll(fd, reply.data(), reply.size());
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index == 0) {
+        // Process CPU time includes the clients, which cost the same on both backends, so the
+        // difference between backends is the server's cost per request. Counters are summed
+        // over threads, so only thread 0 reports it.
+        const auto cpuMicros = processCpuMicros() - cpuStart;
+        state.counters["cpuUsPerReq"] =
+            static_cast<double>(cpuMicros) / (state.iterations() * state.threads);
+    }
+    ::close(fd);
+    clientDone();
+
+    if (state.thread_index == 0) {
+        waitForClients(state.threads);
+        stopServer();
+    }
+}
+
+BENCHMARK_REGISTER_F(TransportLayerBM, BM_PingPong)
+    ->Arg(kASIO)
+    ->Arg(kIOUring)
+    ->ArgName("io_uring")
+    ->ThreadRange(1, kMaxPerfThreads)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace transport
+}  // namespace mongo
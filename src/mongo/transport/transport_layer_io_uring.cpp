@@ -0,0 +1,832 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include <deque>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/stdx/unordered_map.h"
+#include "mongo/transport/io_uring_ring.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/sockaddr.h"
+#include "mongo/util/net/socket_utils.h"
+
+namespace mongo {
+namespace transport {
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(transportLayerUseIOUring, bool, false);
+
+namespace {
+
+constexpr unsigned kRingEntries = 1024;
+
+// Every worker's ring provides kBufferCount receive buffers of kBufferSize bytes each. A receive
+// holds a buffer only until its bytes are copied into a Message.
+constexpr uint16_t kBufferGroup = 0;
+constexpr uint16_t kBufferCount = 1024;
+constexpr uint32_t kBufferSize = 16 * 1024;
+
+// A session stops receiving once this many bytes of sourced but unconsumed Messages pile up,
+// and resumes when the ServiceStateMachine catches up.
+constexpr size_t kMaxReadyBytes = 16 * 1024 * 1024;
+
+constexpr size_t kHeaderSize = sizeof(MSGHEADER::Value);
+
+Status errnoToStatus(int err) {
+    if (err == ECANCELED) {
+        return {ErrorCodes::CallbackCanceled, "Callback was canceled"};
+    }
+    if (err == ECONNRESET || err == EPIPE || err == ENETRESET) {
+        return {ErrorCodes::HostUnreachable, "Connection was closed"};
+    }
+    return {ErrorCodes::SocketException, errnoWithDescription(err)};
+}
+
+HostAndPort sockAddrToHostAndPort(const sockaddr_storage& storage, socklen_t len) {
+    SockAddr addr(storage, len);
+    return HostAndPort(addr.getAddr(), addr.getPort());
+}
+
+}  // namespace
+
+/**
+ * Owns one io_uring and the thread that drives it. Everything that touches the ring runs on that
+ * thread; other threads hand it work through post().
+ */
+class TransportLayerIOUring::Worker {
+    MONGO_DISALLOW_COPYING(Worker);
+
+public:
+    using Task = stdx::function<void(Worker&)>;
+    using CompletionCallback = stdx::function<void(const io_uring_cqe&)>;
+
+    explicit Worker(size_t index) : _index(index) {}
+
+    ~Worker() {
+        stop();
+        if (_wakeupFd >= 0) {
+            ::close(_wakeupFd);
+        }
+    }
+
+    Status init() {
+        auto swRing = IOURing::make(kRingEntries);
+        if (!swRing.isOK()) {
+            return swRing.getStatus();
+        }
+        _ring = std::move(swRing.getValue());
+
+        auto status = _ring->registerBufferRing(kBufferGroup, kBufferCount, kBufferSize);
+        if (!status.isOK()) {
+            return status;
+        }
+
+        _wakeupFd = ::eventfd(0, EFD_CLOEXEC);
+        if (_wakeupFd < 0) {
+            return {ErrorCodes::OperationFailed,
+                    str::stream() << "eventfd failed: " << errnoWithDescription()};
+        }
+        return Status::OK();
+    }
+
+    void start() {
+        _running.store(true);
+        _thread = stdx::thread([this] {
+            setThreadName(str::stream() << "io_uring-" << _index);
+            _run();
+        });
+    }
+
+    void stop() {
+        if (!_running.swap(false)) {
+            return;
+        }
+        _wake();
+        _thread.join();
+    }
+
+    /**
+     * Runs 'task' on the worker thread. Tasks posted after stop() are dropped, which breaks any
+     * promise they own.
+     */
+    void post(Task task) {
+        bool wasEmpty;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            wasEmpty = _tasks.empty();
+            _tasks.push_back(std::move(task));
+        }
+        // The worker drains the whole queue before it blocks, so only the first task posted since
+        // the last drain needs to wake it.
+        if (wasEmpty) {
+            _wake();
+        }
+    }
+
+    /**
+     * Worker thread only. Returns a submission entry whose completions are passed to 'cb', and
+     * the id that can be used to cancel it.
+     */
+    std::pair<io_uring_sqe*, uint64_t> prepare(CompletionCallback cb) {
+        const auto id = _nextRequestId++;
+        _requests.emplace(id, std::move(cb));
+        auto sqe = _ring->getSqe();
+        sqe->user_data = id;
+        return {sqe, id};
+    }
+
+    /**
+     * Worker thread only. Asks the kernel to cancel the request 'id'; the request then completes
+     * with -ECANCELED unless it already finished.
+     */
+    void cancel(uint64_t id) {
+        auto sqe = _ring->getSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = id;
+        sqe->user_data = kIgnoredRequestId;
+    }
+
+    IOURing& ring() {
+        return *_ring;
+    }
+
+private:
+    static constexpr uint64_t kWakeupRequestId = 0;
+    static constexpr uint64_t kIgnoredRequestId = ~uint64_t(0);
+
+    void _wake() {
+        const uint64_t one = 1;
+        while (::write(_wakeupFd, &one, sizeof(one)) < 0 && errno == EINTR) {
+        }
+    }
+
+    void _armWakeup() {
+        auto sqe = _ring->getSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = _wakeupFd;
+        sqe->addr = reinterpret_cast<uint64_t>(&_wakeupValue);
+        sqe->len = sizeof(_wakeupValue);
+        sqe->user_data = kWakeupRequestId;
+    }
+
+    void _run() {
+        _armWakeup();
+
+        std::vector<Task> tasks;
+        while (_running.load()) {
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                tasks.swap(_tasks);
+            }
+            for (auto& task : tasks) {
+                task(*this);
+            }
+            tasks.clear();
+
+            auto status = _ring->submit(true);
+            if (!status.isOK()) {
+                warning() << "io_uring worker " << _index << " failed to submit: " << status;
+            }
+
+            _ring->forEachCompletion([&](const io_uring_cqe& cqe) {
+                if (cqe.user_data == kWakeupRequestId) {
+                    _armWakeup();
+                    return;
+                }
+                if (cqe.user_data == kIgnoredRequestId) {
+                    return;
+                }
+
+                auto it = _requests.find(cqe.user_data);
+                invariant(it != _requests.end());
+                // Multishot requests keep their callback until the kernel says they are done.
+                if (cqe.flags & IORING_CQE_F_MORE) {
+                    it->second(cqe);
+                } else {
+                    auto cb = std::move(it->second);
+                    _requests.erase(it);
+                    cb(cqe);
+                }
+            });
+        }
+    }
+
+    const size_t _index;
+    std::unique_ptr<IOURing> _ring;
+    int _wakeupFd = -1;
+    uint64_t _wakeupValue = 0;
+
+    stdx::thread _thread;
+    AtomicWord<bool> _running{false};
+
+    stdx::mutex _mutex;
+    std::vector<Task> _tasks;
+
+    // Worker thread only.
+    stdx::unordered_map<uint64_t, CompletionCallback> _requests;
+    uint64_t _nextRequestId = kWakeupRequestId + 1;
+};
+
+class TransportLayerIOUring::IOURingSession final : public Session {
+    MONGO_DISALLOW_COPYING(IOURingSession);
+
+public:
+    IOURingSession(TransportLayerIOUring* tl,
+                   Worker* worker,
+                   int fd,
+                   HostAndPort remote,
+                   HostAndPort local)
+        : _tl(tl),
+          _worker(worker),
+          _fd(fd),
+          _remote(std::move(remote)),
+          _local(std::move(local)) {}
+
+    ~IOURingSession() {
+        // Shutting the socket down completes the multishot receive, which holds a reference to
+        // the file until then.
+        end();
+        ::close(_fd);
+    }
+
+    TransportLayer* getTransportLayer() const override {
+        return _tl;
+    }
+
+    const HostAndPort& remote() const override {
+        return _remote;
+    }
+
+    const HostAndPort& local() const override {
+        return _local;
+    }
+
+    void end() override {
+        if (!_ended.swap(true)) {
+            ::shutdown(_fd, SHUT_RDWR);
+        }
+    }
+
+    /**
+     * Arms the first receive. Called once, before the session is handed to the ServiceEntryPoint.
+     */
+    void startReceiving() {
+        _worker->post([self = _self()](Worker& worker) { self->_armReceive(worker); });
+    }
+
+    StatusWith<Message> sourceMessage() override {
+        return asyncSourceMessage().getNoThrow();
+    }
+
+    Future<Message> asyncSourceMessage(const BatonHandle& baton = nullptr) override {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        invariant(!_sourcePromise);
+
+        if (!_ready.empty()) {
+            auto message = std::move(_ready.front());
+            _ready.pop_front();
+            _readyBytes -= message.size();
+            if (_receivePaused && _readyBytes < kMaxReadyBytes) {
+                _receivePaused = false;
+                lk.unlock();
+                startReceiving();
+            }
+            return Future<Message>::makeReady(std::move(message));
+        }
+
+        if (!_receiveStatus.isOK()) {
+            return Future<Message>::makeReady(_receiveStatus);
+        }
+
+        auto pf = makePromiseFuture<Message>();
+        _sourcePromise.emplace(std::move(pf.promise));
+        return std::move(pf.future);
+    }
+
+    Status sinkMessage(Message message) override {
+        return asyncSinkMessage(std::move(message)).getNoThrow();
+    }
+
+    Future<void> asyncSinkMessage(Message message, const BatonHandle& baton = nullptr) override {
+        // Replies usually fit in the socket's send buffer, so try to send inline first. That is a
+        // single syscall and no hop to the worker thread.
+        size_t sent = 0;
+        while (sent < message.size()) {
+            auto ret = ::send(
+                _fd, message.buf() + sent, message.size() - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (ret > 0) {
+                sent += ret;
+                continue;
+            }
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            return Future<void>::makeReady(errnoToStatus(ret < 0 ? errno : EPIPE));
+        }
+
+        if (sent == message.size()) {
+            networkCounter.hitPhysicalOut(message.size());
+            return Future<void>::makeReady();
+        }
+
+        auto pf = makePromiseFuture<void>();
+        _worker->post([ self = _self(), message, sent, promise = pf.promise.share() ](
+            Worker & worker) mutable {
+            self->_sendRest(worker, std::move(message), sent, std::move(promise));
+        });
+        return std::move(pf.future);
+    }
+
+    void cancelAsyncOperations(const BatonHandle& baton = nullptr) override {
+        LOG(3) << "Cancelling outstanding I/O operations on connection to " << _remote;
+        boost::optional<Promise<Message>> promise;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_sourcePromise) {
+                promise.emplace(std::move(*_sourcePromise));
+                _sourcePromise = boost::none;
+            }
+        }
+        if (promise) {
+            promise->setError({ErrorCodes::CallbackCanceled, "Callback was canceled"});
+        }
+    }
+
+    void setTimeout(boost::optional<Milliseconds> timeout) override {
+        // Ingress sessions never time out their reads or writes, so timeouts are not supported.
+        invariant(!timeout);
+    }
+
+    bool isConnected() override {
+        if (_ended.load()) {
+            return false;
+        }
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (_ready.empty() && !_receiveStatus.isOK()) {
+                return false;
+            }
+        }
+
+        pollfd pfd{_fd, POLLRDHUP, 0};
+        int ret;
+        do {
+            ret = ::poll(&pfd, 1, 0);
+        } while (ret < 0 && errno == EINTR);
+        return ret == 0 || !(pfd.revents & (POLLRDHUP | POLLHUP | POLLERR | POLLNVAL));
+    }
+
+private:
+    std::shared_ptr<IOURingSession> _self() {
+        return std::static_pointer_cast<IOURingSession>(shared_from_this());
+    }
+
+    void _armReceive(Worker& worker) {
+        // The receive only holds a weak reference: dropping the last SessionHandle must be able
+        // to destroy the session, whose destructor then shuts down the socket and ends the
+        // receive.
+        std::weak_ptr<IOURingSession> weak = _self();
+        auto prepared = worker.prepare([weak, &worker](const io_uring_cqe& cqe) {
+            const auto self = weak.lock();
+            if (cqe.res > 0 && (cqe.flags & IORING_CQE_F_BUFFER)) {
+                const uint16_t bufferId = cqe.flags >> IORING_CQE_BUFFER_SHIFT;
+                if (self) {
+                    self->_onReceive(worker.ring().providedBuffer(bufferId), cqe.res);
+                }
+                worker.ring().recycleBuffer(bufferId);
+            }
+            if (self) {
+                self->_onReceiveCompletion(worker, cqe);
+            }
+        });
+
+        auto sqe = prepared.first;
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = _fd;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        _receiveId = prepared.second;
+    }
+
+    /**
+     * Worker thread only. Splits received bytes into Messages, copying each byte once.
+     */
+    void _onReceive(const char* data, size_t len) {
+        while (len > 0 && _parseStatus.isOK()) {
+            if (_headerFilled < kHeaderSize) {
+                const auto n = std::min(len, kHeaderSize - _headerFilled);
+                memcpy(_header + _headerFilled, data, n);
+                _headerFilled += n;
+                data += n;
+                len -= n;
+                if (_headerFilled < kHeaderSize) {
+                    return;
+                }
+
+                const auto msgLen = size_t(MSGHEADER::ConstView(_header).getMessageLength());
+                if (msgLen < kHeaderSize || msgLen > MaxMessageSizeBytes) {
+                    StringBuilder sb;
+                    sb << "recv(): message msgLen " << msgLen << " is invalid. "
+                       << "Min " << kHeaderSize << " Max: " << MaxMessageSizeBytes;
+                    LOG(0) << sb.str();
+                    _parseStatus = Status(ErrorCodes::ProtocolError, sb.str());
+                    return;
+                }
+                _partial = SharedBuffer::allocate(msgLen);
+                memcpy(_partial.get(), _header, kHeaderSize);
+                _partialFilled = kHeaderSize;
+            }
+
+            const auto msgLen = _partial.capacity();
+            const auto n = std::min(len, msgLen - _partialFilled);
+            memcpy(_partial.get() + _partialFilled, data, n);
+            _partialFilled += n;
+            data += n;
+            len -= n;
+
+            if (_partialFilled == msgLen) {
+                networkCounter.hitPhysicalIn(msgLen);
+                _received.emplace_back(std::move(_partial));
+                _headerFilled = 0;
+                _partialFilled = 0;
+            }
+        }
+    }
+
+    /**
+     * Worker thread only. Publishes the Messages split off by _onReceive() and re-arms, pauses or
+     * fails the receive.
+     */
+    void _onReceiveCompletion(Worker& worker, const io_uring_cqe& cqe) {
+        const bool more = cqe.flags & IORING_CQE_F_MORE;
+        // A session that paused and resumed quickly may see its canceled receive finish after
+        // the new one was armed.
+        const bool current = cqe.user_data == _receiveId;
+
+        Status status = _parseStatus;
+        if (status.isOK() && cqe.res == 0) {
+            status = Status(ErrorCodes::HostUnreachable, "Connection was closed");
+        } else if (status.isOK() && cqe.res < 0 && cqe.res != -ENOBUFS) {
+            status = errnoToStatus(-cqe.res);
+        }
+
+        boost::optional<Promise<Message>> promise;
+        boost::optional<Message> message;
+        bool rearm = false;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            for (auto& received : _received) {
+                _readyBytes += received.size();
+                _ready.push_back(std::move(received));
+            }
+            _received.clear();
+
+            // A receive canceled because the session paused is not an error.
+            const bool pausedCancel = cqe.res == -ECANCELED && (_receivePaused || !current);
+            if (!status.isOK() && !pausedCancel && _receiveStatus.isOK()) {
+                _receiveStatus = status;
+            }
+
+            if (_sourcePromise && (!_ready.empty() || !_receiveStatus.isOK())) {
+                promise.emplace(std::move(*_sourcePromise));
+                _sourcePromise = boost::none;
+                if (!_ready.empty()) {
+                    message = std::move(_ready.front());
+                    _ready.pop_front();
+                    _readyBytes -= message->size();
+                }
+            }
+
+            if (_receiveStatus.isOK()) {
+                if (_readyBytes >= kMaxReadyBytes) {
+                    if (!_receivePaused && more) {
+                        worker.cancel(_receiveId);
+                    }
+                    _receivePaused = true;
+                } else if (!more && !_receivePaused && current) {
+                    rearm = true;
+                }
+            }
+        }
+
+        if (!_receiveStatus.isOK() && more) {
+            // A protocol error leaves the receive armed; stop it so the session can go away.
+            worker.cancel(_receiveId);
+        }
+        if (rearm) {
+            _armReceive(worker);
+        }
+
+        if (promise) {
+            if (message) {
+                promise->emplaceValue(std::move(*message));
+            } else {
+                promise->setError(_receiveStatusCopy());
+            }
+        }
+    }
+
+    Status _receiveStatusCopy() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _receiveStatus;
+    }
+
+    /**
+     * Worker thread only. Sends what the inline send could not.
+     */
+    void _sendRest(Worker& worker, Message message, size_t sent, SharedPromise<void> promise) {
+        auto prepared =
+            worker.prepare([ self = _self(), &worker, message, sent, promise ](
+                const io_uring_cqe& cqe) mutable {
+                if (cqe.res < 0) {
+                    promise.setError(errnoToStatus(-cqe.res));
+                } else if (sent + cqe.res < message.size()) {
+                    self->_sendRest(worker, std::move(message), sent + cqe.res, std::move(promise));
+                } else {
+                    networkCounter.hitPhysicalOut(message.size());
+                    promise.emplaceValue();
+                }
+            });
+
+        auto sqe = prepared.first;
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = _fd;
+        sqe->addr = reinterpret_cast<uint64_t>(message.buf() + sent);
+        sqe->len = message.size() - sent;
+        sqe->msg_flags = MSG_NOSIGNAL;
+    }
+
+    TransportLayerIOUring* const _tl;
+    Worker* const _worker;
+    const int _fd;
+    const HostAndPort _remote;
+    const HostAndPort _local;
+
+    AtomicWord<bool> _ended{false};
+
+    stdx::mutex _mutex;
+    std::deque<Message> _ready;
+    size_t _readyBytes = 0;
+    boost::optional<Promise<Message>> _sourcePromise;
+    Status _receiveStatus = Status::OK();
+    bool _receivePaused = false;
+
+    // Worker thread only: the Message being assembled and the ones completed by the current
+    // receive.
+    char _header[kHeaderSize];
+    size_t _headerFilled = 0;
+    SharedBuffer _partial;
+    size_t _partialFilled = 0;
+    std::vector<Message> _received;
+    Status _parseStatus = Status::OK();
+    uint64_t _receiveId = 0;
+};
+
+Status TransportLayerIOUring::checkSupported() {
+    return IOURing::checkSupported();
+}
+
+TransportLayerIOUring::TransportLayerIOUring(const TransportLayerASIO::Options& opts,
+                                             ServiceEntryPoint* sep)
+    : _listenerOptions(opts), _sep(sep) {}
+
+TransportLayerIOUring::~TransportLayerIOUring() {
+    for (auto& worker : _workers) {
+        worker->stop();
+    }
+    for (auto fd : _listenFds) {
+        ::close(fd);
+    }
+}
+
+StatusWith<SessionHandle> TransportLayerIOUring::connect(HostAndPort peer,
+                                                         ConnectSSLMode sslMode,
+                                                         Milliseconds timeout) {
+    return {ErrorCodes::IllegalOperation, "The io_uring transport layer only accepts connections"};
+}
+
+Future<SessionHandle> TransportLayerIOUring::asyncConnect(HostAndPort peer,
+                                                          ConnectSSLMode sslMode,
+                                                          const ReactorHandle& reactor,
+                                                          Milliseconds timeout) {
+    return Future<SessionHandle>::makeReady(
+        Status(ErrorCodes::IllegalOperation,
+               "The io_uring transport layer only accepts connections"));
+}
+
+ReactorHandle TransportLayerIOUring::getReactor(WhichReactor which) {
+    // Reactors come from the TransportLayerASIO that TransportLayerManager keeps for egress.
+    return nullptr;
+}
+
+Status TransportLayerIOUring::setup() {
+    std::vector<std::string> listenAddrs = _listenerOptions.ipList;
+    if (listenAddrs.empty()) {
+        listenAddrs = {"127.0.0.1"};
+        if (_listenerOptions.enableIPv6) {
+            listenAddrs.emplace_back("::1");
+        }
+    }
+    if (_listenerOptions.useUnixSockets) {
+        warning() << "The io_uring transport layer does not listen on UNIX domain sockets";
+    }
+
+    _listenerPort = _listenerOptions.port;
+    for (auto& ip : listenAddrs) {
+        if (ip.empty()) {
+            warning() << "Skipping empty bind address";
+            continue;
+        }
+
+        SockAddr addr(ip, _listenerPort, AF_UNSPEC);
+        if (!addr.isValid()) {
+            warning() << "Found no addresses for " << ip;
+            continue;
+        }
+        if (addr.getType() == AF_UNIX) {
+            continue;
+        }
+        if (addr.getType() == AF_INET6 && !_listenerOptions.enableIPv6) {
+            return {ErrorCodes::BadValue, "Specified ipv6 bind address, but ipv6 is disabled"};
+        }
+
+        const int fd = ::socket(addr.getType(), SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return errnoToStatus(errno);
+        }
+        _listenFds.push_back(fd);
+
+        const int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (addr.getType() == AF_INET6) {
+            ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &one, sizeof(one));
+        }
+        if (::bind(fd, addr.raw(), addr.addressSize) != 0) {
+            return {ErrorCodes::SocketException,
+                    str::stream() << "Failed to bind to " << addr.toString() << ": "
+                                  << errnoWithDescription()};
+        }
+
+        if (_listenerOptions.port == 0) {
+            if (_listenerPort != _listenerOptions.port) {
+                return Status(ErrorCodes::BadValue,
+                              "Port 0 (ephemeral port) is not allowed when"
+                              " listening on multiple IP interfaces");
+            }
+            sockaddr_storage bound;
+            socklen_t len = sizeof(bound);
+            if (::getsockname(fd, reinterpret_cast<sockaddr*>(&bound), &len) != 0) {
+                return errnoToStatus(errno);
+            }
+            _listenerPort = SockAddr(bound, len).getPort();
+        }
+    }
+
+    if (_listenFds.empty()) {
+        return Status(ErrorCodes::SocketException, "No available addresses/ports to bind to");
+    }
+
+    // As many rings as TransportLayerASIO has ingress reactors. They run on their own threads, not
+    // on the thread groups that poll those reactors.
+    const size_t numWorkers = std::max<size_t>(1, serverGlobalParams.adaptiveThreadNum);
+    for (size_t i = 0; i < numWorkers; ++i) {
+        _workers.emplace_back(stdx::make_unique<Worker>(i));
+        auto status = _workers.back()->init();
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    return Status::OK();
+}
+
+Status TransportLayerIOUring::start() {
+    _running.store(true);
+
+    for (auto& worker : _workers) {
+        worker->start();
+    }
+
+    for (auto fd : _listenFds) {
+        if (::listen(fd, serverGlobalParams.listenBacklog) != 0) {
+            return errnoToStatus(errno);
+        }
+        _workers.front()->post([this, fd](Worker& worker) { _acceptConnection(fd); });
+    }
+
+    log() << "waiting for connections on port " << _listenerPort << " (io_uring)";
+    return Status::OK();
+}
+
+void TransportLayerIOUring::shutdown() {
+    _running.store(false);
+
+    // Shutting down a listening socket fails its pending accept, which then is not re-armed.
+    for (auto fd : _listenFds) {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+}
+
+void TransportLayerIOUring::_acceptConnection(int listenFd) {
+    auto& acceptWorker = *_workers.front();
+    auto prepared = acceptWorker.prepare([this, listenFd](const io_uring_cqe& cqe) {
+        if (cqe.res >= 0) {
+            const int fd = cqe.res;
+            if (!_running.load()) {
+                ::close(fd);
+                return;
+            }
+
+            sockaddr_storage localAddr, remoteAddr;
+            socklen_t localLen = sizeof(localAddr), remoteLen = sizeof(remoteAddr);
+            if (::getsockname(fd, reinterpret_cast<sockaddr*>(&localAddr), &localLen) != 0 ||
+                ::getpeername(fd, reinterpret_cast<sockaddr*>(&remoteAddr), &remoteLen) != 0) {
+                warning() << "Error accepting new connection " << errnoWithDescription();
+                ::close(fd);
+            } else {
+                const int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                ::setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+                setSocketKeepAliveParams(fd);
+
+                auto worker = _workers[_acceptedCount++ % _workers.size()].get();
+                try {
+                    auto session = std::make_shared<IOURingSession>(
+                        this,
+                        worker,
+                        fd,
+                        sockAddrToHostAndPort(remoteAddr, remoteLen),
+                        sockAddrToHostAndPort(localAddr, localLen));
+                    session->startReceiving();
+                    _sep->startSession(std::move(session));
+                } catch (const DBException& e) {
+                    warning() << "Error accepting new connection " << e;
+                }
+            }
+        } else if (_running.load()) {
+            log() << "Error accepting new connection: " << errnoWithDescription(-cqe.res);
+        }
+
+        if (!(cqe.flags & IORING_CQE_F_MORE) && _running.load()) {
+            _acceptConnection(listenFd);
+        }
+    });
+
+    auto sqe = prepared.first;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenFd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,132 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/transport/transport_layer.h"
+#include "mongo/transport/transport_layer_asio.h"
+
+namespace mongo {
+
+class ServiceEntryPoint;
+
+namespace transport {
+
+// Serve ingress connections with TransportLayerIOUring instead of TransportLayerASIO when the
+// kernel supports it. Egress connections always use TransportLayerASIO.
+extern bool transportLayerUseIOUring;
+
+/**
+ * An ingress-only TransportLayer built on Linux io_uring.
+ *
+ * Each worker thread owns one ring. A connection is bound to a worker when it is accepted and
+ * keeps one multishot receive armed on that worker's ring, so incoming bytes arrive as
+ * completions that already carry the data: there is no readiness notification followed by a
+ * separate read. Receives land in a ring of kernel-registered provided buffers and are copied
+ * once, straight into the Message being assembled. Completing a sourced Message fulfils the
+ * session's promise on the worker thread, which lets the ServiceStateMachine schedule the
+ * connection's next step onto its own thread group.
+ *
+ * Unlike TransportLayerASIO, whose ingress reactors are polled by the thread groups of
+ * ServiceExecutorAdaptive themselves, the rings are not driven by the thread groups: there are
+ * adaptiveThreadNum workers, one per ingress reactor, and connections are bound to them round
+ * robin, independently of their thread group. Every sourced Message therefore hops from the
+ * worker to the thread group through ServiceExecutor::schedule(), which costs a cross-thread
+ * wakeup per request, and the workers compete with the thread groups for cores. The cpuUsPerReq
+ * counter of transport_layer_bm includes that cost.
+ *
+ * Replies are sent inline with a non-blocking send; only a send that would block is handed to
+ * the ring.
+ *
+ * TLS, UNIX domain sockets and egress connections are not supported; TransportLayerManager keeps
+ * a TransportLayerASIO in front of this one for egress.
+ */
+class TransportLayerIOUring final : public TransportLayer {
+    MONGO_DISALLOW_COPYING(TransportLayerIOUring);
+
+public:
+    /**
+     * Returns OK if this kernel can run TransportLayerIOUring.
+     */
+    static Status checkSupported();
+
+    TransportLayerIOUring(const TransportLayerASIO::Options& opts, ServiceEntryPoint* sep);
+
+    ~TransportLayerIOUring();
+
+    StatusWith<SessionHandle> connect(HostAndPort peer,
+                                      ConnectSSLMode sslMode,
+                                      Milliseconds timeout) final;
+
+    Future<SessionHandle> asyncConnect(HostAndPort peer,
+                                       ConnectSSLMode sslMode,
+                                       const ReactorHandle& reactor,
+                                       Milliseconds timeout) final;
+
+    Status setup() final;
+
+    Status start() final;
+
+    /**
+     * Stops accepting connections. Workers keep running until destruction so that connections
+     * which are still open can drain.
+     */
+    void shutdown() final;
+
+    ReactorHandle getReactor(WhichReactor which) final;
+
+    int listenerPort() const {
+        return _listenerPort;
+    }
+
+private:
+    class IOURingSession;
+    class Worker;
+
+    void _acceptConnection(int fd);
+
+    const TransportLayerASIO::Options _listenerOptions;
+    ServiceEntryPoint* const _sep;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::vector<int> _listenFds;
+    int _listenerPort = 0;
+
+    // Only touched on the first worker's thread, which runs every accept.
+    size_t _acceptedCount = 0;
+
+    AtomicWord<bool> _running{false};
+};
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,232 @@
+/**
+ *    Copyright (C) 2018 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/transport_layer_io_uring.h"
+
+#include <deque>
+
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/transport/service_entry_point.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+
+#include "asio.hpp"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+/**
+ * Hands accepted sessions to the test thread, which drives them synchronously.
+ */
+class SessionQueueSEP : public ServiceEntryPoint {
+public:
+    Status start() override {
+        return Status::OK();
+    }
+
+    void startSession(SessionHandle session) override {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _sessions.push_back(std::move(session));
+        _cv.notify_one();
+    }
+
+    void endAllSessions(Session::TagMask tags) override {}
+
+    bool shutdown(Milliseconds timeout) override {
+        return true;
+    }
+
+    Stats sessionStats() const override {
+        return {};
+    }
+
+    size_t numOpenSessions() const override {
+        return 0;
+    }
+
+    DbResponse handleRequest(OperationContext* opCtx, const Message& request) override {
+        MONGO_UNREACHABLE;
+    }
+
+    ServiceExecutor* getServiceExecutor() override {
+        return nullptr;
+    }
+
+    SessionHandle nextSession() {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _cv.wait(lk, [&] { return !_sessions.empty(); });
+        auto session = std::move(_sessions.front());
+        _sessions.pop_front();
+        return session;
+    }
+
+private:
+    stdx::mutex _mutex;
+    stdx::condition_variable _cv;
+    std::deque<SessionHandle> _sessions;
+};
+
+std::unique_ptr<TransportLayerIOUring> makeAndStartTL(ServiceEntryPoint* sep) {
+    TransportLayerASIO::Options opts;
+    opts.port = 0;
+    opts.ipList = {"127.0.0.1"};
+    opts.useUnixSockets = false;
+
+    auto tl = stdx::make_unique<TransportLayerIOUring>(opts, sep);
+    ASSERT_OK(tl->setup());
+    ASSERT_OK(tl->start());
+    return tl;
+}
+
+Message makeMessage(int id, size_t size) {
+    auto buffer = SharedBuffer::allocate(size);
+    memset(buffer.get(), 'a' + id % 26, size);
+    MsgData::View view(buffer.get());
+    view.setLen(size);
+    view.setId(id);
+    view.setResponseToMsgId(0);
+    view.setOperation(dbMsg);
+    return Message(std::move(buffer));
+}
+
+class Connector {
+public:
+    explicit Connector(int port) : _sock(_ctx) {
+        std::error_code ec;
+        _sock.connect(asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), port), ec);
+        ASSERT_FALSE(ec);
+    }
+
+    void write(const std::string& bytes) {
+        std::error_code ec;
+        asio::write(_sock, asio::buffer(bytes), ec);
+        ASSERT_FALSE(ec);
+    }
+
+    std::string read(size_t size) {
+        std::string bytes(size, '\0');
+        std::error_code ec;
+        asio::read(_sock, asio::buffer(&bytes[0], size), ec);
+        ASSERT_FALSE(ec);
+        return bytes;
+    }
+
+private:
+    asio::io_context _ctx;
+    asio::ip::tcp::socket _sock;
+};
+
+bool ioURingAvailable() {
+    auto status = TransportLayerIOUring::checkSupported();
+    if (!status.isOK()) {
+        log() << "Skipping test, io_uring is unavailable: " << status;
+        return false;
+    }
+    return true;
+}
+
+// Messages sent back to back, some spanning several provided buffers, come out whole and in order.
+TEST(TransportLayerIOUring, SourcesPipelinedMessages) {
+    if (!ioURingAvailable()) {
+        return;
+    }
+
+    SessionQueueSEP sep;
+    auto tl = makeAndStartTL(&sep);
+    Connector connector(tl->listenerPort());
+
+    const std::vector<size_t> sizes = {16, 100, 16 * 1024, 16 * 1024 + 1, 300 * 1024, 64};
+    std::string pipelined;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        auto msg = makeMessage(i, sizes[i]);
+        pipelined.append(msg.buf(), msg.size());
+    }
+    connector.write(pipelined);
+
+    auto session = sep.nextSession();
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        auto swMsg = session->sourceMessage();
+        ASSERT_OK(swMsg.getStatus());
+        ASSERT_EQ(swMsg.getValue().size(), sizes[i]);
+        ASSERT_EQ(swMsg.getValue().header().getId(), static_cast<int>(i));
+        ASSERT_OK(session->sinkMessage(swMsg.getValue()));
+    }
+    ASSERT_TRUE(connector.read(pipelined.size()) == pipelined);
+
+    session.reset();
+    tl->shutdown();
+}
+
+TEST(TransportLayerIOUring, InvalidMessageLengthFailsSource) {
+    if (!ioURingAvailable()) {
+        return;
+    }
+
+    SessionQueueSEP sep;
+    auto tl = makeAndStartTL(&sep);
+    Connector connector(tl->listenerPort());
+
+    auto msg = makeMessage(0, 16);
+    MsgData::View(msg.buf()).setLen(4);
+    connector.write(std::string(msg.buf(), msg.size()));
+
+    auto session = sep.nextSession();
+    ASSERT_EQ(session->sourceMessage().getStatus(), ErrorCodes::ProtocolError);
+
+    session.reset();
+    tl->shutdown();
+}
+
+TEST(TransportLayerIOUring, ClosedConnectionFailsSource) {
+    if (!ioURingAvailable()) {
+        return;
+    }
+
+    SessionQueueSEP sep;
+    auto tl = makeAndStartTL(&sep);
+    {
+        Connector connector(tl->listenerPort());
+    }
+
+    auto session = sep.nextSession();
+    ASSERT_EQ(session->sourceMessage().getStatus(), ErrorCodes::HostUnreachable);
+
+    session.reset();
+    tl->shutdown();
+}
+
+}  // namespace
+}  // namespace transport
+}  // namespace mongo
@@ -26,11 +26,14 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/transport/transport_layer_manager.h"
 
 #include "mongo/base/status.h"
+#include "mongo/config.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
@@ -38,6 +41,11 @@
 #include "mongo/transport/service_executor_synchronous.h"
 #include "mongo/transport/session.h"
 #include "mongo/transport/transport_layer_asio.h"
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+#include "mongo/transport/transport_layer_io_uring.h"
+#endif
+#include "mongo/util/log.h"
+#include "mongo/util/net/ssl_options.h"
 #include "mongo/util/net/ssl_types.h"
 #include "mongo/util/time_support.h"
 #include <limits>
@@ -140,6 +148,29 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
         MONGO_UNREACHABLE;
     }
 
+    std::unique_ptr<TransportLayer> ingressTransportLayer;
+#ifdef MONGO_CONFIG_HAVE_IO_URING
+    if (transportLayerUseIOUring) {
+        auto status = TransportLayerIOUring::checkSupported();
+#ifdef MONGO_CONFIG_SSL
+        if (status.isOK() && sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled) {
+            status = {ErrorCodes::IllegalOperation, "TLS is not supported with io_uring"};
+        }
+#endif
+        if (status.isOK()) {
+            ingressTransportLayer = stdx::make_unique<TransportLayerIOUring>(opts, sep);
+
+            // TransportLayerASIO keeps serving egress connections and the executor's reactors.
+            opts.mode = TransportLayerASIO::Options::kEgress;
+            opts.ipList.clear();
+            opts.useUnixSockets = false;
+        } else {
+            warning() << "io_uring is unavailable, falling back to the asio transport layer: "
+                      << status;
+        }
+    }
+#endif
+
     auto transportLayerASIO = stdx::make_unique<transport::TransportLayerASIO>(opts, sep);
 
     if (config->serviceExecutor == "adaptive") {
@@ -154,6 +185,9 @@ std::unique_ptr<TransportLayer> TransportLayerManager::createWithConfig(
 
     std::vector<std::unique_ptr<TransportLayer>> retVector;
     retVector.emplace_back(std::move(transportLayer));
+    if (ingressTransportLayer) {
+        retVector.emplace_back(std::move(ingressTransportLayer));
+    }
     return stdx::make_unique<TransportLayerManager>(std::move(retVector));
 }
 